@@ -35,6 +35,11 @@ uint64_t  g_stack_pointer;
 uint64_t  g_exception_ret_addr;
 uint64_t  g_ret_addr;
 uint32_t  g_rl_smmu_init;
+uint32_t  g_pcie_full_scan;
+uint32_t  g_print_buffered;
+uint32_t  g_pe_fanout;
+uint32_t  g_pe_resident;
+uint32_t  g_timeout_multiple;
 
 char8_t **g_execute_tests_str;
 char8_t **g_execute_modules_str;
@@ -168,6 +173,9 @@ void
 freeRmeAcsMem()
 {
 
+  val_mem_pool_print_stats_el3();
+  val_log_ring_free();
+  val_pe_resident_release_all();
   val_pe_free_info_table();
   val_gic_free_info_table();
   val_timer_free_info_table();
@@ -217,6 +225,11 @@ ShellAppMainrme(
 
   g_print_mmio = FALSE;
   g_enable_pcie_tests = 1;
+  g_pcie_full_scan = PLATFORM_OVERRIDE_PCIE_FULL_SCAN;
+  g_print_buffered = PLATFORM_OVERRIDE_PRINT_BUFFERED;
+  g_pe_fanout = PLATFORM_OVERRIDE_PE_FANOUT;
+  g_pe_resident = PLATFORM_OVERRIDE_PE_RESIDENT;
+  g_timeout_multiple = PLATFORM_OVERRIDE_TIMEOUT_MULTIPLE;
 
   //
   // Initialize global counters
@@ -250,6 +263,11 @@ ShellAppMainrme(
   Status = createPeInfoTable();
   if (Status)
     return Status;
+  Status = val_shared_data_assign_slots();
+  if (Status)
+    return Status;
+  if (g_print_buffered)
+    val_log_ring_init(val_pe_get_num());
   Status = createGicInfoTable();
   if (Status)
     return Status;
@@ -295,6 +313,8 @@ ShellAppMainrme(
   Status |= val_rme_mec_execute_tests(val_pe_get_num());
 
 print_test_status:
+  val_test_stats_report();
+
   val_print(ACS_PRINT_ALWAYS, "\n ------------------------------------------------------- \n", 0);
   val_print(ACS_PRINT_ALWAYS, " Total Tests run  = %4d;", g_rme_tests_total);
   val_print(ACS_PRINT_ALWAYS, " Tests Passed  = %4d", g_rme_tests_pass);
@@ -19,6 +19,15 @@
 
 /* Settings */
 #define PLATFORM_OVERRIDE_PRINT_LEVEL  0x3    //The permissible levels are 1,2,3,4 and 5
+/* Set to 1 to record prints in per-PE rings and emit them at test boundaries.
+ * Keep 0 when debugging hangs, as prints still in a ring are lost on a hang. */
+#define PLATFORM_OVERRIDE_PRINT_BUFFERED 0
+/* Set to 1 to wake secondary PEs in a tree and start multi-PE payloads together */
+#define PLATFORM_OVERRIDE_PE_FANOUT 0
+/* Set to 1 to keep secondary PEs parked between tests instead of PSCI CPU_OFF */
+#define PLATFORM_OVERRIDE_PE_RESIDENT 0
+/* Multiple applied to every TIMEOUT_* wait budget */
+#define PLATFORM_OVERRIDE_TIMEOUT_MULTIPLE 1
 
 /* MMU PGT config parameters */
 #define PLATFORM_PAGE_SIZE                 0x1000
@@ -145,10 +154,10 @@
                                                  (PLATFORM_OVERRIDE_TIMER_PHY_FLAGS_1))
 #define PLATFORM_OVERRIDE_TIMER_CNTFRQ         0x0
 
-/* Define the Timeout values to be used */
-#define PLATFORM_OVERRIDE_TIMEOUT_LARGE         0x100000
-#define PLATFORM_OVERRIDE_TIMEOUT_MEDIUM        0x10000
-#define PLATFORM_OVERRIDE_TIMEOUT_SMALL         0x100
+/* Define the Timeout values to be used, in microseconds of generic counter time */
+#define PLATFORM_OVERRIDE_TIMEOUT_LARGE         1000000
+#define PLATFORM_OVERRIDE_TIMEOUT_MEDIUM        100000
+#define PLATFORM_OVERRIDE_TIMEOUT_SMALL         1000
 
 /* PCIE platform config parameters */
 #define PLATFORM_OVERRIDE_NUM_ECAM                1
@@ -181,6 +190,9 @@
 #define PLATFORM_BM_OVERRIDE_PCIE_MAX_DEV      32
 #define PLATFORM_BM_OVERRIDE_PCIE_MAX_FUNC     8
 
+/* Set to 1 to probe every bus/device/function instead of following the PCIe topology */
+#define PLATFORM_OVERRIDE_PCIE_FULL_SCAN       0
+
 /* Sample macros for ECAM_1
  * #define PLATFORM_OVERRIDE_PCIE_ECAM_BASE_ADDR_1  0x00000000
  * #define PLATFORM_OVERRIDE_PCIE_SEGMENT_GRP_NUM_1 0x0
@@ -196,6 +196,40 @@ void *mem_alloc(size_t alignment, size_t size);
 #define DOE_STATUS_REG_ERROR    2
 #define DOE_STATUS_REG_READY    31
 
+/* DOE data object header: Vendor ID = PCI-SIG, type = secured SPDM */
+#define DOE_HEADER1_PCI_SIG_SPDM    0x10001
+#define DOE_HEADER_LENGTH_DW        2
+
+/* TDISP session engine, endpoints driven concurrently */
+#define TDISP_MAX_SESSIONS          32
+#define TDISP_SESSION_TIMEOUT_US    1000000
+
+/* Number of BDFs whose DOE mailbox location is cached, one per session */
+#define DOE_TRANSPORT_CACHE_SIZE    TDISP_MAX_SESSIONS
+
+typedef struct {
+  uint32_t bdf;        /* BDF of the DOE requester */
+  uint64_t doe_base;   /* ECAM address of the DOE extended capability */
+  uint64_t start;      /* Counter value when the last request was issued */
+} DOE_TRANSPORT_ENTRY;
+
+/* Requests walked by the TDISP session engine */
+#define TDISP_MSG_SPDM_GET_VERSION  0
+#define TDISP_MSG_GET_VERSION       1
+#define TDISP_MSG_GET_STATE         2
+#define TDISP_MSG_LOCK              3
+#define TDISP_MSG_START             4
+#define TDISP_MSG_STOP              5
+
+typedef struct {
+  uint32_t bdf;              /* Endpoint driven by this session */
+  uint32_t step;             /* Index of the outstanding request in seq */
+  uint32_t num_steps;        /* Number of requests in seq */
+  uint32_t status;           /* Non-zero once the session has failed */
+  const uint8_t *seq;        /* TDISP_MSG_* sequence for the operation */
+  uint32_t response[100];    /* Last response, also the source of the START nonce */
+} TDISP_SESSION;
+
 /* Device bitmask definitions */
 #define RCiEP    (1 << 0b1001)
 #define RCEC     (1 << 0b1010)
@@ -693,5 +727,7 @@ void pal_form_get_version_msg(uint32_t req_id, uint8_t *request, uint64_t *req_l
 uint32_t pal_check_doe_response(uint32_t bdf);
 void pal_form_tdisp_lock_msg(uint32_t req_id, uint8_t *request, uint64_t *req_length);
 void pal_form_tdisp_get_state_msg(uint32_t req_id, uint8_t *request, uint64_t *req_length);
+void pal_form_tdisp_stop_msg(uint32_t req_id, uint8_t *request, uint64_t *req_length);
+uint32_t pal_doe_response_ready(uint32_t bdf);
 
 #endif
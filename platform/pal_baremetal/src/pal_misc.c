@@ -26,6 +26,7 @@
 #define ADDR_ALIGN(a, b)              __ADDR_ALIGN_MASK(a, (typeof(a))(b) - 1)
 
 void *mem_alloc(size_t alignment, size_t size);
+void *mem_alloc_persistent(size_t alignment, size_t size);
 void mem_free(void *ptr);
 
 #define get_num_va_args(_args, _lcount)             \
@@ -44,9 +45,22 @@ typedef struct {
     uint64_t size;
 } val_host_alloc_region_ts;
 
+/* Persistent heap block header, doubles as the free list node */
+typedef struct heap_block {
+    uint64_t size;
+    struct heap_block *next;
+} heap_block_t;
+
+#define HEAP_BLOCK_ALIGN              16
+#define HEAP_BLOCK_HDR_SIZE           sizeof(heap_block_t)
+#define HEAP_BLOCK_MIN_SIZE           (2 * HEAP_BLOCK_HDR_SIZE)
+
 static uint64_t heap_base;
 static uint64_t heap_top;
 static uint64_t heap_init_done = 0;
+static uint64_t heap_checkpoint;
+static uint32_t heap_arena_active;
+static heap_block_t *heap_free_list;
 extern void* g_rme_log_file_handle;
 uint8_t   *gSharedMemory;
 
@@ -573,7 +587,8 @@ pal_mem_alloc_pages (uint32_t NumPages)
 
   return (VOID*)(UINTN)PageBase;
 #else
-  return (void *)mem_alloc(MEM_ALIGN_4K, NumPages * PLATFORM_PAGE_SIZE);
+  /* Page-table pages are linked into live translation tables, keep them off the arena */
+  return mem_alloc_persistent(MEM_ALIGN_4K, NumPages * PLATFORM_PAGE_SIZE);
 #endif
 }
 
@@ -591,8 +606,9 @@ pal_mem_free_pages(void *PageBase, uint32_t NumPages)
    */
 
   gBS->FreePages((EFI_PHYSICAL_ADDRESS)(UINTN)PageBase, NumPages);
+  #else
+  mem_free(PageBase);
   #endif
-  (void) PageBase;
   (void) NumPages;
 }
 
@@ -895,18 +911,174 @@ void *mem_alloc(size_t alignment, size_t size)
 }
 
 /**
- * TODO: Free the memory for given memory address
- * Currently acs code is initialisazing from base for every test,
- * the regions data structure is internal and below code only setting to zero
- * not actually freeing memory.
- * If require can revisit in future.
+ * @brief Allocates memory that must outlive the current test arena.
+ *        Blocks are carved downwards from the top of the heap region and are
+ *        recycled through an address ordered first-fit free list.
+ * @param alignment - alignment for the address. It must be in power of 2.
+ * @param Size - Size of the region. It must not be zero.
+ * @return - Returns allocated memory base address if allocation is successful.
+ *           Otherwise returns NULL.
+ **/
+void *mem_alloc_persistent(size_t alignment, size_t size)
+{
+  heap_block_t **link, *blk, *rem;
+  uint64_t addr, end;
+
+  if(heap_init_done != 1)
+    mem_alloc_init();
+
+  if ((size == 0) || !is_power_of_2((uint32_t)alignment))
+    return NULL;
+
+  if (alignment < HEAP_BLOCK_ALIGN)
+    alignment = HEAP_BLOCK_ALIGN;
+
+  size = ADDR_ALIGN(size, HEAP_BLOCK_ALIGN);
+
+  /* First fit from the recycled blocks */
+  for (link = &heap_free_list; *link != NULL; link = &(*link)->next)
+  {
+    blk = *link;
+    addr = ADDR_ALIGN((uint64_t)blk + HEAP_BLOCK_HDR_SIZE, alignment);
+    end = (uint64_t)blk + blk->size;
+    if (addr + size > end)
+      continue;
+
+    *link = blk->next;
+    if (end - (addr + size) >= HEAP_BLOCK_MIN_SIZE)
+    {
+      /* Give the tail back to the list at the same position */
+      rem = (heap_block_t *)(addr + size);
+      rem->size = end - (addr + size);
+      rem->next = *link;
+      *link = rem;
+      end = addr + size;
+    }
+
+    /* Leading alignment padding stays inside the block and is recovered on free */
+    ((heap_block_t *)(addr - HEAP_BLOCK_HDR_SIZE))->size = end - (uint64_t)blk;
+    ((heap_block_t *)(addr - HEAP_BLOCK_HDR_SIZE))->next = blk;
+    return (void *)addr;
+  }
+
+  /* Carve a new block from the top of the heap */
+  if ((heap_top - heap_base) < (size + alignment + HEAP_BLOCK_HDR_SIZE))
+    return NULL;
+
+  addr = (heap_top - size) & ~((uint64_t)alignment - 1);
+  blk = (heap_block_t *)(addr - HEAP_BLOCK_HDR_SIZE);
+  blk->size = heap_top - (uint64_t)blk;
+  blk->next = blk;
+  heap_top = (uint64_t)blk;
+
+  return (void *)addr;
+}
+
+/**
+ * @brief Frees the memory for given memory address.
+ *        Blocks from the persistent region are returned to the free list and
+ *        merged with their neighbours. Arena allocations are reclaimed in bulk by
+ *        pal_mem_arena_rewind, and memory handed out before any arena was opened
+ *        lives for the whole run.
+ * @param ptr - Address returned by one of the heap allocators.
+ * @return Void
  **/
 void mem_free(void *ptr)
 {
-  if (!ptr)
+  heap_block_t *prev, *blk, *hdr;
+
+  if (!ptr || (heap_init_done != 1))
+    return;
+
+  if (((uint64_t)ptr <= heap_top) ||
+      ((uint64_t)ptr >= PLATFORM_HEAP_REGION_BASE + PLATFORM_HEAP_REGION_SIZE))
+    return;
+
+  hdr = (heap_block_t *)((uint64_t)ptr - HEAP_BLOCK_HDR_SIZE);
+  blk = hdr->next;
+  blk->size = hdr->size;
+
+  prev = NULL;
+  blk->next = heap_free_list;
+  while ((blk->next != NULL) && (blk->next < blk))
+  {
+    prev = blk->next;
+    blk->next = prev->next;
+  }
+
+  if (prev == NULL)
+    heap_free_list = blk;
+  else
+    prev->next = blk;
+
+  /* Merge with the following block */
+  if ((blk->next != NULL) && ((uint64_t)blk + blk->size == (uint64_t)blk->next))
+  {
+    blk->size += blk->next->size;
+    blk->next = blk->next->next;
+  }
+
+  /* Merge with the preceding block */
+  if ((prev != NULL) && ((uint64_t)prev + prev->size == (uint64_t)blk))
+  {
+    prev->size += blk->size;
+    prev->next = blk->next;
+  }
+
+  /* A free block at the bottom of the region goes back to the shared heap */
+  if ((heap_free_list != NULL) && ((uint64_t)heap_free_list == heap_top))
+  {
+    heap_top += heap_free_list->size;
+    heap_free_list = heap_free_list->next;
+  }
+}
+
+/**
+ * @brief Opens a test arena. Every allocation made from the shared heap after this
+ *        point is released in one go by pal_mem_arena_rewind. A second open before the
+ *        rewind keeps the original checkpoint.
+ * @param  void
+ * @return Void
+ **/
+void pal_mem_arena_open(void)
+{
+  if(heap_init_done != 1)
+    mem_alloc_init();
+
+  if (heap_arena_active)
+    return;
+
+  heap_checkpoint = heap_base;
+  heap_arena_active = 1;
+}
+
+/**
+ * @brief Rewinds the heap to the checkpoint taken by pal_mem_arena_open.
+ * @param  void
+ * @return Void
+ **/
+void pal_mem_arena_rewind(void)
+{
+  if (!heap_arena_active)
     return;
 
-  return;
+  heap_base = heap_checkpoint;
+  heap_arena_active = 0;
+}
+
+/**
+ * @brief Allocates memory which is not reclaimed when the test arena is rewound.
+ *        Release it with pal_mem_free.
+ * @param  Size - allocation size in bytes
+ * @return Pointer to the allocated memory, NULL on failure
+ **/
+void *pal_mem_alloc_persistent(uint32_t Size)
+{
+#ifndef TARGET_BM_BOOT
+  return malloc(Size);
+#else
+  return mem_alloc_persistent(0x08, Size);
+#endif
 }
 
 /* The functions implemented below are to enable console prints via UART driver */
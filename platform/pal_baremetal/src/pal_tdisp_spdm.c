@@ -21,6 +21,13 @@
 uint32_t response[100] = {0};
 uint8_t *response_8bit = (uint8_t *)response;
 
+uint64_t PalReadCntPct(void);
+uint64_t PalReadCntFrq(void);
+
+static DOE_TRANSPORT_ENTRY g_doe_transport[DOE_TRANSPORT_CACHE_SIZE];
+static uint32_t g_doe_transport_count;
+static uint32_t g_doe_transport_next;
+
 void pal_form_get_version_msg(uint32_t req_id, uint8_t *request, uint64_t *req_length)
 {
     /* SPDM message */
@@ -102,7 +109,8 @@ void pal_form_tdisp_lock_msg(uint32_t req_id, uint8_t *request, uint64_t *req_le
 
 }
 
-void pal_form_tdisp_run_msg(uint32_t req_id, uint8_t *request, uint64_t *req_length)
+void pal_form_tdisp_run_msg(uint32_t req_id, uint8_t *request, uint64_t *req_length,
+                            uint8_t *lock_resp)
 {
     /* SPDM message */
     request[0] = 0x12;
@@ -127,7 +135,7 @@ void pal_form_tdisp_run_msg(uint32_t req_id, uint8_t *request, uint64_t *req_len
     // + 8 bytes reserved
     for (int nonce_cnt = 0; nonce_cnt < 32; nonce_cnt++)
     {
-        request[28 + nonce_cnt] = response_8bit[28 + nonce_cnt];
+        request[28 + nonce_cnt] = lock_resp[28 + nonce_cnt];
     }
     *req_length = 0x3c;
 
@@ -175,31 +183,98 @@ void pal_form_tdisp_get_state_msg(uint32_t req_id, uint8_t *request, uint64_t *r
 
 }
 
-uint32_t pal_write_doe_msgo_doe_mailbox(uint32_t bdf, uint32_t *request, uint64_t req_length)
+void pal_form_tdisp_stop_msg(uint32_t req_id, uint8_t *request, uint64_t *req_length)
 {
-    /* Need to implement */
-    uint32_t value, doe_cap_base, status;
-    uint64_t i, doe_length, Ecam, config_addr;;
+    /* SPDM message */
+    request[0] = 0x12;
+    request[1] = 0xFE; // RequestResponseCode // application data
+    request[2] = 0x00;
+    request[3] = 0x00;
+    request[4] = 0x3; // StandardID // application data
+    request[5] = 0x00; // StandardID // application data
+    request[6] = 0x02; // Length of vendor ID // application data
+    request[7] = 0x01; // Vendor ID
+    request[8] = 0x00; // Vendor ID
+    request[9] = 0x10; // Payload Length // application data
+    request[10] = 0x00; // Payload Length // application data
+
+    /* TDISP Message */
+    request[11] = 0x1; // protocol id // application data
+    request[12] = 0x10; // tdisp version // application data
+    request[13] = 0x87; // message type
+    //request[14] & [15] Reserved
+    request[16] = VAL_EXTRACT_BITS(req_id, 0, 7);// 12 byte interface ID = 4 bytes Requester ID
+    request[17] = VAL_EXTRACT_BITS(req_id, 8, 15);
+    // Reserved till [27]
+    *req_length = 0x1c;
+
+    if (g_print_mmio || (g_curr_module & g_enable_module))
+        print(ACS_PRINT_DEBUG, " Request message: 0x", 0);
+    for (uint32_t i = 0; i < *req_length; i++)
+    {
+        if (g_print_mmio || (g_curr_module & g_enable_module))
+            print(ACS_PRINT_ALWAYS, "%x ", request[i]);
+    }
+
+}
+
+/**
+  @brief  Return the DOE transport entry for a BDF.
+          The ECAM address and DOE capability offset are looked up once per
+          BDF and cached, so back to back SPDM/TDISP messages do not walk
+          the extended capability list again.
+  @param  bdf  BDF of the DOE requester
+  @return Cached transport entry, or NULL if the DOE capability is not present
+**/
+static DOE_TRANSPORT_ENTRY *pal_doe_get_transport(uint32_t bdf)
+{
+    uint32_t i, doe_cap_base, status;
+    DOE_TRANSPORT_ENTRY *entry;
+
+    for (i = 0; i < g_doe_transport_count; i++)
+    {
+        if (g_doe_transport[i].bdf == bdf)
+            return &g_doe_transport[i];
+    }
 
-    Ecam = pal_pcie_get_mcfg_ecam(); // Getting the ECAM address
-    config_addr = pal_exerciser_get_pcie_config_offset(bdf);
     doe_cap_base = 0;
     status = pal_exerciser_find_pcie_capability(DOE_CAP_ID, bdf, PCIE, &doe_cap_base);
-
     if (status)
     {
         print(ACS_PRINT_ERR, " DOE capability not found", 0);
-        return 1;
+        return NULL;
     }
 
-    value = pal_mmio_read(Ecam + config_addr + doe_cap_base + DOE_STATUS_REG);
+    /* Recycle the oldest slot once the cache is full */
+    if (g_doe_transport_count < DOE_TRANSPORT_CACHE_SIZE)
+        entry = &g_doe_transport[g_doe_transport_count++];
+    else
+        entry = &g_doe_transport[(g_doe_transport_next++) % DOE_TRANSPORT_CACHE_SIZE];
+
+    entry->bdf = bdf;
+    entry->doe_base = pal_pcie_get_mcfg_ecam() + pal_exerciser_get_pcie_config_offset(bdf)
+                      + doe_cap_base;
+    entry->start = 0;
+    return entry;
+}
+
+uint32_t pal_write_doe_msgo_doe_mailbox(uint32_t bdf, uint32_t *request, uint64_t req_length)
+{
+    uint32_t value;
+    uint64_t i, doe_length, mailbox;
+    DOE_TRANSPORT_ENTRY *doe;
+
+    doe = pal_doe_get_transport(bdf);
+    if (doe == NULL)
+        return 1;
+
+    value = pal_mmio_read(doe->doe_base + DOE_STATUS_REG);
     if (VAL_EXTRACT_BITS(value, DOE_STATUS_REG_BUSY, DOE_STATUS_REG_BUSY))
     {
         print(ACS_PRINT_ERR, " DOE Busy bit is set", 0);
         return 1;
     }
 
-    value = pal_mmio_read(Ecam + config_addr + doe_cap_base + DOE_STATUS_REG);
     if (VAL_EXTRACT_BITS(value, DOE_STATUS_REG_ERROR, DOE_STATUS_REG_ERROR))
     {
         print(ACS_PRINT_ERR, " DOE Error bit is set", 0);
@@ -208,74 +283,80 @@ uint32_t pal_write_doe_msgo_doe_mailbox(uint32_t bdf, uint32_t *request, uint64_
 
     doe_length = (req_length % 4) ? ((req_length >> 2) + 1) : (req_length >> 2);
 
-    pal_mmio_write(Ecam + config_addr + doe_cap_base + DOE_WRITE_DATA_MAILBOX_REG, 0x10001);
-    pal_mmio_write(Ecam + config_addr + doe_cap_base + DOE_WRITE_DATA_MAILBOX_REG,
-                                    (uint32_t)doe_length + 0x2);
-
-    for (i = 0; i < doe_length; i++)
+    if (g_print_mmio || (g_curr_module & g_enable_module))
     {
-        if (g_print_mmio || (g_curr_module & g_enable_module))
+        for (i = 0; i < doe_length; i++)
             print(ACS_PRINT_INFO, " Writing request[%lld]: 0x%lx to DOE mailbox", i, request[i]);
-        pal_mmio_write(Ecam + config_addr + doe_cap_base + DOE_WRITE_DATA_MAILBOX_REG, request[i]);
     }
 
+    /* Stream the DOE header and the whole request into the write mailbox */
+    mailbox = doe->doe_base + DOE_WRITE_DATA_MAILBOX_REG;
+    doe->start = PalReadCntPct();
+    pal_mmio_write(mailbox, DOE_HEADER1_PCI_SIG_SPDM);
+    pal_mmio_write(mailbox, (uint32_t)doe_length + DOE_HEADER_LENGTH_DW);
+
+    for (i = 0; i < doe_length; i++)
+        pal_mmio_write(mailbox, request[i]);
+
     /*Set Go bit*/
-    pal_mmio_write(Ecam + config_addr + doe_cap_base + DOE_CTRL_REG, (uint32_t)(1 << 31));
+    pal_mmio_write(doe->doe_base + DOE_CTRL_REG, (uint32_t)(1 << 31));
     return 0;
 }
 
 uint32_t pal_host_pcie_doe_recv_resp(uint32_t bdf, uint32_t *resp_addr, uint64_t *resp_len)
 {
-    uint32_t value, length, doe_cap_base, status;
-    uint64_t i, Ecam, config_addr;
-
-    Ecam = pal_pcie_get_mcfg_ecam(); // Getting the ECAM address
-    config_addr = pal_exerciser_get_pcie_config_offset(bdf);
-    doe_cap_base = 0;
-    status = pal_exerciser_find_pcie_capability(DOE_CAP_ID, bdf, PCIE, &doe_cap_base);
+    uint32_t value, length;
+    uint64_t i, mailbox, ticks, freq;
+    DOE_TRANSPORT_ENTRY *doe;
 
-    if (status)
-    {
-        print(ACS_PRINT_ERR, " DOE capability not found", 0);
+    doe = pal_doe_get_transport(bdf);
+    if (doe == NULL)
         return 1;
-    }
 
-    value = pal_mmio_read(Ecam + config_addr + doe_cap_base + DOE_STATUS_REG);
+    value = pal_mmio_read(doe->doe_base + DOE_STATUS_REG);
     if (!(VAL_EXTRACT_BITS(value, DOE_STATUS_REG_READY, DOE_STATUS_REG_READY)))
     {
         print(ACS_PRINT_ERR, " DOE Ready bit is not set", 0);
         return 1;
     }
 
-    value = pal_mmio_read(Ecam + config_addr + doe_cap_base + DOE_STATUS_REG);
-
     if (VAL_EXTRACT_BITS(value, DOE_STATUS_REG_ERROR, DOE_STATUS_REG_ERROR))
     {
         print(ACS_PRINT_ERR, " DOE Error bit is set", 0);
         return 1;
     }
 
+    /* Each read of the mailbox is acknowledged by a write to advance it */
+    mailbox = doe->doe_base + DOE_READ_DATA_MAILBOX_REG;
+
     /* Reading DOE Header 1 */
-    value = pal_mmio_read(Ecam + config_addr + doe_cap_base + DOE_READ_DATA_MAILBOX_REG);
-    pal_mmio_write(Ecam + config_addr + doe_cap_base + DOE_READ_DATA_MAILBOX_REG, 0);
+    pal_mmio_read(mailbox);
+    pal_mmio_write(mailbox, 0);
 
     /* Reading DOE Header 2 - Length */
-    value = pal_mmio_read(Ecam + config_addr + doe_cap_base + DOE_READ_DATA_MAILBOX_REG);
-    pal_mmio_write(Ecam + config_addr + doe_cap_base + DOE_READ_DATA_MAILBOX_REG, 0);
+    value = pal_mmio_read(mailbox);
+    pal_mmio_write(mailbox, 0);
 
-    length = value - 0x2;
+    length = value - DOE_HEADER_LENGTH_DW;
     *resp_len = (uint64_t)(length * 4);
-    if (g_print_mmio || (g_curr_module & g_enable_module))
-        print(ACS_PRINT_INFO, " Length of the DW: 0x%llx in bytes", *resp_len);
 
     for (i = 0; i < length; i++)
     {
-        value = pal_mmio_read(Ecam + config_addr + doe_cap_base + DOE_READ_DATA_MAILBOX_REG);
-        pal_mmio_write(Ecam + config_addr + doe_cap_base + DOE_READ_DATA_MAILBOX_REG, 0);
-        *resp_addr++ = value;
+        resp_addr[i] = pal_mmio_read(mailbox);
+        pal_mmio_write(mailbox, 0);
     }
 
-    value = pal_mmio_read(Ecam + config_addr + doe_cap_base + DOE_STATUS_REG);
+    ticks = PalReadCntPct() - doe->start;
+
+    if (g_print_mmio || (g_curr_module & g_enable_module))
+    {
+        print(ACS_PRINT_INFO, " Length of the DW: 0x%llx in bytes", *resp_len);
+        freq = PalReadCntFrq();
+        if (freq)
+            print(ACS_PRINT_INFO, " DOE message latency: %lld us", (ticks * 1000000) / freq);
+    }
+
+    value = pal_mmio_read(doe->doe_base + DOE_STATUS_REG);
     if (VAL_EXTRACT_BITS(value, DOE_STATUS_REG_READY, DOE_STATUS_REG_READY))
     {
         print(ACS_PRINT_ERR, " DOE Busy bit is not clear", 0);
@@ -285,6 +366,26 @@ uint32_t pal_host_pcie_doe_recv_resp(uint32_t bdf, uint32_t *resp_addr, uint64_t
     return 0;
 }
 
+/**
+  @brief  Check without blocking whether the DOE mailbox of a BDF has a
+          response (or an error) waiting to be read.
+  @param  bdf  BDF of the DOE requester
+  @return 1 if pal_host_pcie_doe_recv_resp can be called, 0 otherwise
+**/
+uint32_t pal_doe_response_ready(uint32_t bdf)
+{
+    uint32_t value;
+    DOE_TRANSPORT_ENTRY *doe;
+
+    doe = pal_doe_get_transport(bdf);
+    if (doe == NULL)
+        return 1;
+
+    value = pal_mmio_read(doe->doe_base + DOE_STATUS_REG);
+    return (VAL_EXTRACT_BITS(value, DOE_STATUS_REG_READY, DOE_STATUS_REG_READY) ||
+            VAL_EXTRACT_BITS(value, DOE_STATUS_REG_ERROR, DOE_STATUS_REG_ERROR));
+}
+
 uint32_t pal_check_doe_response(uint32_t bdf)
 {
     /* Need to implement */
@@ -307,128 +408,176 @@ uint32_t pal_check_doe_response(uint32_t bdf)
     return 0;
 }
 
-uint32_t pal_device_unlock(uint32_t bdf)
+/* Request sequences walked by the session engine, one DOE message per step */
+static const uint8_t g_tdisp_lock_seq[] = {
+    TDISP_MSG_SPDM_GET_VERSION, TDISP_MSG_GET_VERSION, TDISP_MSG_GET_STATE,
+    TDISP_MSG_LOCK, TDISP_MSG_START, TDISP_MSG_GET_STATE
+};
+
+static const uint8_t g_tdisp_unlock_seq[] = {
+    TDISP_MSG_STOP, TDISP_MSG_GET_STATE
+};
+
+static TDISP_SESSION g_tdisp_session[TDISP_MAX_SESSIONS];
+
+/**
+  @brief  Build and post the next request of a session to its DOE mailbox.
+  @param  session  Session to advance
+  @return 0 on success, 1 if the request could not be posted
+**/
+static uint32_t pal_tdisp_session_send(TDISP_SESSION *session)
 {
-    uint8_t req_addr[50] = {0};
-    uint16_t req_id;
-    uint32_t *req_addr_4byte;
+    uint8_t request[100];
     uint64_t req_length;
+    uint16_t req_id;
 
-    req_id = PCIE_CREATE_BDF_PACKED(bdf);
-    /* SPDM message */
-    req_addr[0] = 0x12;
-    req_addr[1] = 0xFE; // RequestResponseCode // application data
-    req_addr[2] = 0x00;
-    req_addr[3] = 0x00;
-    req_addr[4] = 0x3; // StandardID // application data
-    req_addr[5] = 0x00; // StandardID // application data
-    req_addr[6] = 0x02; // Length of vendor ID // application data
-    req_addr[7] = 0x01; // Vendor ID
-    req_addr[8] = 0x00; // Vendor ID
-    req_addr[9] = 0x10; // Payload Length // application data
-    req_addr[10] = 0x00; // Payload Length // application data
+    pal_mem_set(request, sizeof(request), 0);
+    req_id = PCIE_CREATE_BDF_PACKED(session->bdf);
 
-    /* TDISP Message */
-    req_addr[11] = 0x1; // protocol id // application data
-    req_addr[12] = 0x10; // tdisp version // application data
-    req_addr[13] = 0x87; // message type
-    //req_addr[14] & [15] Reserved
-    req_addr[16] = VAL_EXTRACT_BITS(req_id, 0, 7);// 12 byte interface ID = 4 bytes Requester ID
-    req_addr[17] = VAL_EXTRACT_BITS(req_id, 8, 15);
-    // Reserved till [27]
-    req_length = 0x1c;
+    switch (session->seq[session->step])
+    {
+    case TDISP_MSG_SPDM_GET_VERSION:
+        request[0] = 0x10;
+        request[1] = 0x84;
+        req_length = 0x4;
+        break;
+    case TDISP_MSG_GET_VERSION:
+        pal_form_get_version_msg(req_id, request, &req_length);
+        break;
+    case TDISP_MSG_GET_STATE:
+        pal_form_tdisp_get_state_msg(req_id, request, &req_length);
+        break;
+    case TDISP_MSG_LOCK:
+        pal_form_tdisp_lock_msg(req_id, request, &req_length);
+        break;
+    case TDISP_MSG_START:
+        pal_form_tdisp_run_msg(req_id, request, &req_length, (uint8_t *)session->response);
+        break;
+    default:
+        pal_form_tdisp_stop_msg(req_id, request, &req_length);
+        break;
+    }
 
-    if (g_print_mmio || (g_curr_module & g_enable_module))
-        print(ACS_PRINT_DEBUG, "Request message: 0x", 0);
-    for (uint32_t i = 0; i < req_length; i++)
+    return pal_write_doe_msgo_doe_mailbox(session->bdf, (uint32_t *)request, req_length);
+}
+
+/**
+  @brief  Drive the TDISP lock or unlock sequence on several endpoints at
+          once. Each endpoint has at most one DOE request outstanding and
+          the mailboxes are polled round-robin, so the time one device
+          spends producing a response overlaps with the others.
+  @param  bdf        List of endpoint BDFs
+  @param  count      Number of entries in bdf
+  @param  seq        TDISP_MSG_* sequence to walk on every endpoint
+  @param  num_steps  Number of requests in seq
+  @param  status     Optional per-endpoint result, 0 on success
+  @return 0 if every endpoint completed the sequence, 1 otherwise
+**/
+static uint32_t pal_tdisp_session_run(uint32_t *bdf, uint32_t count, const uint8_t *seq,
+                                      uint32_t num_steps, uint32_t *status)
+{
+    uint32_t base, num, i, active, result;
+    uint64_t resp_len, deadline;
+    TDISP_SESSION *session;
+
+    result = 0;
+
+    /* Endpoints beyond the session table are handled in further rounds */
+    for (base = 0; base < count; base += TDISP_MAX_SESSIONS)
     {
-        if (g_print_mmio || (g_curr_module & g_enable_module))
-            print(ACS_PRINT_ALWAYS, "%x ", req_addr[i]);
+        num = ((count - base) < TDISP_MAX_SESSIONS) ? (count - base) : TDISP_MAX_SESSIONS;
+
+        for (i = 0; i < num; i++)
+        {
+            session = &g_tdisp_session[i];
+            session->bdf = bdf[base + i];
+            session->step = 0;
+            session->status = 0;
+            session->seq = seq;
+            session->num_steps = num_steps;
+
+            if (pal_tdisp_session_send(session))
+                session->status = 1;
+        }
+
+        deadline = PalReadCntPct() + (PalReadCntFrq() / 1000000) * TDISP_SESSION_TIMEOUT_US;
+
+        do {
+            active = 0;
+            for (i = 0; i < num; i++)
+            {
+                session = &g_tdisp_session[i];
+                if (session->status || (session->step == session->num_steps))
+                    continue;
+
+                active++;
+                if (!pal_doe_response_ready(session->bdf))
+                    continue;
+
+                if (pal_host_pcie_doe_recv_resp(session->bdf, session->response, &resp_len))
+                {
+                    print(ACS_PRINT_ERR, " TDISP response failed for BDF: 0x%x", session->bdf);
+                    session->status = 1;
+                    continue;
+                }
+
+                if (++session->step < session->num_steps)
+                {
+                    if (pal_tdisp_session_send(session))
+                        session->status = 1;
+                }
+            }
+        } while (active && (PalReadCntPct() < deadline));
+
+        for (i = 0; i < num; i++)
+        {
+            session = &g_tdisp_session[i];
+            if (!session->status && (session->step != session->num_steps))
+            {
+                print(ACS_PRINT_ERR, " TDISP session stalled for BDF: 0x%x", session->bdf);
+                session->status = 1;
+            }
+
+            if (status)
+                status[base + i] = session->status;
+            result |= session->status;
+        }
     }
 
-    req_addr_4byte = (uint32_t *)req_addr;
-    pal_write_doe_msgo_doe_mailbox(bdf, req_addr_4byte, req_length);
-    if (pal_check_doe_response(bdf))
-        print(ACS_PRINT_ERR, " TDSIP Locking failed", 0);
+    return result;
+}
 
-    /* Get the device state */
-    pal_mem_set(&req_addr, sizeof(req_addr), 0);
-    pal_form_tdisp_get_state_msg(req_id, req_addr, &req_length);
+/**
+  @brief  Lock and start several TDISP endpoints concurrently.
+  @param  bdf     List of endpoint BDFs
+  @param  count   Number of entries in bdf
+  @param  status  Optional per-endpoint result, 0 on success
+  @return 0 if every endpoint reached RUN, 1 otherwise
+**/
+uint32_t pal_device_lock_all(uint32_t *bdf, uint32_t count, uint32_t *status)
+{
+    return pal_tdisp_session_run(bdf, count, g_tdisp_lock_seq, sizeof(g_tdisp_lock_seq), status);
+}
 
-    req_addr_4byte = (uint32_t *)req_addr;
-    pal_write_doe_msgo_doe_mailbox(bdf, req_addr_4byte, req_length);
-    if (pal_check_doe_response(bdf))
-      print(ACS_PRINT_ERR, " TDSIP Locking failed", 0);
+/**
+  @brief  Stop several TDISP endpoints concurrently.
+  @param  bdf     List of endpoint BDFs
+  @param  count   Number of entries in bdf
+  @param  status  Optional per-endpoint result, 0 on success
+  @return 0 if every endpoint was stopped, 1 otherwise
+**/
+uint32_t pal_device_unlock_all(uint32_t *bdf, uint32_t count, uint32_t *status)
+{
+    return pal_tdisp_session_run(bdf, count, g_tdisp_unlock_seq, sizeof(g_tdisp_unlock_seq),
+                                 status);
+}
 
-  return 0;
+uint32_t pal_device_unlock(uint32_t bdf)
+{
+    return pal_device_unlock_all(&bdf, 1, NULL);
 }
 
 uint32_t pal_device_lock(uint32_t bdf)
 {
-  uint64_t req_length;
-  uint16_t req_id;
-  uint8_t req_addr_get_version_spdm[4] = {0};
-  uint8_t req_addr[100] = {0};
-  uint32_t *req_addr_4byte;
-
-  req_id = PCIE_CREATE_BDF_PACKED(bdf);
-
-  req_addr_get_version_spdm[0] = 0x10;
-  req_addr_get_version_spdm[1] = 0x84;
-  req_addr_get_version_spdm[2] = 0;
-  req_addr_get_version_spdm[3] = 0;
-
-  req_length = 0x4;
-  req_addr_4byte = (uint32_t *)req_addr_get_version_spdm;
-  pal_write_doe_msgo_doe_mailbox(bdf, req_addr_4byte, req_length);
-  pal_check_doe_response(bdf);
-
-  /* Get TDISP Version */
-  pal_form_get_version_msg(req_id, req_addr, &req_length);
-
-  req_addr_4byte = (uint32_t *)req_addr;
-  /* Write the created request message to doe_write_data_mailbox register */
-  pal_write_doe_msgo_doe_mailbox(bdf, req_addr_4byte, req_length);
-
-  /* Finally check the response from the doe_read_data_mailbox register */
-  if (pal_check_doe_response(bdf))
-    print(ACS_PRINT_ERR, " TDSIP Get version failed", 0);
-
-  /* Get device state */
-  pal_mem_set(&req_addr, sizeof(req_addr), 0);
-  pal_form_tdisp_get_state_msg(req_id, req_addr, &req_length);
-
-  req_addr_4byte = (uint32_t *)req_addr;
-  pal_write_doe_msgo_doe_mailbox(bdf, req_addr_4byte, req_length);
-  if (pal_check_doe_response(bdf))
-    print(ACS_PRINT_ERR, " TDSIP Locking failed", 0);
-
-  /* Lock the device */
-  pal_mem_set(&req_addr, sizeof(req_addr), 0);
-  pal_form_tdisp_lock_msg(req_id, req_addr, &req_length);
-
-  req_addr_4byte = (uint32_t *)req_addr;
-  pal_write_doe_msgo_doe_mailbox(bdf, req_addr_4byte, req_length);
-  if (pal_check_doe_response(bdf))
-    print(ACS_PRINT_ERR, " TDSIP Locking failed", 0);
-
-  /* Start the TDI (RUN) */
-  pal_mem_set(&req_addr, sizeof(req_addr), 0);
-  pal_form_tdisp_run_msg(req_id, req_addr, &req_length);
-
-  req_addr_4byte = (uint32_t *)req_addr;
-  pal_write_doe_msgo_doe_mailbox(bdf, req_addr_4byte, req_length);
-  if (pal_check_doe_response(bdf))
-    print(ACS_PRINT_ERR, " TDSIP Locking failed", 0);
-
-  /* Get the device state */
-  pal_mem_set(&req_addr, sizeof(req_addr), 0);
-  pal_form_tdisp_get_state_msg(req_id, req_addr, &req_length);
-
-  req_addr_4byte = (uint32_t *)req_addr;
-  pal_write_doe_msgo_doe_mailbox(bdf, req_addr_4byte, req_length);
-  if (pal_check_doe_response(bdf))
-    print(ACS_PRINT_ERR, " TDSIP Locking failed", 0);
-
-  return 0;
+    return pal_device_lock_all(&bdf, 1, NULL);
 }
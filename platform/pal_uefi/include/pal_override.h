@@ -39,9 +39,9 @@
 #define PLATFORM_OVERRIDE_PLATFORM_TIMER_GSIV_CT 58
 
 /* TIMEOUTS */
-#define PLATFORM_OVERRIDE_TIMEOUT_LARGE_CT  0x10000
-#define PLATFORM_OVERRIDE_TIMEOUT_MEDIUM_CT 0x1000
-#define PLATFORM_OVERRIDE_TIMEOUT_SMALL_CT  0x10
+#define PLATFORM_OVERRIDE_TIMEOUT_LARGE_CT  1000000 /* microseconds */
+#define PLATFORM_OVERRIDE_TIMEOUT_MEDIUM_CT 100000
+#define PLATFORM_OVERRIDE_TIMEOUT_SMALL_CT  1000
 
 /* EL2 virtual timer */
 #define PLATFORM_OVERRIDE_EL2_VIR_TIMER_GSIV_CT 28
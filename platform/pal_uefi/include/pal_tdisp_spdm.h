@@ -33,4 +33,38 @@
 #define DOE_STATUS_REG_ERROR    2
 #define DOE_STATUS_REG_READY    31
 
+/* DOE data object header: Vendor ID = PCI-SIG, type = secured SPDM */
+#define DOE_HEADER1_PCI_SIG_SPDM    0x10001
+#define DOE_HEADER_LENGTH_DW        2
+
+/* TDISP session engine, endpoints driven concurrently */
+#define TDISP_MAX_SESSIONS          32
+#define TDISP_SESSION_TIMEOUT_US    1000000
+
+/* Number of BDFs whose DOE mailbox location is cached, one per session */
+#define DOE_TRANSPORT_CACHE_SIZE    TDISP_MAX_SESSIONS
+
+typedef struct {
+  UINT32 bdf;        /* BDF of the DOE requester */
+  UINT64 doe_base;   /* ECAM address of the DOE extended capability */
+  UINT64 start;      /* Counter value when the last request was issued */
+} DOE_TRANSPORT_ENTRY;
+
+/* Requests walked by the TDISP session engine */
+#define TDISP_MSG_SPDM_GET_VERSION  0
+#define TDISP_MSG_GET_VERSION       1
+#define TDISP_MSG_GET_STATE         2
+#define TDISP_MSG_LOCK              3
+#define TDISP_MSG_START             4
+#define TDISP_MSG_STOP              5
+
+typedef struct {
+  UINT32 bdf;              /* Endpoint driven by this session */
+  UINT32 step;             /* Index of the outstanding request in seq */
+  UINT32 num_steps;        /* Number of requests in seq */
+  UINT32 status;           /* Non-zero once the session has failed */
+  const UINT8 *seq;        /* TDISP_MSG_* sequence for the operation */
+  UINT32 response[100];    /* Last response, also the source of the START nonce */
+} TDISP_SESSION;
+
 #endif
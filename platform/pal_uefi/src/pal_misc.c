@@ -655,6 +655,44 @@ pal_mem_free_pages(
   gBS->FreePages((EFI_PHYSICAL_ADDRESS)(UINTN)PageBase, NumPages);
 }
 
+/**
+  @brief  Allocates memory which is not reclaimed at the end of a test.
+          UEFI pool memory is released individually, so this is a plain pool allocation.
+
+  @param  Size  allocation size in bytes
+
+  @return Pointer to the allocated memory, NULL on failure
+**/
+VOID *
+pal_mem_alloc_persistent (
+  UINT32 Size
+  )
+{
+  return pal_mem_alloc(Size);
+}
+
+/**
+  @brief  Opens a per-test heap arena. Nothing to do with the UEFI pool allocator.
+**/
+VOID
+pal_mem_arena_open (
+  VOID
+  )
+{
+  return;
+}
+
+/**
+  @brief  Rewinds the per-test heap arena. Nothing to do with the UEFI pool allocator.
+**/
+VOID
+pal_mem_arena_rewind (
+  VOID
+  )
+{
+  return;
+}
+
 /**
  @brief Writes the reset status on Non-Volatile memory.
 
@@ -84,7 +84,8 @@ payload(void)
   uint32_t msi_index = 0;
   uint32_t msi_cap_offset = 0;
   uint64_t itt_base;
-  uint32_t timeout, rp_aer_offset, value;
+  uint32_t rp_aer_offset, value;
+  uint64_t deadline;
 
   pe_index = val_pe_get_index_mpid(val_pe_get_mpid());
   instance = val_exerciser_get_info(EXERCISER_NUM_CARDS);
@@ -168,8 +169,8 @@ payload(void)
       inject_error(instance);
 
       /* PE busy polls to check the completion of interrupt service routine */
-      timeout = TIMEOUT_MEDIUM;
-      while ((--timeout > 0) && irq_pending)
+      deadline = val_deadline_start(TIMEOUT_MEDIUM);
+      while (irq_pending && !val_deadline_expired(deadline))
           {};
 
       /* Interrupt should not be generated */
@@ -212,11 +213,11 @@ payload(void)
       inject_error(instance);
 
       /* PE busy polls to check the completion of interrupt service routine */
-      timeout = TIMEOUT_LARGE;
-      while ((--timeout > 0) && irq_pending)
+      deadline = val_deadline_start(TIMEOUT_LARGE);
+      while (irq_pending && !val_deadline_expired(deadline))
           {};
 
-      if (timeout == 0) {
+      if (irq_pending) {
           val_print(ACS_PRINT_ERR, " Interrupt trigger failed for : 0x%x, ", lpi_int_id);
           val_print(ACS_PRINT_ERR, " BDF : 0x%x   ", e_bdf);
           val_set_status(pe_index, "FAIL", 11);
@@ -206,6 +206,7 @@ payload(void)
       if (val_device_lock(bdf))
       {
           val_print(ACS_PRINT_ERR, " Failed to lock the device: 0x%lx", bdf);
+          val_device_unlock(bdf);
           test_fail++;
           continue;
       }
@@ -352,6 +353,9 @@ payload(void)
           goto free_mem;
       }
 free_mem:
+      /* Clear the Realm STE so the EL3 master record of this stream is released */
+      val_smmu_rlm_unmap_el3(&master);
+
       pgt_attr_el3 = LOWER_ATTRS(PGT_ENTRY_ACCESS | SHAREABLE_ATTR(OUTER_SHAREABLE)
                      | GET_ATTR_INDEX(DEV_MEM_nGnRnE) | PGT_ENTRY_AP_RW | PAS_ATTR(NONSECURE_PAS));
 
@@ -130,6 +130,7 @@ payload(void)
           if (val_device_lock(bdf))
           {
               val_print(ACS_PRINT_ERR, " Failed to lock the device: 0x%lx", bdf);
+              val_device_unlock(bdf);
               test_fail++;
               continue;
           }
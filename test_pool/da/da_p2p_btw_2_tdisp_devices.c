@@ -127,6 +127,8 @@ payload(void)
   uint32_t req_rp_bdf;
   uint32_t tgt_e_bdf;
   uint32_t tgt_rp_bdf;
+  uint32_t lock_bdf[2];
+  uint32_t lock_status[2];
   uint32_t instance;
   uint32_t test_skip;
   uint64_t bar_base;
@@ -174,15 +176,15 @@ payload(void)
 
       val_print(ACS_PRINT_DEBUG, " Target exerciser BDF - 0x%x", tgt_e_bdf);
 
-      if (val_device_lock(req_e_bdf))
+      /* Walk both exercisers through lock and run together */
+      lock_bdf[0] = req_e_bdf;
+      lock_bdf[1] = tgt_e_bdf;
+      if (val_device_lock_all(lock_bdf, 2, lock_status))
       {
-          val_print(ACS_PRINT_ERR, " Failed to lock the device: 0x%lx", req_e_bdf);
-          goto test_clean;
-      }
-
-      if (val_device_lock(tgt_e_bdf))
-      {
-          val_print(ACS_PRINT_ERR, " Failed to lock the device: 0x%lx", tgt_e_bdf);
+          if (lock_status[0])
+              val_print(ACS_PRINT_ERR, " Failed to lock the device: 0x%lx", req_e_bdf);
+          if (lock_status[1])
+              val_print(ACS_PRINT_ERR, " Failed to lock the device: 0x%lx", tgt_e_bdf);
           goto test_clean;
       }
 
@@ -155,6 +155,7 @@ payload(void)
           if (status)
           {
               val_print(ACS_PRINT_ERR, " TDISP RUN state fail for bdf: 0x%x", bdf);
+              val_device_unlock(ep_bdf);
               test_fail++;
               continue;
           }
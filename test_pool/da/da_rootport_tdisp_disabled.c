@@ -106,6 +106,7 @@ payload(void)
       if (val_device_lock(e_bdf))
       {
           val_print(ACS_PRINT_ERR, " Failed to lock the device: 0x%lx", e_bdf);
+          val_device_unlock(e_bdf);
           test_fail++;
           continue;
       }
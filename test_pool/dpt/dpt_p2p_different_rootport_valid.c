@@ -313,6 +313,7 @@ payload(void)
       if (val_device_lock(bdf))
       {
           val_print(ACS_PRINT_ERR, " Failed to lock the device: 0x%lx", bdf);
+          val_device_unlock(bdf);
           test_fail++;
           continue;
       }
@@ -535,6 +536,9 @@ payload(void)
       }
 
 free_mem:
+      /* Clear the Realm STE so the EL3 master record of this stream is released */
+      val_smmu_rlm_unmap_el3(&master);
+
       val_exerciser_ops(ATS_INV_CACHE, 0, instance);
 
       if (val_pcie_find_capability(bdf, PCIE_ECAP, ECID_ATS, &cap_base) == PCIE_SUCCESS)
@@ -313,6 +313,7 @@ payload(void)
       if (val_device_lock(bdf))
       {
           val_print(ACS_PRINT_ERR, " Failed to lock the device: 0x%lx", bdf);
+          val_device_unlock(bdf);
           test_fail++;
           continue;
       }
@@ -534,6 +535,9 @@ payload(void)
        }
 
 free_mem:
+      /* Clear the Realm STE so the EL3 master record of this stream is released */
+      val_smmu_rlm_unmap_el3(&master);
+
       val_exerciser_ops(ATS_INV_CACHE, 0, instance);
 
       /* Add DPT entry for the PA with Read Write Access */
@@ -212,6 +212,7 @@ payload(void)
       if (val_device_lock(bdf))
       {
           val_print(ACS_PRINT_ERR, " Failed to lock the device: 0x%lx", bdf);
+          val_device_unlock(bdf);
           test_fail++;
           continue;
       }
@@ -368,8 +369,8 @@ payload(void)
       }
 
       /* Add DPT entry for the PA with Read Write Access */
-      if (val_dpt_add_entry((uint64_t)dram_buf_in_virt,
-                       ((((uint64_t)(master.smmu_index)) << 32) | DPT_RDWR_ACCESS_ENTRY)))
+      if (val_dpt_add_range((uint64_t)dram_buf_in_virt, test_data_blk_size, DPT_RDWR_ACCESS_ENTRY,
+                            0x1ull << master.smmu_index, DPT_RANGE_NO_DPTI))
       {
           val_print(ACS_PRINT_ERR, " DPT entry add failure %4x", instance);
           test_fail++;
@@ -405,6 +406,9 @@ payload(void)
       }
 
 free_mem:
+      /* Clear the Realm STE so the EL3 master record of this stream is released */
+      val_smmu_rlm_unmap_el3(&master);
+
       val_exerciser_ops(ATS_INV_CACHE, 0, instance);
 
       pgt_attr_el3 = LOWER_ATTRS(PGT_ENTRY_ACCESS | SHAREABLE_ATTR(NON_SHAREABLE) |
@@ -76,7 +76,7 @@ payload(void)
 
     uint32_t index = val_pe_get_index_mpid(val_pe_get_mpid());
     uint32_t e_bdf = 0;
-    uint32_t timeout;
+    uint64_t deadline;
     uint32_t status;
     uint32_t instance;
     uint32_t test_skip = 1;
@@ -172,8 +172,8 @@ payload(void)
     val_mmio_write(its_base + GITS_TRANSLATER, lpi_int_id + instance);
 
     /* PE busy polls to check the completion of interrupt service routine */
-    timeout = TIMEOUT_MEDIUM;
-    while ((--timeout > 0) && irq_pending)
+    deadline = val_deadline_start(TIMEOUT_MEDIUM);
+    while (irq_pending && !val_deadline_expired(deadline))
         {};
 
     /* Interrupt should not be generated */
@@ -191,11 +191,11 @@ payload(void)
     val_exerciser_ops(GENERATE_MSI, msi_index, instance);
 
     /* PE busy polls to check the completion of interrupt service routine */
-    timeout = TIMEOUT_LARGE;
-    while ((--timeout > 0) && irq_pending)
+    deadline = val_deadline_start(TIMEOUT_LARGE);
+    while (irq_pending && !val_deadline_expired(deadline))
         {};
 
-    if (timeout == 0) {
+    if (irq_pending) {
         val_print(ACS_PRINT_ERR, " Interrupt trigger failed for : 0x%x, ", lpi_int_id);
         val_print(ACS_PRINT_ERR, " BDF : 0x%x   ", e_bdf);
         val_set_status(index, "FAIL", 07);
@@ -243,8 +243,8 @@ payload(void)
     val_mmio_write(its_base + GITS_TRANSLATER, lpi_int_id + instance);
 
     /* PE busy polls to check the completion of interrupt service routine */
-    timeout = TIMEOUT_MEDIUM;
-    while ((--timeout > 0) && irq_pending)
+    deadline = val_deadline_start(TIMEOUT_MEDIUM);
+    while (irq_pending && !val_deadline_expired(deadline))
       {};
 
     /* Interrupt should not be generated */
@@ -262,8 +262,8 @@ payload(void)
     val_exerciser_ops(GENERATE_MSI, msi_index, instance);
 
     /* PE busy polls to check the completion of interrupt service routine */
-    timeout = TIMEOUT_LARGE;
-    while ((--timeout > 0) && irq_pending)
+    deadline = val_deadline_start(TIMEOUT_LARGE);
+    while (irq_pending && !val_deadline_expired(deadline))
         {};
 
     if (irq_pending == 0) {
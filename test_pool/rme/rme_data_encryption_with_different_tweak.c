@@ -42,6 +42,7 @@ void payload(void)
   uint32_t index = val_pe_get_index_mpid(val_pe_get_mpid()), attr;
   uint64_t data_rd_ns, data_rd_ns_nxt_blk, PA, PA_NXT_BLK;
   uint64_t VA_S, VA_S_NXT_BLK, VA_NS, VA_NS_NXT_BLK, size;
+  MMU_MAP_DESC map[4];
 
   size = val_get_min_tg();
   PA = val_get_free_pa(size, size);
@@ -52,34 +53,17 @@ void payload(void)
   attr = LOWER_ATTRS(PGT_ENTRY_ACCESS | SHAREABLE_ATTR(NON_SHAREABLE) | PGT_ENTRY_AP_RW);
 
   PA_NXT_BLK = PA + 16;
-  if (val_add_mmu_entry_el3(VA_S, PA, (attr | LOWER_ATTRS(PAS_ATTR(SECURE_PAS)))))
+  map[0] = (MMU_MAP_DESC){VA_S, PA, attr | LOWER_ATTRS(PAS_ATTR(SECURE_PAS)), 0};
+  map[1] = (MMU_MAP_DESC){VA_S_NXT_BLK, PA_NXT_BLK, attr | LOWER_ATTRS(PAS_ATTR(SECURE_PAS)), 0};
+  map[2] = (MMU_MAP_DESC){VA_NS, PA, attr | LOWER_ATTRS(PAS_ATTR(NONSECURE_PAS)), 0};
+  map[3] = (MMU_MAP_DESC){VA_NS_NXT_BLK, PA_NXT_BLK,
+                          attr | LOWER_ATTRS(PAS_ATTR(NONSECURE_PAS)), 0};
+  if (val_add_mmu_entries_el3(map, 4))
   {
-      val_print(ACS_PRINT_ERR, "\n  Failed to add MMU entry for VA_S 0x%llx", VA_S);
+      val_print(ACS_PRINT_ERR, "\n  Failed to add MMU entries for VA_S 0x%llx", VA_S);
       val_set_status(index, "FAIL", 01);
       return;
   }
-  if (val_add_mmu_entry_el3(VA_S_NXT_BLK, PA_NXT_BLK,
-                           (attr | LOWER_ATTRS(PAS_ATTR(SECURE_PAS)))))
-  {
-      val_print(ACS_PRINT_ERR,
-        "\n  Failed to add MMU entry for VA_S_NXT_BLK 0x%llx", VA_S_NXT_BLK);
-      val_set_status(index, "FAIL", 02);
-      return;
-  }
-  if (val_add_mmu_entry_el3(VA_NS, PA, (attr | LOWER_ATTRS(PAS_ATTR(NONSECURE_PAS)))))
-  {
-      val_print(ACS_PRINT_ERR, "\n  Failed to add MMU entry for VA_NS 0x%llx", VA_NS);
-      val_set_status(index, "FAIL", 03);
-      return;
-  }
-  if (val_add_mmu_entry_el3(VA_NS_NXT_BLK, PA_NXT_BLK,
-                            (attr | LOWER_ATTRS(PAS_ATTR(NONSECURE_PAS)))))
-  {
-      val_print(ACS_PRINT_ERR,
-        "\n  Failed to add MMU entry for VA_NS_NXT_BLK 0x%llx", VA_NS_NXT_BLK);
-      val_set_status(index, "FAIL", 04);
-      return;
-  }
 
   /* Store RANDOM_DATA_1 in PA_S and (PA_S + 16)*/
   val_print(ACS_PRINT_TEST, " Store the RANDOM_DATA_1 in PA of Secure PAS", 0);
@@ -108,30 +92,19 @@ void payload(void)
 
   /* CMO to PoPA for all PA of all pas */
   val_print(ACS_PRINT_TEST, " Issuing CMO to PoPA for both the blocks in Secure and Non-Secure", 0);
-  if (val_data_cache_ops_by_pa_el3(PA, SECURE_PAS))
+  /* One range covers both blocks, PA to the end of PA_NXT_BLK */
+  if (val_cmo_range_el3(PA, PA_NXT_BLK + sizeof(uint64_t) - PA, SECURE_PAS, CMO_OP_POPA))
   {
       val_print(ACS_PRINT_ERR, " Failed to issue CMO for PA 0x%llx", PA);
       val_set_status(index, "FAIL", 07);
       return;
   }
-  if (val_data_cache_ops_by_pa_el3(PA_NXT_BLK, SECURE_PAS))
-  {
-      val_print(ACS_PRINT_ERR, " Failed to issue CMO for PA_NXT_BLK 0x%llx", PA_NXT_BLK);
-      val_set_status(index, "FAIL", 8);
-      return;
-  }
-  if (val_data_cache_ops_by_pa_el3(PA, NONSECURE_PAS))
+  if (val_cmo_range_el3(PA, PA_NXT_BLK + sizeof(uint64_t) - PA, NONSECURE_PAS, CMO_OP_POPA))
   {
       val_print(ACS_PRINT_ERR, " Failed to issue CMO for PA 0x%llx", PA);
       val_set_status(index, "FAIL", 9);
       return;
   }
-  if (val_data_cache_ops_by_pa_el3(PA_NXT_BLK, NONSECURE_PAS))
-  {
-      val_print(ACS_PRINT_ERR, " Failed to issue CMO for PA_NXT_BLK 0x%llx", PA_NXT_BLK);
-      val_set_status(index, "FAIL", 10);
-      return;
-  }
 
   /* Read the data from PA_NS and (PA_NS + 16) */
   val_print(ACS_PRINT_TEST, " Reading data from PA and PA+16 from NonSecure PAS", 0);
@@ -31,82 +31,86 @@
 
 /*
  * @brief  The test validates that the resources are protected by GPC as per system requirement.
- * 1. The base addresses of the resources are mapped to different access PASs using Free VA.
+ * 1. Each resource base address is probed through every access PAS in one EL3 probe matrix.
  * 2. Access with the same PAS as that of resources' will be successful.
  * 3. While the access with the different access PAS than that of resources' will generate fault.
- * 4. ACK handler takes care of the GPF and sends the handle back to the test safely.
+ * 4. EL3 recovers from the GPF itself and reports it in the probe matrix result bitmap.
  */
 static
 void payload(void)
 {
   uint8_t status_fail_cnt = 0;
   MEM_REGN_INFO_TABLE *mem_region_cfg;
-  uint32_t index = val_pe_get_index_mpid(val_pe_get_mpid()), security_state, num_regn, attr;
-  uint64_t pas_list[4] = {REALM_PAS, NONSECURE_PAS, SECURE_PAS, ROOT_PAS}, VA, size;
-
-  size = val_get_min_tg();
+  uint32_t index = val_pe_get_index_mpid(val_pe_get_mpid()), security_state, num_regn;
+  uint32_t regn_cnt = 0, first_regn, probe_cnt;
+  uint64_t pas_list[4] = {REALM_PAS, NONSECURE_PAS, SECURE_PAS, ROOT_PAS};
+  PROBE_MATRIX *mx;
+  PROBE_DESC *probe;
 
   mem_region_cfg = val_mem_gpc_info_table();
   num_regn = mem_region_cfg->header.num_of_regn_gpc;
-  VA = val_get_free_va(num_regn * NUM_PAS * size);
-  attr = LOWER_ATTRS(PGT_ENTRY_ACCESS | SHAREABLE_ATTR(NON_SHAREABLE) | PGT_ENTRY_AP_RW);
 
-  for (uint32_t regn_cnt = 0; regn_cnt < num_regn; ++regn_cnt)
+  mx = val_memory_calloc(1, sizeof(PROBE_MATRIX));
+  if (mx == NULL)
+  {
+    val_print(ACS_PRINT_ERR, " Failed to allocate the probe matrix", 0);
+    val_set_status(index, "FAIL", 02);
+    return;
+  }
+  mx->va = val_get_free_va(val_get_min_tg());
+  mx->attr = LOWER_ATTRS(PGT_ENTRY_ACCESS | SHAREABLE_ATTR(NON_SHAREABLE) | PGT_ENTRY_AP_RW);
+
+  while (regn_cnt < num_regn)
   {
+    /* Fill the matrix with as many whole resources as it holds */
+    first_regn = regn_cnt;
+    mx->num_probes = 0;
+    for (; regn_cnt < num_regn && mx->num_probes + NUM_PAS <= MAX_PROBE_DESC; ++regn_cnt)
+    {
+      security_state = mem_region_cfg->regn_info[regn_cnt].resourse_pas;
+      val_print(ACS_PRINT_TEST, " Checking GPC for resource 0x%llx",
+                mem_region_cfg->regn_info[regn_cnt].base_addr);
+
+      for (int pas_cnt = 0; pas_cnt < NUM_PAS; ++pas_cnt)
+      {
+        probe = &mx->probe[mx->num_probes++];
+        probe->pa = mem_region_cfg->regn_info[regn_cnt].base_addr;
+        probe->access_pas = pas_list[pas_cnt];
+        /* Read through the resource PAS, store through the others to provoke the GPF */
+        probe->access_type = (security_state == pas_list[pas_cnt]) ? READ_DATA : WRITE_DATA;
+        probe->data = RANDOM_DATA_1;
+      }
+    }
 
-    shared_data->arg0 = mem_region_cfg->regn_info[regn_cnt].base_addr;
-    security_state = mem_region_cfg->regn_info[regn_cnt].resourse_pas;
-    val_print(ACS_PRINT_TEST, " Checking GPC for resource 0x%llx", shared_data->arg0);
+    if (val_probe_matrix_el3(mx))
+    {
+      val_print(ACS_PRINT_ERR, " Failed to probe the resources from 0x%llx",
+                mem_region_cfg->regn_info[first_regn].base_addr);
+      status_fail_cnt++;
+      continue;
+    }
 
-    for (int pas_cnt = 0; pas_cnt < 4; ++pas_cnt)
+    for (probe_cnt = 0; probe_cnt < mx->num_probes; ++probe_cnt)
     {
-      shared_data->arg1 = pas_list[pas_cnt];/* GPI */
-      if (val_add_mmu_entry_el3(VA, shared_data->arg0,
-                                attr | LOWER_ATTRS(PAS_ATTR(shared_data->arg1))))
+      probe = &mx->probe[probe_cnt];
+      security_state = mem_region_cfg->regn_info[first_regn + probe_cnt / NUM_PAS].resourse_pas;
+
+      if (security_state == probe->access_pas && PROBE_GPF(mx, probe_cnt))
       {
-        val_print(ACS_PRINT_ERR, " Failed to add MMU entry for VA 0x%llx", VA);
+        val_print(ACS_PRINT_ERR, "  The exception is generated when Resource PAS \
+                        and Access PAS are same, PA = 0x%llx", probe->pa);
         status_fail_cnt++;
-        continue;
       }
-
-      if (security_state == pas_list[pas_cnt]) {
-
-        shared_data->exception_expected = CLEAR;
-        shared_data->access_mut = SET;
-        shared_data->arg1 = VA;
-        if (val_pe_access_mut_el3())
-        {
-          val_print(ACS_PRINT_ERR, " Failed to access VA = 0x%llx", VA);
-          status_fail_cnt++;
-        }
-
-        if (shared_data->exception_generated == SET)
-        {
-          val_print(ACS_PRINT_ERR, "  The exception is generated when Resource PAS \
-                          and Access PAS are same", 0);
-          status_fail_cnt++;
-        }
-      } else {
-        shared_data->exception_expected = SET;
-        shared_data->access_mut = SET;
-        shared_data->arg1 = VA;
-        if (val_pe_access_mut_el3())
-        {
-          val_print(ACS_PRINT_ERR, " Failed to access VA = 0x%llx", VA);
-          status_fail_cnt++;
-        }
-
-        if (shared_data->exception_generated == CLEAR)
-        {
-          val_print(ACS_PRINT_ERR, " The exception is not generated when Resource PAS \
-                          and Access PAS are different", 0);
-          status_fail_cnt++;
-        }
-        shared_data->exception_generated = CLEAR;
+      else if (security_state != probe->access_pas && !PROBE_GPF(mx, probe_cnt))
+      {
+        val_print(ACS_PRINT_ERR, " The exception is not generated when Resource PAS \
+                        and Access PAS are different, PA = 0x%llx", probe->pa);
+        status_fail_cnt++;
       }
-      VA += size;
     }
   }
+  val_memory_free(mx);
+
   val_print(ACS_PRINT_DEBUG, " The accesses did not go as expected for %d times",
                   status_fail_cnt);
   val_print(ACS_PRINT_DEBUG, " The test expects zero status_fail_cnt", 0);
@@ -33,94 +33,95 @@
 
 /*
  * @brief  The test validates the PAS protection check for a resource.
- * 1. Access to the Base addresses, PA of the resources with the same access PAS of that
+ * 1. Each resource base address is loaded through every access PAS in one EL3 probe matrix.
+ * 2. Access to the Base addresses, PA of the resources with the same access PAS of that
  *    resources' will be successful
- * 2. Access to the Base addresses, PA of the resources with the different access PAS may/may not
+ * 3. Access to the Base addresses, PA of the resources with the different access PAS may/may not
  *    generate fault.
- * 3. When GPF is not generated when expected, the load of the Address access must not be updated.
+ * 4. When GPF is not generated when expected, the load of the Address access must not be updated.
  */
 static
 void payload(void)
 {
   uint8_t status_fail_cnt = 0;
-  uint32_t index = val_pe_get_index_mpid(val_pe_get_mpid()), security_state, num_regn, attr;
+  uint32_t index = val_pe_get_index_mpid(val_pe_get_mpid()), security_state, num_regn;
+  uint32_t regn_cnt = 0, first_regn, probe_cnt;
   uint64_t pas_list[4] = {ROOT_PAS, REALM_PAS, SECURE_PAS, NONSECURE_PAS};
-  uint64_t VA, rd_data, size;
   MEM_REGN_INFO_TABLE *mem_region_pas_filter_cfg;
+  PROBE_MATRIX *mx;
+  PROBE_DESC *probe;
 
   mem_region_pas_filter_cfg = val_mem_pas_info_table();
   num_regn = mem_region_pas_filter_cfg->header.num_of_regn_pas_filter;
-  shared_data->shared_data_access[0].data = INIT_DATA;
-  size = val_get_min_tg();
-  VA = val_get_free_va(num_regn * NUM_PAS * size);
   set_daif();
-  attr = LOWER_ATTRS(PGT_ENTRY_ACCESS | SHAREABLE_ATTR(NON_SHAREABLE) | PGT_ENTRY_AP_RW);
 
-  for (uint32_t regn_cnt = 0; regn_cnt < num_regn; ++regn_cnt)
+  mx = val_memory_calloc(1, sizeof(PROBE_MATRIX));
+  if (mx == NULL)
   {
+    val_print(ACS_PRINT_ERR, " Failed to allocate the probe matrix", 0);
+    val_set_status(index, "FAIL", 02);
+    return;
+  }
+  mx->va = val_get_free_va(val_get_min_tg());
+  mx->attr = LOWER_ATTRS(PGT_ENTRY_ACCESS | SHAREABLE_ATTR(NON_SHAREABLE) | PGT_ENTRY_AP_RW);
+  /* As with the PAS filter load at EL3, the value read is not returned */
+  mx->flags = PROBE_MASK_ASYNC | PROBE_DISCARD_LOAD;
 
-    shared_data->arg0 = mem_region_pas_filter_cfg->regn_info[regn_cnt].base_addr;
-    security_state = mem_region_pas_filter_cfg->regn_info[regn_cnt].resourse_pas;
-    val_print(ACS_PRINT_TEST, " Checking the PAS filtering for the resource: 0x%llx",
-              shared_data->arg0);
-
-    for (int pas_cnt = 0; pas_cnt < 4; ++pas_cnt)
+  while (regn_cnt < num_regn)
+  {
+    /* Fill the matrix with as many whole resources as it holds */
+    first_regn = regn_cnt;
+    mx->num_probes = 0;
+    for (; regn_cnt < num_regn && mx->num_probes + NUM_PAS <= MAX_PROBE_DESC; ++regn_cnt)
     {
-      shared_data->arg1 = pas_list[pas_cnt];/* GPI */
-      if (val_add_mmu_entry_el3(VA, shared_data->arg0,
-          attr | LOWER_ATTRS(PAS_ATTR(shared_data->arg1))))
+      val_print(ACS_PRINT_TEST, " Checking the PAS filtering for the resource: 0x%llx",
+                mem_region_pas_filter_cfg->regn_info[regn_cnt].base_addr);
+
+      for (int pas_cnt = 0; pas_cnt < NUM_PAS; ++pas_cnt)
       {
-        val_print(ACS_PRINT_ERR, " Failed to add MMU entry for VA 0x%llx", VA);
-        status_fail_cnt++;
-        continue;
+        probe = &mx->probe[mx->num_probes++];
+        probe->pa = mem_region_pas_filter_cfg->regn_info[regn_cnt].base_addr;
+        probe->access_pas = pas_list[pas_cnt];
+        probe->access_type = READ_DATA;
+        probe->data = INIT_DATA;
       }
+    }
 
-      if (security_state == pas_list[pas_cnt]) {
+    if (val_probe_matrix_el3(mx))
+    {
+      val_print(ACS_PRINT_ERR, " Failed to probe the resources from 0x%llx",
+                mem_region_pas_filter_cfg->regn_info[first_regn].base_addr);
+      status_fail_cnt++;
+      continue;
+    }
 
-        shared_data->exception_expected = CLEAR;
-        shared_data->access_mut = SET;
-        shared_data->arg1 = VA;
-        if (val_pe_access_mut_el3())
-        {
-          val_print(ACS_PRINT_ERR, " Failed to access VA = 0x%lx", VA);
-          status_fail_cnt++;
-        }
+    for (probe_cnt = 0; probe_cnt < mx->num_probes; ++probe_cnt)
+    {
+      probe = &mx->probe[probe_cnt];
+      security_state =
+          mem_region_pas_filter_cfg->regn_info[first_regn + probe_cnt / NUM_PAS].resourse_pas;
 
-        if (shared_data->exception_generated == SET)
+      if (security_state == probe->access_pas) {
+        if (PROBE_GPF(mx, probe_cnt))
         {
           val_print(ACS_PRINT_ERR,
                     "  The exception is generated when Resource PAS and Access PAS are same", 0);
           status_fail_cnt++;
         }
-      } else {
-        shared_data->exception_expected = SET;
-        shared_data->access_mut = SET;
-        shared_data->pas_filter_flag = SET;
-        shared_data->arg1 = VA;
-        if (val_pe_access_mut_el3())
-        {
-          val_print(ACS_PRINT_ERR, " Failed to access VA = 0x%lx", VA);
-          status_fail_cnt++;
-        }
-        rd_data = shared_data->shared_data_access[0].data;
-        shared_data->pas_filter_flag = CLEAR;
-        shared_data->exception_expected = CLEAR;
+        continue;
+      }
 
-        val_print(ACS_PRINT_DEBUG, " The data read when res pas != acc pas is 0x%lx", rd_data);
-        /* If fault is not generated, then the load of the address must not be updated */
-        if (shared_data->exception_generated == CLEAR)
-        {
-          if (rd_data != INIT_DATA) {
-            val_print(ACS_PRINT_ERR, "  Unexpected successful access when resource pas \
-                            is not same as access pas", 0);
-            status_fail_cnt++;
-          }
-        }
-        shared_data->exception_generated = CLEAR;
+      val_print(ACS_PRINT_DEBUG, " The data read when res pas != acc pas is 0x%lx", probe->data);
+      /* If fault is not generated, then the load of the address must not be updated */
+      if (!PROBE_GPF(mx, probe_cnt) && probe->data != INIT_DATA)
+      {
+        val_print(ACS_PRINT_ERR, "  Unexpected successful access when resource pas \
+                        is not same as access pas", 0);
+        status_fail_cnt++;
       }
-      VA += size;
     }
   }
+  val_memory_free(mx);
 
   val_print(ACS_PRINT_DEBUG, " The accesses did not go as expected for %d times",
                   status_fail_cnt);
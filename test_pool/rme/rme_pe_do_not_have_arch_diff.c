@@ -252,8 +252,7 @@ payload(uint32_t num_pe)
           timeout = TIMEOUT_LARGE;
           val_print(ACS_PRINT_TEST, " Executing id_regs_check on PE index = %d", i);
           val_execute_on_pe(i, id_regs_check, 0);
-          while ((--timeout) && (IS_RESULT_PENDING(val_get_status(i))))
-                  ;
+          timeout = val_wait_for_pe_completion(i, timeout);
 
           if (timeout == 0) {
               val_print(ACS_PRINT_ERR, " **Timed out** for PE index = %d", i);
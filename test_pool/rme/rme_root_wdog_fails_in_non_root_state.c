@@ -61,7 +61,7 @@ static void isr(void)
 static void payload(void)
 {
 
-  uint32_t timeout;
+  uint64_t deadline;
   uint64_t timer_expire_ticks = 1;
   uint64_t size, rt_wdog_ctl;
   uint32_t index                 = val_pe_get_index_mpid(val_pe_get_mpid()), attr;
@@ -79,7 +79,6 @@ static void payload(void)
     return;
   }
 
-  timeout      = val_get_counter_frequency() * 2;
   counter_freq = val_get_counter_frequency();
 
   val_print(ACS_PRINT_DEBUG, " Root watchdog Interrupt id  %d", int_id);
@@ -113,10 +112,12 @@ static void payload(void)
     return;
   }
 
-  while ((--timeout > 0) && (IS_RESULT_PENDING(val_get_status(index))))
+  /* Allow twice the large timeout for WS0 to fire */
+  deadline = val_deadline_start(TIMEOUT_LARGE * 2);
+  while (IS_RESULT_PENDING(val_get_status(index)) && !val_deadline_expired(deadline))
     ;
 
-  if (timeout == 0)
+  if (IS_RESULT_PENDING(val_get_status(index)))
   {
     val_print(ACS_PRINT_ERR, " WS0 Interrupt not received on %d", int_id);
     val_set_status(index, "PASS", 3);
@@ -65,7 +65,8 @@ payload()
 {
 
     uint64_t timer_expire_ticks = 1;
-    uint32_t index = val_pe_get_index_mpid(val_pe_get_mpid()), timeout, attr;
+    uint32_t index = val_pe_get_index_mpid(val_pe_get_mpid()), attr;
+    uint64_t deadline;
     uint64_t size, rt_wdog_ctl_reg;
     uint64_t rt_wdog_ctl_available = val_get_rt_wdog_ctrl();
 
@@ -83,9 +84,8 @@ payload()
 
     VA_RT_WDOG = val_get_free_va(size);
 
-    timeout = val_get_counter_frequency() * 2;
     counter_freq = val_get_counter_frequency();
-    val_print(ACS_PRINT_DEBUG, " Timer value = 0x%lx  ", timeout);
+    val_print(ACS_PRINT_DEBUG, " Timer value = 0x%lx  ", counter_freq * 2);
     val_print(ACS_PRINT_DEBUG, " Root watchdog Interrupt id  %d", int_id);
 
     if (val_gic_install_isr(int_id, isr)) {
@@ -115,9 +115,11 @@ payload()
         return;
     }
 
-    while ((--timeout > 0) && (IS_RESULT_PENDING(val_get_status(index))));
+    /* Allow twice the large timeout for WS0 to fire */
+    deadline = val_deadline_start(TIMEOUT_LARGE * 2);
+    while (IS_RESULT_PENDING(val_get_status(index)) && !val_deadline_expired(deadline));
 
-    if (timeout == 0) {
+    if (IS_RESULT_PENDING(val_get_status(index))) {
             val_print(ACS_PRINT_ERR, " WS0 Interrupt not received on %d", int_id);
             val_set_status(index, "FAIL", 05);
             return;
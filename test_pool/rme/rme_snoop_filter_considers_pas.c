@@ -136,8 +136,7 @@ void payload1(void)
       sec_index = my_index+1;
   timeout = TIMEOUT_MEDIUM;
   val_execute_on_pe(sec_index, payload2, 0);
-  while  ((--timeout) && (IS_RESULT_PENDING(val_get_status(sec_index))))
-          ;
+  timeout = val_wait_for_pe_completion(sec_index, timeout);
   if (!timeout)
   {
     val_print(ACS_PRINT_ERR, " **Timed out** for PE index = %d", sec_index);
@@ -91,9 +91,8 @@ void payload(uint32_t num_pe)
   for (uint32_t i = 0; i < num_pe; i++) {
     if (i != index) {
           timeout = TIMEOUT_LARGE;
-          val_execute_on_pe(i, write_reg, 0);
-          while ((--timeout) && (IS_RESULT_PENDING(val_get_status(i))))
-                  ;
+          val_execute_on_pe_cold(i, write_reg, 0);
+          timeout = val_wait_for_pe_completion(i, timeout);
 
           if (timeout == 0) {
               val_print(ACS_PRINT_ERR, " **Timed out** for PE index = %d", i);
@@ -125,9 +124,8 @@ reset_done:
   for (uint32_t i = 0; i < num_pe; i++) {
     if (i != index) {
           timeout = TIMEOUT_LARGE;
-          val_execute_on_pe(i, check_reg_val, 0);
-          while ((--timeout) && (IS_RESULT_PENDING(val_get_status(i))))
-                  ;
+          val_execute_on_pe_cold(i, check_reg_val, 0);
+          timeout = val_wait_for_pe_completion(i, timeout);
 
           if (timeout == 0) {
               val_print(ACS_PRINT_ERR, " **Timed out** for PE index = %d", i);
@@ -32,7 +32,7 @@ void
 payload(void)
 {
     uint32_t index = val_pe_get_index_mpid(val_pe_get_mpid());
-    uint32_t timeout = TIMEOUT_LARGE;
+    uint64_t deadline;
 
     cntps_intid = val_timer_get_info(TIMER_INFO_SEC_PHY_EL1_INTID, 0);
 
@@ -56,12 +56,13 @@ payload(void)
         return;
     }
  
-    while ((--timeout > 0) && irq_pending) {
+    deadline = val_deadline_start(TIMEOUT_LARGE);
+    while (irq_pending && !val_deadline_expired(deadline)) {
         /* spin */
         ; 
     }
 
-    if (timeout == 0) {
+    if (irq_pending) {
         val_print(ACS_PRINT_ERR, " CNTPS interrupt not received on INTID: %d ", cntps_intid);
         val_cntps_disable_el3();
         val_set_status(index, "FAIL", 4);
@@ -150,10 +150,10 @@ static void payload(void)
         val_timer_set_sec_phy_el2(ticks);
     }
 
-    uint32_t timeout = TIMEOUT_LARGE >> 2;
-    while ((--timeout > 0) && g_irq_pending) { /* spin */ }
+    uint64_t deadline = val_deadline_start(TIMEOUT_LARGE >> 2);
+    while (g_irq_pending && !val_deadline_expired(deadline)) { /* spin */ }
 
-    if (timeout == 0 || g_irq_pending) {
+    if (g_irq_pending) {
         val_print(ACS_PRINT_ERR, " S-EL2 timer did not fire on INTID %u ", g_intid);
         val_set_status(index, "FAIL", 7);
         return;
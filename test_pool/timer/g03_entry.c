@@ -140,8 +140,8 @@ payload(void)
         g_irq_pend = 1;
         val_timer_set_sec_virt_el2(ticks);
     }
-    uint32_t timeout = TIMEOUT_LARGE >> 2;
-    while (timeout-- && g_irq_pend) { }
+    uint64_t deadline = val_deadline_start(TIMEOUT_LARGE >> 2);
+    while (g_irq_pend && !val_deadline_expired(deadline)) { }
 
     if (g_irq_pend) {
         val_print(ACS_PRINT_ERR, " CNTHVS interrupt did not arrive on INTID %u ", g_intid);
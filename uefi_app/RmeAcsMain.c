@@ -53,8 +53,12 @@ UINT32 g_rme_tests_fail;
 UINT64 g_stack_pointer;
 UINT64 g_exception_ret_addr;
 UINT64 g_ret_addr;
-UINT32 g_wakeup_timeout;
+UINT32 g_timeout_multiple;
 UINT32 g_rl_smmu_init;
+UINT32 g_pcie_full_scan;
+UINT32 g_print_buffered;
+UINT32 g_pe_fanout;
+UINT32 g_pe_resident;
 SHELL_FILE_HANDLE g_rme_log_file_handle;
 
 /* When -cfg is passed, parse the INI and set globals accordingly.
@@ -284,6 +288,37 @@ STATIC VOID ApplyIniRmeConfig(CONST CHAR16* IniText)
               if (val[0] == L'1' || StrCmp(val, L"true") == 0 || StrCmp(val, L"TRUE") == 0)
                 g_print_mmio = TRUE;
             }
+            else if (StrCmp(key, L"RME_PCIE_FULL_SCAN") == 0)
+            {
+              // Optional key to probe every BDF instead of following the PCIe topology
+              if (val[0] == L'1' || StrCmp(val, L"true") == 0 || StrCmp(val, L"TRUE") == 0)
+                g_pcie_full_scan = TRUE;
+            }
+            else if (StrCmp(key, L"RME_PRINT_BUFFERED") == 0)
+            {
+              // Optional key to record prints per PE and emit them at test boundaries
+              if (val[0] == L'1' || StrCmp(val, L"true") == 0 || StrCmp(val, L"TRUE") == 0)
+                g_print_buffered = TRUE;
+            }
+            else if (StrCmp(key, L"RME_PE_FANOUT") == 0)
+            {
+              // Optional key to wake PEs in a tree and start multi-PE payloads together
+              if (val[0] == L'1' || StrCmp(val, L"true") == 0 || StrCmp(val, L"TRUE") == 0)
+                g_pe_fanout = TRUE;
+            }
+            else if (StrCmp(key, L"RME_PE_RESIDENT") == 0)
+            {
+              // Optional key to keep secondary PEs parked between tests
+              if (val[0] == L'1' || StrCmp(val, L"true") == 0 || StrCmp(val, L"TRUE") == 0)
+                g_pe_resident = TRUE;
+            }
+            else if (StrCmp(key, L"RME_TIMEOUT") == 0)
+            {
+              // Optional key to scale every wait budget, same as -timeout
+              g_timeout_multiple = (UINT32)StrDecimalToUintn(val);
+              if (g_timeout_multiple > 5)
+                g_timeout_multiple = 5;
+            }
           }
         }
       }
@@ -476,6 +511,9 @@ createPeripheralInfoTable()
 VOID freeRmeAcsMem()
 {
 
+  val_mem_pool_print_stats_el3();
+  val_log_ring_free();
+  val_pe_resident_release_all();
   val_pe_free_info_table();
   val_gic_free_info_table();
   val_timer_free_info_table();
@@ -508,6 +546,11 @@ VOID HelpMsg(VOID)
         "-p2p    Pass this flag to indicate that PCIe Hierarchy Supports Peer-to-Peer\n"
         "-cache  Pass this flag to indicate that if the test system supports PCIe address "
         "translation cache\n"
+        "-pcie_full_scan Probe every PCIe Bus/Dev/Func instead of following the topology\n"
+        "-logbuf Record prints per PE and emit them at test boundaries\n"
+        "-fanout Wake PEs in a tree and start multi-PE payloads together\n"
+        "-resident Keep secondary PEs parked between tests instead of powering them off\n"
+        "-timeout Multiple (1 to 5) applied to every wait budget, for slow models\n"
         "-cfg    Provide an INI path to run using [RME_COMMAND_CONFIG] and [PLATFORM_CONFIG]\n"
         "        from the file. When -cfg is present, legacy flags (-v/-t/-m/-skip/-f/etc.)\n"
         "        are ignored and the INI is authoritative.\n");
@@ -524,6 +567,11 @@ STATIC CONST SHELL_PARAM_ITEM ParamList[]
        {L"-m", TypeValue},    // -m    # Module to be run
        {L"-p2p", TypeFlag},   // -p2p  # Peer-to-Peer is supported
        {L"-cache", TypeFlag}, // -cache# PCIe address translation cache is supported
+       {L"-pcie_full_scan", TypeFlag}, // -pcie_full_scan # Exhaustive PCIe BDF scan
+       {L"-logbuf", TypeFlag}, // -logbuf # Buffered per-PE prints
+       {L"-fanout", TypeFlag}, // -fanout # Tree wake-up of secondary PEs
+       {L"-resident", TypeFlag}, // -resident # Parked secondary PEs between tests
+       {L"-timeout", TypeValue}, // -timeout # Wait budget multiple
        {L"-cfg", TypeValue},  // -cfg  # Override INI path (e.g., \config\acs_run_rdv3_config.ini)
        {NULL, TypeMax}};
 
@@ -644,6 +692,11 @@ INTN EFIAPI ShellAppMainrme(IN UINTN Argc, IN CHAR16** Argv)
     }
     g_print_level = G_PRINT_LEVEL; // reset to default before applying INI
     g_print_mmio  = FALSE;
+    g_pcie_full_scan = FALSE;
+    g_print_buffered = FALSE;
+    g_pe_fanout = FALSE;
+    g_pe_resident = FALSE;
+    g_timeout_multiple = 1;
     CHAR16* iniText = NULL;
     UINTN iniBytes  = 0;
     EFI_STATUS S    = ReadAsciiFileToWide(CmdLineArg, &iniText, &iniBytes);
@@ -723,14 +776,14 @@ INTN EFIAPI ShellAppMainrme(IN UINTN Argc, IN CHAR16** Argv)
     CmdLineArg = ShellCommandLineGetValue(ParamPackage, L"-timeout");
     if (CmdLineArg == NULL)
     {
-      g_wakeup_timeout = 1;
+      g_timeout_multiple = 1;
     }
     else
     {
-      g_wakeup_timeout = StrDecimalToUintn(CmdLineArg);
-      Print(L"\nWakeup timeout multiple %d.", g_wakeup_timeout);
-      if (g_wakeup_timeout > 5)
-        g_wakeup_timeout = 5;
+      g_timeout_multiple = StrDecimalToUintn(CmdLineArg);
+      Print(L"\nTimeout multiple %d.", g_timeout_multiple);
+      if (g_timeout_multiple > 5)
+        g_timeout_multiple = 5;
     }
 
     // Options with Values
@@ -775,6 +828,26 @@ INTN EFIAPI ShellAppMainrme(IN UINTN Argc, IN CHAR16** Argv)
       g_pcie_cache_present = TRUE;
     else
       g_pcie_cache_present = FALSE;
+
+    if (ShellCommandLineGetFlag(ParamPackage, L"-pcie_full_scan"))
+      g_pcie_full_scan = TRUE;
+    else
+      g_pcie_full_scan = FALSE;
+
+    if (ShellCommandLineGetFlag(ParamPackage, L"-logbuf"))
+      g_print_buffered = TRUE;
+    else
+      g_print_buffered = FALSE;
+
+    if (ShellCommandLineGetFlag(ParamPackage, L"-fanout"))
+      g_pe_fanout = TRUE;
+    else
+      g_pe_fanout = FALSE;
+
+    if (ShellCommandLineGetFlag(ParamPackage, L"-resident"))
+      g_pe_resident = TRUE;
+    else
+      g_pe_resident = FALSE;
   }
 
   // Options with Values
@@ -934,6 +1007,11 @@ INTN EFIAPI ShellAppMainrme(IN UINTN Argc, IN CHAR16** Argv)
   Status = createPeInfoTable();
   if (Status)
     return Status;
+  Status = val_shared_data_assign_slots();
+  if (Status)
+    return Status;
+  if (g_print_buffered)
+    val_log_ring_init(val_pe_get_num());
 
   Status = createGicInfoTable();
   if (Status)
@@ -982,6 +1060,8 @@ INTN EFIAPI ShellAppMainrme(IN UINTN Argc, IN CHAR16** Argv)
   Status |= val_timer_execute_tests(val_pe_get_num());
 
 print_test_status:
+  val_test_stats_report();
+
   val_print(ACS_PRINT_ALWAYS, "\n------------------------------------------------------- \n", 0);
   val_print(ACS_PRINT_ALWAYS, " Total Tests run  = %4d;", g_rme_tests_total);
   val_print(ACS_PRINT_ALWAYS, " Tests Passed  = %4d", g_rme_tests_pass);
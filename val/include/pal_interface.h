@@ -97,9 +97,10 @@ typedef uint64_t dma_addr_t; // add if you need it on UEFI
 #define TIMEOUT_MEDIUM PLATFORM_OVERRIDE_TIMEOUT_MEDIUM
 #define TIMEOUT_SMALL  PLATFORM_OVERRIDE_TIMEOUT_SMALL
 #else
-#define TIMEOUT_LARGE  0x1000000
-#define TIMEOUT_MEDIUM 0x100000
-#define TIMEOUT_SMALL  0x1000
+/* Wait budgets in microseconds, see val_deadline_start */
+#define TIMEOUT_LARGE  1000000
+#define TIMEOUT_MEDIUM 100000
+#define TIMEOUT_SMALL  1000
 #endif
 
 #if PLATFORM_OVERRIDE_MAX_BDF
@@ -594,6 +595,8 @@ uint32_t pal_pcie_get_rp_transaction_frwd_support(uint32_t seg, uint32_t bus, ui
                                                   uint32_t fn);
 uint32_t pal_device_lock(uint32_t bdf);
 uint32_t pal_device_unlock(uint32_t bdf);
+uint32_t pal_device_lock_all(uint32_t *bdf, uint32_t count, uint32_t *status);
+uint32_t pal_device_unlock_all(uint32_t *bdf, uint32_t count, uint32_t *status);
 
 /* Common Definitions */
 void pal_print(char8_t *string, uint64_t data);
@@ -626,6 +629,9 @@ uint32_t pal_mem_page_size(void);
 void *pal_mem_alloc_pages(uint32_t num_pages);
 void pal_mem_free_pages(void *page_base, uint32_t num_pages);
 void *pal_aligned_alloc(uint32_t alignment, uint32_t size);
+void *pal_mem_alloc_persistent(uint32_t size);
+void pal_mem_arena_open(void);
+void pal_mem_arena_rewind(void);
 
 uint32_t pal_mmio_read(uint64_t addr);
 uint64_t pal_mmio_read64(uint64_t addr);
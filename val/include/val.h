@@ -23,11 +23,26 @@
 #include "val_cfg.h"
 #include "val_common.h"
 
+/* Numeric completion word of VAL_SHARED_MEM_t, polled by the primary PE */
+#define VAL_PE_STATUS_PENDING 0x1
+#define VAL_PE_STATUS_DONE    0x2
+
+/* Mailbox states of a resident worker PE in VAL_SHARED_MEM_t */
+#define VAL_PE_MBOX_OFF    0x0  // powered off, wake with PSCI CPU_ON
+#define VAL_PE_MBOX_PARKED 0x1  // waiting in WFE for a payload
+#define VAL_PE_MBOX_RUN    0x2  // payload posted, picked up on the next wake-up
+#define VAL_PE_MBOX_BUSY   0x3  // running a payload
+#define VAL_PE_MBOX_EXIT   0x4  // leave the park loop and power off
+
 typedef struct {
   uint64_t data0;
   uint64_t data1;
   char8_t    state[64];   // "PASS", "FAIL", etc.
   uint32_t   checkpoint;
+  uint32_t   status __attribute__((aligned(64))); // VAL_PE_STATUS_*, own cache line
+  uint32_t   arrived __attribute__((aligned(64))); // last fan-out generation reached
+  uint32_t   mailbox __attribute__((aligned(64))); // VAL_PE_MBOX_*, own cache line
+  uint32_t   resident; // park in the mailbox after the payload instead of CPU_OFF
 } __attribute__((aligned(64))) VAL_SHARED_MEM_t;
 
 uint64_t
@@ -69,6 +84,18 @@ val_get_free_pa(uint64_t size, uint64_t alignment);
 uint64_t
 val_get_free_va(uint64_t size);
 
+void
+val_release_free_pa(uint64_t pa);
+
+void
+val_release_free_va(uint64_t va);
+
+void
+val_open_test_windows(void);
+
+void
+val_release_test_windows(void);
+
 uint64_t
 val_get_min_tg(void);
 
@@ -36,5 +36,10 @@ extern uint32_t g_num_tests;
 extern char8_t **g_execute_modules_str;
 extern uint32_t g_num_modules;
 extern uint32_t g_rl_smmu_init;
+extern uint32_t g_pcie_full_scan;
+extern uint32_t g_print_buffered;
+extern uint32_t g_pe_fanout;
+extern uint32_t g_pe_resident;
+extern uint32_t g_timeout_multiple;
 
 #endif
@@ -82,10 +82,42 @@ val_check_for_error(uint32_t num_pe);
 void
 val_run_test_payload(uint32_t num_pe, void (*payload)(void), uint64_t test_input);
 
+uint32_t
+val_wait_for_pe_completion(uint32_t index, uint64_t timeout_us);
+
+uint64_t
+val_deadline_start(uint64_t timeout_us);
+
+uint32_t
+val_deadline_expired(uint64_t deadline);
+
 
 void
 val_data_cache_ops_by_va(addr_t addr, uint32_t type);
 
+/* Per-test resource counters, reported in the end of run summary */
+typedef enum {
+    VAL_STAT_SMC = 0,   /* Counted in UserCallSMC, PeTestSupport.S relies on the value */
+    VAL_STAT_PCIE_CFG_READ,
+    VAL_STAT_PCIE_CFG_WRITE,
+    VAL_STAT_MMIO,
+    VAL_STAT_PSCI_WAKE,
+    VAL_STAT_ALLOC_BYTES,
+    VAL_STAT_MAX
+} VAL_STAT_e;
+
+void
+val_test_stats_open(char8_t *testname);
+
+void
+val_test_stats_close(void);
+
+void
+val_test_stats_count(uint32_t type, uint64_t value);
+
+void
+val_test_stats_report(void);
+
 /* Module specific print APIs */
 
 typedef enum {
@@ -39,6 +39,12 @@ val_device_lock(uint32_t bdf);
 uint32_t
 val_device_unlock(uint32_t bdf);
 
+uint32_t
+val_device_lock_all(uint32_t *bdf, uint32_t count, uint32_t *status);
+
+uint32_t
+val_device_unlock_all(uint32_t *bdf, uint32_t count, uint32_t *status);
+
 uint32_t
 val_get_sel_str_status(uint32_t bdf, uint32_t str_cnt, uint32_t *str_status);
 
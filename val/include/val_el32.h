@@ -43,6 +43,13 @@
 #define SMC_FID_GET_SCR_EL3       0x19  /* fast call, 64b convention */
 #define SMC_FID_UPDATE_SCR_EL3    0x20  /* Arg1=set_bits, Arg2=clear_bits */
 #define SMMU_READ_CFG_BANK        0x21
+#define RME_ADD_GPT_RANGE         0x22  /* Arg0=base PA, Arg1=size, Arg2=GPI */
+#define RME_ADD_MMU_ENTRIES       0x23  /* Descriptors in shared_data->mmu_map */
+#define RME_MEM_POOL_STATS        0x24  /* Arg0=NS MEM_POOL_STATS buffer */
+#define RME_RELEASE_WINDOWS       0x25  /* Descriptors in shared_data->mmu_map */
+#define RME_PROBE_MATRIX          0x26  /* Arg0=NS PROBE_MATRIX table */
+#define RME_CMO_RANGE             0x27  /* Arg0=PA, Arg1=size, Arg2=CMO_RANGE_ARG */
+#define RME_READ_EL3_LOG          0x28  /* Arg0=NS EL3_LOG_RING copy */
 
 /* General Defines used by tests */
 #define INIT_DATA            0x11
@@ -52,6 +59,20 @@
 #define RANDOM_DATA_4        0x33
 #define READ_DATA            0
 #define WRITE_DATA           1
+#define FILL_RANGE           2  /* Store data over [addr, addr + size) */
+#define COMPARE_RANGE        3  /* Check [addr, addr + size) against data */
+#define COPY_RANGE           4  /* Copy [buf, buf + size) to addr */
+#define READ_RANGE           5  /* Copy [addr, addr + size) to buf */
+
+/* Access width in access_type[11:8], 32-bit when not specified */
+#define ACCESS_TYPE_MASK     0xFF
+#define ACCESS_WIDTH_SHIFT   8
+#define ACCESS_WIDTH_MASK    (0xF << ACCESS_WIDTH_SHIFT)
+#define ACCESS_WIDTH_32      0x0
+#define ACCESS_WIDTH_8       0x1
+#define ACCESS_WIDTH_16      0x2
+#define ACCESS_WIDTH_64      0x3
+#define MUT_ACCESS(type, width) ((type) | ((width) << ACCESS_WIDTH_SHIFT))
 #define CLEAN_AND_INVALIDATE 0x1
 #define CLEAN                0x2
 #define INVALIDATE           0x3
@@ -67,6 +88,8 @@
 #define SMMU_CHECK_MEC_IMPL    0x7
 #define SMMU_GET_MECIDW        0x8
 #define SMMU_CONFIG_MECID      0x9
+#define SMMU_RLM_ADD_DPT_RANGE 0xA
+#define SMMU_RLM_SMMU_UNMAP    0xB
 
 #define SMMU_R_PAGE_0_OFFSET 0x40000
 #define SMMU_R_PAGE_1_OFFSET 0x50000
@@ -93,6 +116,13 @@
 #define CNTHPS_PROGRAM  0x3
 #define CNTHPS_DISABLE  0x4
 
+/* RME_CMO_RANGE operations, Arg2 carries the access PAS in [7:0] */
+#define CMO_OP_POPA            0x1
+#define CMO_OP_POE             0x2
+#define CMO_RANGE_OP_SHIFT     8
+#define CMO_RANGE_PAS_MASK     0xFF
+#define CMO_RANGE_ARG(pas, op) (((uint64_t)(op) << CMO_RANGE_OP_SHIFT) | (pas))
+
 /* MEC services */
 #define ENABLE_MEC   0x1
 #define CONFIG_MECID 0x2
@@ -161,8 +191,108 @@ typedef struct shared_data_access {
   uint64_t access_type;
   uint64_t addr;
   uint64_t data;
+  uint64_t size;    /* Bytes covered by the range accesses */
+  uint64_t buf;     /* Source of COPY_RANGE, destination of READ_RANGE */
+  uint64_t result;  /* COMPARE_RANGE: address of the first mismatch, 0 if none */
 } SHARED_DATA_ACCESS;
 
+/* Maximum mappings passed in one RME_ADD_MMU_ENTRIES call */
+#define MAX_MMU_MAP_DESC 16
+
+/* GPI a released test PA window returns to */
+#define FREE_PA_RELEASE_GPI GPT_NONSECURE
+
+/* One EL3 mapping request, size of 0 maps a single granule */
+typedef struct mmu_map_desc {
+  uint64_t va;
+  uint64_t pa;
+  uint64_t attr;
+  uint64_t size;
+} MMU_MAP_DESC;
+
+/* DPT permission for a PA range, programmed in every SMMU set in smmu_mask */
+typedef struct dpt_range_desc {
+  uint64_t base;
+  uint64_t size;
+  uint64_t access;     /* DPT descriptor value, e.g. DPT_RDWR_ACCESS_ENTRY */
+  uint64_t smmu_mask;  /* bit n selects the SMMU at index n */
+  uint64_t flags;      /* DPT_RANGE_* */
+} DPT_RANGE_DESC;
+
+/* Leave the DPT invalidation to the caller, e.g. to test a stale DPT cache */
+#define DPT_RANGE_NO_DPTI 0x1
+
+/* Probes handled by one RME_PROBE_MATRIX call */
+#define MAX_PROBE_DESC   256
+
+/* Mask SError, IRQ and FIQ at EL3 while the probes run */
+#define PROBE_MASK_ASYNC 0x1
+
+/* Read probes leave data unchanged, the loaded value is discarded */
+#define PROBE_DISCARD_LOAD 0x2
+
+/* Probe n of the table took a GPF */
+#define PROBE_GPF(mx, n) (((mx)->gpf_map[(n) / 64] >> ((n) % 64)) & 0x1)
+
+/* One access of PA through an access PAS, esr and data are filled by EL3 */
+typedef struct probe_desc {
+  uint64_t pa;
+  uint64_t access_pas;
+  uint64_t access_type;  /* READ_DATA or WRITE_DATA */
+  uint64_t data;         /* Value stored, or loaded over this initial value */
+  uint64_t esr;          /* ESR_EL3 of the fault taken, 0 if the access completed */
+} PROBE_DESC;
+
+typedef struct probe_matrix {
+  uint64_t va;           /* Scratch VA, mapped to each probe PA in turn */
+  uint64_t attr;         /* Mapping attributes, the probe access PAS is added */
+  uint64_t flags;        /* PROBE_MASK_ASYNC, PROBE_DISCARD_LOAD */
+  uint64_t num_probes;
+  uint64_t gpf_map[MAX_PROBE_DESC / 64];  /* Bit n set when probe n took a GPF */
+  PROBE_DESC probe[MAX_PROBE_DESC];
+} PROBE_MATRIX;
+
+/* EL3 memory pool size classes, 64B to 64KB */
+#define MEM_POOL_NUM_CLASSES 11
+
+typedef struct mem_pool_class_stats {
+  uint64_t block_size;
+  uint64_t in_use;     /* Blocks currently allocated */
+  uint64_t peak;       /* Highest in_use seen */
+  uint64_t free;       /* Blocks on the class free list */
+  uint64_t allocs;
+  uint64_t frees;
+} MEM_POOL_CLASS_STATS;
+
+/* EL3 memory pool occupancy, returned by RME_MEM_POOL_STATS */
+typedef struct mem_pool_stats {
+  MEM_POOL_CLASS_STATS cls[MEM_POOL_NUM_CLASSES];
+  uint64_t large_in_use;  /* Allocations above the largest class */
+  uint64_t large_allocs;
+  uint64_t large_frees;
+} MEM_POOL_STATS;
+
+/* Events kept by the EL3 log ring, older ones are overwritten */
+#define EL3_LOG_NUM_EVENTS 128
+
+/* Event id of a fault taken by the EL3 handler, arg0-2 are ESR, FAR and ELR */
+#define EL3_LOG_FAULT      0xFA
+
+/* One EL3 service call or fault, recorded in place of a console print */
+typedef struct el3_log_event {
+  uint64_t timestamp;  /* CNTPCT when the event completed */
+  uint64_t mpidr;      /* Affinity of the PE the event ran on */
+  uint64_t id;         /* SMC service, or EL3_LOG_FAULT */
+  uint64_t arg[3];
+  uint64_t result;     /* status_code of the service, 1 for a handled GPF */
+} EL3_LOG_EVENT;
+
+/* EL3 log ring, returned by RME_READ_EL3_LOG */
+typedef struct el3_log_ring {
+  uint64_t head;       /* Events recorded so far, the next one goes to head % size */
+  EL3_LOG_EVENT event[EL3_LOG_NUM_EVENTS];
+} EL3_LOG_RING;
+
 #define MAX_NUM_REGISTERS_MSD 10
 
 typedef struct {
@@ -189,18 +319,47 @@ typedef struct shared_data_el32 {
   uint64_t pas_filter_flag;
   uint64_t generic_flag;
   reg_info_msd reg_info;
-  /* Optional runtime platform config (filled by NS world if available) */
-  uint64_t cfg_free_mem_start;   // Base for EL3 page table allocations
-  uint64_t cfg_free_mem_smmu;    // Base for EL3 memory pool
-  uint64_t cfg_memory_pool_size; // Size for EL3 memory pool
-  uint64_t cfg_smmu_root_reg_offset; // SMMU root register page offset
   uint64_t status_code;
   uint64_t error_code;
   char error_msg[128];
+  uint64_t num_mmu_map;
+  MMU_MAP_DESC mmu_map[MAX_MMU_MAP_DESC];
+  uint64_t cmo_ticks;  /* CNTPCT ticks spent in the last RME_CMO_RANGE */
   SHARED_DATA_ACCESS shared_data_access[];
 } struct_sh_data;
 
-extern struct_sh_data *shared_data;
+/* The EL3 shared region is one slot per PE followed by the global header page.
+ * Slot 0 keeps the EL3 exception frame and stack, used by the PE running the tests.
+ * Platforms with more PEs than SHARED_MAX_SLOTS must raise it at build time.
+ */
+#define SHARED_SLOT_SIZE   0x1000
+#ifndef SHARED_MAX_SLOTS
+#define SHARED_MAX_SLOTS   16
+#endif
+#define SHARED_HDR_OFFSET  (SHARED_MAX_SLOTS * SHARED_SLOT_SIZE)
+#define SHARED_REGION_SIZE (SHARED_HDR_OFFSET + SHARED_SLOT_SIZE)
+
+typedef struct shared_data_hdr {
+  uint64_t num_slots;
+  uint64_t slot_mpidr[SHARED_MAX_SLOTS];  /* Affinity of the PE owning slot n */
+  /* Optional runtime platform config (filled by EL3) */
+  uint64_t cfg_free_mem_start;   // Base for EL3 page table allocations
+  uint64_t cfg_free_mem_smmu;    // Base for EL3 memory pool
+  uint64_t cfg_memory_pool_size; // Size for EL3 memory pool
+  uint64_t cfg_smmu_root_reg_offset; // SMMU root register page offset
+} SHARED_DATA_HDR;
+
+/* Base of the shared region, 0 until it is mapped */
+extern uint64_t shared_data_base;
+
+#define shared_data_hdr ((SHARED_DATA_HDR *)(shared_data_base + SHARED_HDR_OFFSET))
+
+/* Slot of the calling PE, each world resolves it from its own MPIDR.
+ * NULL for a PE missing from the slot table.
+ */
+struct_sh_data *val_shared_data_slot(void);
+
+#define shared_data (val_shared_data_slot())
 
 /* Structure instance for MSD registers */
 typedef enum {
@@ -74,6 +74,9 @@ void val_allocate_shared_mem(void);
 void val_free_shared_mem(void);
 void val_print_raw(uint64_t uart_address, uint32_t level, char8_t *string, uint64_t data);
 void val_log_context(uint32_t level, char8_t *string, uint64_t data, const char *file, int line);
+void val_log_flush(void);
+void val_log_ring_init(uint32_t num_pe);
+void val_log_ring_free(void);
 void val_set_test_data(uint32_t index, uint64_t addr, uint64_t test_data);
 void val_get_test_data(uint32_t index, uint64_t *data0, uint64_t *data1);
 uint32_t val_strncmp(char8_t *str1, char8_t *str2, uint32_t len);
@@ -92,6 +95,10 @@ uint32_t val_pe_install_esr(uint32_t exception_type, void (*esr)(uint64_t, void
 uint64_t val_get_primary_mpidr(void);
 
 void val_execute_on_pe(uint32_t index, void (*payload)(void), uint64_t args);
+void val_pe_fanout_wake(uint32_t index, void (*payload)(void), uint64_t args);
+void val_execute_on_pe_cold(uint32_t index, void (*payload)(void), uint64_t args);
+void val_pe_resident_release(uint32_t index);
+void val_pe_resident_release_all(void);
 int val_suspend_pe(uint64_t entry, uint32_t context_id);
 
 /* Memory Tests APIs */
@@ -102,12 +109,18 @@ int val_suspend_pe(uint64_t entry, uint32_t context_id);
 #define MEM_ALIGN_64K 0x10000
 
 /* VAL RME APIs */
+struct mmu_map_desc;
 uint32_t val_rme_execute_tests(uint32_t num_pe);
 uint32_t val_data_cache_ops_by_va_el3(uint64_t address, uint32_t type);
 uint32_t val_memory_set_el3(void *buf, uint32_t size, uint8_t value);
 uint32_t val_add_mmu_entry_el3(uint64_t VA, uint64_t PA, uint64_t attr);
+uint32_t val_add_mmu_entries_el3(struct mmu_map_desc *desc, uint32_t num);
+uint32_t val_release_windows_el3(struct mmu_map_desc *desc, uint32_t num);
 uint32_t val_add_gpt_entry_el3(uint64_t PA, uint64_t gpi);
+uint32_t val_add_gpt_range_el3(uint64_t PA, uint64_t size, uint64_t gpi);
 uint32_t val_pe_access_mut_el3(void);
+struct probe_matrix;
+uint32_t val_probe_matrix_el3(struct probe_matrix *mx);
 uint32_t val_data_cache_ops_by_pa_el3(uint64_t PA, uint64_t acc_pas);
 uint32_t val_rme_install_handler_el3(void);
 uint32_t val_enable_ns_encryption(void);
@@ -125,8 +138,17 @@ uint32_t check_gpr_after_reset(void);
 uint32_t val_smmu_check_rmeda_el3(uint64_t smmu_base);
 uint32_t val_rlm_smmu_init(uint64_t num_smmu, uint64_t *smmu_base_arr);
 uint32_t val_smmu_rlm_map_el3(smmu_master_attributes_t *smmu_attr, pgt_descriptor_t *pgt_attr);
+uint32_t val_smmu_rlm_unmap_el3(smmu_master_attributes_t *smmu_attr);
 void val_register_create_info_table(uint64_t *register_info_table);
 uint32_t val_dpt_add_entry(uint64_t translated_addr, uint32_t smmu_index);
+uint32_t val_dpt_add_range(uint64_t base, uint64_t size, uint64_t access, uint64_t smmu_mask,
+                           uint64_t flags);
+struct mem_pool_stats;
+uint32_t val_mem_pool_stats_el3(struct mem_pool_stats *stats);
+void val_mem_pool_print_stats_el3(void);
+struct el3_log_ring;
+uint32_t val_read_log_el3(struct el3_log_ring *ring);
+void val_print_log_el3(uint32_t level);
 uint32_t val_dpt_invalidate_all(uint64_t smmu_index);
 uint32_t val_rlm_pgt_create(memory_region_descriptor_t *mem_desc, pgt_descriptor_t *pgt_desc);
 uint32_t val_rlm_pgt_destroy(pgt_descriptor_t *pgt_desc);
@@ -135,6 +157,7 @@ uint32_t val_rlm_disable_mec(void);
 uint32_t val_smmu_rlm_check_mec_impl(uint64_t smmu_base);
 uint32_t val_smmu_rlm_get_mecidw(uint64_t smmu_base);
 uint32_t val_cmo_to_poe(uint64_t PA);
+uint32_t val_cmo_range_el3(uint64_t PA, uint64_t size, uint64_t acc_pas, uint32_t op);
 uint32_t val_rlm_configure_mecid(uint32_t mecid);
 uint32_t val_smmu_rlm_configure_mecid(smmu_master_attributes_t *smmu_attr, uint32_t mecid);
 void val_map_shared_mem_el3(uint64_t shared_addr);
@@ -186,6 +209,11 @@ uint32_t val_gic_request_msi(uint32_t bdf, uint32_t device_id, uint32_t its_id,
                              uint32_t msi_index);
 void val_gic_free_msi(uint32_t bdf, uint32_t device_id, uint32_t its_id, uint32_t int_id,
                       uint32_t msi_index);
+uint32_t val_gic_request_msi_range(uint32_t bdf, uint32_t device_id, uint32_t its_id,
+                                   uint32_t base_int_id, uint32_t base_msi_index,
+                                   uint32_t num_msis);
+void val_gic_free_msi_range(uint32_t bdf, uint32_t device_id, uint32_t its_id,
+                            uint32_t base_int_id, uint32_t base_msi_index, uint32_t num_msis);
 uint32_t val_gic_its_get_base(uint32_t its_id, uint64_t *its_base);
 
 /*TIMER VAL APIs */
@@ -212,6 +240,7 @@ uint64_t val_smmu_read_cfg_el3(uint32_t smmu_idx, uint32_t reg_off /* SMMUv3 Pag
 
 /* Initialize runtime-dependent VAL globals (free mem, shared data, nvm). */
 void val_init_runtime_params(void);
+uint32_t val_shared_data_assign_slots(void);
 
 /* POWER and WAKEUP APIs */
 typedef enum {
@@ -29,5 +29,7 @@
 #define SIZE_4K  (4*1024)
 #define SIZE_16K (16*1024)
 #define SIZE_64K (64*1024)
+#define SIZE_2M  (2ULL*1024*1024)
+#define SIZE_1G  (1024ULL*1024*1024)
 
 #endif /* __MEM_INTERFACE_H__ */
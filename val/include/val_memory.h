@@ -39,6 +39,9 @@ void *val_memory_phys_to_virt(uint64_t pa);
 uint32_t val_memory_page_size(void);
 void *val_memory_alloc_pages(uint32_t num_pages);
 void val_memory_free_pages(void *page_base, uint32_t num_pages);
+void *val_memory_calloc_persistent(uint32_t num, uint32_t size);
+void val_memory_arena_open(void);
+void val_memory_arena_rewind(void);
 void *val_aligned_alloc(uint32_t alignment, uint32_t size);
 void val_memory_free_aligned(void *addr);
 uint32_t val_memory_compare_src_el3(uint32_t *src, uint32_t *dest, uint32_t size);
@@ -37,6 +37,7 @@
 
 #define PCIE_BUS_SHIFT 8
 #define PCIE_CFG_SIZE  4096
+#define PCIE_MAX_SEGMENT 256
 
 #define PCIE_INTERRUPT_LINE  0x3c
 #define PCIE_INTERRUPT_PIN   0x3d
@@ -154,11 +155,55 @@ typedef struct {
   pcie_device_attr device[];         ///< in the format of Segment/Bus/Dev/Func
 } pcie_device_bdf_table;
 
+#define PCIE_SHADOW_MAX_CAP   16
+#define PCIE_SHADOW_MAX_ECAP  32
+
+typedef struct {
+  uint16_t id;
+  uint16_t offset;
+} pcie_cap_index;
+
+/**
+  @brief    Shadow of the read-only config space fields of a function, kept for every
+            entry of the BDF table and indexed in the same order.
+  @valid          Set once the shadow has been populated from config space
+  @ridr           Revision ID / Class Code register
+  @hdr_type       Header Type register
+  @dp_type        Device/Port type, 0 until first computed
+  @rp_valid       Set once the rootport lookup below has been done
+  @rp_status      Return status of the rootport lookup
+  @rp_bdf         Rootport BDF of the function
+  @cap_overflow   Capability list is longer than PCIE_SHADOW_MAX_CAP
+  @ecap_overflow  Extended capability list is longer than PCIE_SHADOW_MAX_ECAP
+  @num_cap        Number of valid entries in cap[]
+  @num_ecap       Number of valid entries in ecap[]
+  @cap            Capability ID to offset index, in list order
+  @ecap           Extended Capability ID to offset index, in list order
+**/
+typedef struct {
+  uint8_t        valid;
+  uint8_t        hdr_type;
+  uint8_t        rp_valid;
+  uint8_t        cap_overflow;
+  uint8_t        ecap_overflow;
+  uint8_t        num_cap;
+  uint8_t        num_ecap;
+  uint32_t       ridr;
+  uint32_t       dp_type;
+  uint32_t       rp_status;
+  uint32_t       rp_bdf;
+  pcie_cap_index cap[PCIE_SHADOW_MAX_CAP];
+  pcie_cap_index ecap[PCIE_SHADOW_MAX_ECAP];
+} pcie_cfg_shadow;
+
 void     val_pcie_write_cfg(uint32_t bdf, uint32_t offset, uint32_t data);
 void     val_pcie_io_write_cfg(uint32_t bdf, uint32_t offset, uint32_t data);
 uint32_t val_pcie_read_cfg(uint32_t bdf, uint32_t offset, uint32_t *data);
 uint32_t val_get_msi_vectors(uint32_t bdf, PERIPHERAL_VECTOR_LIST **mvector);
 uint64_t val_pcie_get_bdf_config_addr(uint32_t bdf);
+void     val_pcie_get_ecam_map_stats(uint64_t *hits, uint64_t *misses);
+void     val_pcie_invalidate_cfg_shadow(uint32_t bdf);
+void     val_pcie_invalidate_all_cfg_shadow(void);
 
 uint32_t val_pcie_bar_mem_read(uint32_t bdf, uint64_t address, uint32_t *data);
 uint32_t val_pcie_bar_mem_write(uint32_t bdf, uint64_t address, uint32_t data);
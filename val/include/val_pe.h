@@ -389,6 +389,10 @@ uint64_t ArmRdvl(void);
 
 void ArmCallWFI(void);
 
+void ArmCallWFE(void);
+
+void ArmCallSEV(void);
+
 void ArmExecuteMemoryBarrier(void);
 
 void val_pe_update_elr(void *context, uint64_t offset);
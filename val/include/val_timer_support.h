@@ -22,6 +22,12 @@
 #define ARM_ARCH_TIMER_IMASK            (1 << 1)
 #define ARM_ARCH_TIMER_ISTATUS          (1 << 2)
 
+/* CNTHCTL_EL2/CNTKCTL_EL1 event stream, EVNTI = 7 generates an event every 256 ticks */
+#define CNTCTL_EVNTEN                   (1 << 2)
+#define CNTCTL_EVNTI_SHIFT              4
+#define CNTCTL_EVNTI_MASK               (0xF << CNTCTL_EVNTI_SHIFT)
+#define CNTCTL_EVNTI_WAIT               (0x7 << CNTCTL_EVNTI_SHIFT)
+
 typedef enum {
   CntFrq = 0,
   CntPct,
@@ -83,6 +89,16 @@ ArmWriteCntkCtl(
   uint64_t   Val
   );
 
+uint64_t
+ArmReadCnthCtl(
+  void
+  );
+
+void
+ArmWriteCnthCtl(
+  uint64_t   Val
+  );
+
 uint64_t
 ArmReadCntpTval(
   void
@@ -240,6 +240,34 @@ val_device_unlock(uint32_t bdf)
   return pal_device_unlock(bdf);
 }
 
+/**
+  @brief  Lock and start several TDISP endpoints concurrently. One DOE
+          request is kept outstanding per endpoint and the mailboxes are
+          polled round-robin. val_device_lock is the single device form.
+  @param  bdf     List of endpoint BDFs
+  @param  count   Number of endpoints
+  @param  status  Optional per-endpoint result, 0 on success
+  @return 0 if every endpoint reached RUN, 1 otherwise
+**/
+uint32_t
+val_device_lock_all(uint32_t *bdf, uint32_t count, uint32_t *status)
+{
+  return pal_device_lock_all(bdf, count, status);
+}
+
+/**
+  @brief  Stop several TDISP endpoints concurrently.
+  @param  bdf     List of endpoint BDFs
+  @param  count   Number of endpoints
+  @param  status  Optional per-endpoint result, 0 on success
+  @return 0 if every endpoint was stopped, 1 otherwise
+**/
+uint32_t
+val_device_unlock_all(uint32_t *bdf, uint32_t count, uint32_t *status)
+{
+  return pal_device_unlock_all(bdf, count, status);
+}
+
 uint32_t val_ide_set_sel_stream(uint32_t bdf, uint32_t str_cnt, uint32_t enable)
 {
   uint32_t reg_value;
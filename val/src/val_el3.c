@@ -96,6 +96,75 @@ val_add_mmu_entry_el3(uint64_t VA, uint64_t PA, uint64_t attr)
   }
 }
 
+/**
+ *  @brief   This API maps a list of VA/PA/attr/size descriptors at EL3.
+ *           Descriptors are passed through shared_data, MAX_MMU_MAP_DESC at a
+ *           time, so each chunk costs a single SMC and a single TLB invalidation.
+ *           Returns 1 on error, 0 on success.
+ *  @param   desc - Array of mapping descriptors, size of 0 maps one granule
+ *  @param   num  - Number of descriptors in desc
+ *  @return 1 on error, 0 on success
+**/
+uint32_t
+val_add_mmu_entries_el3(struct mmu_map_desc *desc, uint32_t num)
+{
+  uint32_t i, chunk;
+
+  while (num) {
+    chunk = (num > MAX_MMU_MAP_DESC) ? MAX_MMU_MAP_DESC : num;
+    for (i = 0; i < chunk; i++)
+      shared_data->mmu_map[i] = desc[i];
+    shared_data->num_mmu_map = chunk;
+
+    UserCallSMC(ARM_ACS_SMC_FID, RME_ADD_MMU_ENTRIES, 0, 0, 0);
+    if (shared_data->status_code != 0) {
+      if (val_pe_get_index_mpid(val_pe_get_mpid()) == 0)
+        val_print(ACS_PRINT_ERR, shared_data->error_msg, 0);
+      return 1;
+    }
+    desc += chunk;
+    num -= chunk;
+  }
+
+  val_print(ACS_PRINT_INFO, " EL3: MMU Entries added successfully", 0);
+  return 0;
+}
+
+/**
+ *  @brief   This API tears down released test windows at EL3. Descriptors with a
+ *           va remove the EL3 mappings of the range, descriptors with a pa return
+ *           the range to the GPI in attr. Each chunk of MAX_MMU_MAP_DESC costs a
+ *           single SMC and a single TLB and GPT invalidation.
+ *           Returns 1 on error, 0 on success.
+ *  @param   desc - Array of window descriptors
+ *  @param   num  - Number of descriptors in desc
+ *  @return 1 on error, 0 on success
+**/
+uint32_t
+val_release_windows_el3(struct mmu_map_desc *desc, uint32_t num)
+{
+  uint32_t i, chunk;
+
+  while (num) {
+    chunk = (num > MAX_MMU_MAP_DESC) ? MAX_MMU_MAP_DESC : num;
+    for (i = 0; i < chunk; i++)
+      shared_data->mmu_map[i] = desc[i];
+    shared_data->num_mmu_map = chunk;
+
+    UserCallSMC(ARM_ACS_SMC_FID, RME_RELEASE_WINDOWS, 0, 0, 0);
+    if (shared_data->status_code != 0) {
+      if (val_pe_get_index_mpid(val_pe_get_mpid()) == 0)
+        val_print(ACS_PRINT_ERR, shared_data->error_msg, 0);
+      return 1;
+    }
+    desc += chunk;
+    num -= chunk;
+  }
+
+  val_print(ACS_PRINT_INFO, " EL3: Test windows released successfully", 0);
+  return 0;
+}
+
 /**
  *  @brief  This API maps the shared memory at EL3 and populates the EL3 specific memory information
  *          Returns 1 on error, 0 on success.
@@ -132,6 +201,32 @@ val_add_gpt_entry_el3(uint64_t PA, uint64_t gpi)
   }
 }
 
+/**
+ *  @brief   This API maps a Physical Address range into the GPT table
+ *           with the specified GPI at EL3, using a single SMC and a single
+ *           GPT TLB invalidation for the whole range.
+ *           Returns 1 on error, 0 on success.
+ *  @param   PA - Base Physical Address of the range, granule aligned
+ *  @param   size - Size of the range in bytes, granule aligned
+ *  @param   gpi - GPI encoding required for the range
+ *  @return 1 on error, 0 on success
+**/
+uint32_t
+val_add_gpt_range_el3(uint64_t PA, uint64_t size, uint64_t gpi)
+{
+  UserCallSMC(ARM_ACS_SMC_FID, RME_ADD_GPT_RANGE, PA, size, gpi);
+  if (val_pe_get_index_mpid(val_pe_get_mpid()) != 0)
+      return shared_data->status_code ? 1 : 0;
+  if (shared_data->status_code != 0) {
+    val_print(ACS_PRINT_ERR, shared_data->error_msg, 0);
+    return 1;
+  }
+  else {
+    val_print(ACS_PRINT_INFO, " EL3: GPT range added successfully", 0);
+    return 0;
+  }
+}
+
 /**
  *  @brief   This API provides access to MUT at EL3 to write on or read from.
  *           Returns 1 on error, 0 on success.
@@ -153,6 +248,43 @@ val_pe_access_mut_el3(void)
   }
 }
 
+/**
+ *  @brief   This API runs a table of (PA, access PAS, read/write) probes at EL3 in a
+ *           single SMC. EL3 maps mx->va to each probe PA in turn, accesses it and
+ *           recovers from a fault without returning to the test. The GPFs taken are
+ *           reported in mx->gpf_map and the ESR_EL3 of any fault in each probe.
+ *           Returns 1 on error, 0 on success.
+ *  @param   mx - Probe table, at most MAX_PROBE_DESC probes
+ *  @return 1 on error, 0 on success
+**/
+uint32_t
+val_probe_matrix_el3(struct probe_matrix *mx)
+{
+  MMU_MAP_DESC map;
+
+  /* EL3 writes the results back through an NS mapping of the table */
+  map.va   = (uint64_t)mx;
+  map.pa   = (uint64_t)mx;
+  map.size = sizeof(PROBE_MATRIX);
+  map.attr = LOWER_ATTRS(PGT_ENTRY_ACCESS | SHAREABLE_ATTR(OUTER_SHAREABLE) |
+                         PGT_ENTRY_AP_RW | PAS_ATTR(NONSECURE_PAS));
+  if (val_add_mmu_entries_el3(&map, 1))
+    return 1;
+
+  shared_data->access_mut = CLEAR;
+  UserCallSMC(ARM_ACS_SMC_FID, RME_PROBE_MATRIX, (uint64_t)mx, 0, 0);
+  if (val_pe_get_index_mpid(val_pe_get_mpid()) != 0)
+      return shared_data->status_code ? 1 : 0;
+  if (shared_data->status_code != 0) {
+    val_print(ACS_PRINT_ERR, shared_data->error_msg, 0);
+    return 1;
+  }
+  else {
+    val_print(ACS_PRINT_INFO, " EL3: Probe matrix of %d accesses done", mx->num_probes);
+    return 0;
+  }
+}
+
 /**
  *  @brief  Clean and Invalidate the Data cache line containing
  *          the input physical address to the point of physical
@@ -495,6 +627,27 @@ uint32_t val_smmu_rlm_map_el3(smmu_master_attributes_t *smmu_attr, pgt_descripto
   }
 }
 
+/**
+ *  @brief  This API is used to clear the REALM STE of a master in el3 and release the
+ *          EL3 master record, so stream ids can be reused by later tests.
+ *          Streams which were never mapped are ignored.
+ *  @return 1 on error, 0 on success
+ */
+uint32_t val_smmu_rlm_unmap_el3(smmu_master_attributes_t *smmu_attr)
+{
+  UserCallSMC(ARM_ACS_SMC_FID, SMMU_CONFIG_SERVICE, SMMU_RLM_SMMU_UNMAP, (uint64_t)smmu_attr, 0);
+  if (val_pe_get_index_mpid(val_pe_get_mpid()) != 0)
+      return shared_data->status_code ? 1 : 0;
+  if (shared_data->status_code != 0) {
+    val_print(ACS_PRINT_ERR, shared_data->error_msg, shared_data->error_code);
+    return 1;
+  }
+  else {
+    val_print(ACS_PRINT_INFO, " EL3: SMMU_REALM page table removed successfully", 0);
+    return 0;
+  }
+}
+
 /**
  *  @brief  This API is used to Add a DPT entry to the DPT table at el3.
  *          Returns 1 on error, 0 on success.
@@ -516,6 +669,57 @@ uint32_t val_dpt_add_entry(uint64_t translated_addr, uint32_t smmu_index)
   }
 }
 
+/**
+ *  @brief  This API grants a DPT permission to a PA range in every SMMU set in
+ *          smmu_mask with a single SMC. EL3 fills the affected DPT descriptors
+ *          in one pass and invalidates each DPT once at the end, unless flags
+ *          has DPT_RANGE_NO_DPTI.
+ *  @param  base      Base PA of the range
+ *  @param  size      Size of the range in bytes
+ *  @param  access    DPT descriptor value, e.g. DPT_RDWR_ACCESS_ENTRY
+ *  @param  smmu_mask Bit n selects the SMMU at index n
+ *  @param  flags     DPT_RANGE_* flags
+ *  @return 1 on error, 0 on success
+ */
+uint32_t val_dpt_add_range(uint64_t base, uint64_t size, uint64_t access, uint64_t smmu_mask,
+                           uint64_t flags)
+{
+  /* EL3 reads the descriptor through an NS mapping, set up on first use */
+  static DPT_RANGE_DESC range;
+  static uint32_t range_mapped;
+  MMU_MAP_DESC map;
+
+  if (!range_mapped) {
+    map.va   = (uint64_t)&range;
+    map.pa   = (uint64_t)&range;
+    map.size = sizeof(range);
+    map.attr = LOWER_ATTRS(PGT_ENTRY_ACCESS | SHAREABLE_ATTR(OUTER_SHAREABLE) |
+                           PGT_ENTRY_AP_RW | PAS_ATTR(NONSECURE_PAS));
+    if (val_add_mmu_entries_el3(&map, 1))
+      return 1;
+    range_mapped = 1;
+  }
+
+  range.base = base;
+  range.size = size;
+  range.access = access;
+  range.smmu_mask = smmu_mask;
+  range.flags = flags;
+
+  UserCallSMC(ARM_ACS_SMC_FID, SMMU_CONFIG_SERVICE, SMMU_RLM_ADD_DPT_RANGE,
+             (uint64_t)&range, 0);
+  if (val_pe_get_index_mpid(val_pe_get_mpid()) != 0)
+      return shared_data->status_code ? 1 : 0;
+  if (shared_data->status_code != 0) {
+    val_print(ACS_PRINT_ERR, shared_data->error_msg, shared_data->error_code);
+    return 1;
+  }
+  else {
+    val_print(ACS_PRINT_INFO, " EL3: DPT range added successfully", 0);
+    return 0;
+  }
+}
+
 /**
  *  @brief  This API is used invalidate all cached DPT entries.
  *          Returns 1 on error, 0 on success.
@@ -681,6 +885,33 @@ val_cmo_to_poe(uint64_t PA)
   }
 }
 
+/**
+ *  @brief  This API cleans and invalidates a PA range to the PoPA or the PoE
+ *          in a single SMC. EL3 walks the range at the cache line size and
+ *          records the CNTPCT ticks it took in shared_data->cmo_ticks.
+ *          Returns 1 on error, 0 on success.
+ *  @param  PA      - Start of the range
+ *  @param  size    - Size of the range in bytes, 0 for a single line
+ *  @param  acc_pas - Access PAS of the operation
+ *  @param  op      - CMO_OP_POPA or CMO_OP_POE
+ *  @return 1 on error, 0 on success
+ */
+uint32_t
+val_cmo_range_el3(uint64_t PA, uint64_t size, uint64_t acc_pas, uint32_t op)
+{
+  UserCallSMC(ARM_ACS_SMC_FID, RME_CMO_RANGE, PA, size, CMO_RANGE_ARG(acc_pas, op));
+  if (val_pe_get_index_mpid(val_pe_get_mpid()) != 0)
+      return shared_data->status_code ? 1 : 0;
+  if (shared_data->status_code != 0) {
+    val_print(ACS_PRINT_ERR, shared_data->error_msg, 0);
+    return 1;
+  }
+  else {
+    val_print(ACS_PRINT_INFO, " EL3: CMO range done in %ld ticks", shared_data->cmo_ticks);
+    return 0;
+  }
+}
+
 /**
  *  @brief  This API is used to configure MECID for PE access.
  *          Returns 1 on error, 0 on success.
@@ -813,4 +1044,140 @@ val_smmu_read_cfg_el3(uint32_t smmu_idx, uint32_t reg_off, uint32_t bank)
     if (shared_data->status_code != 0) return 0ULL;
 
     return shared_data->shared_data_access[0].data;
-}
\ No newline at end of file
+}
+
+/**
+ *  @brief  This API reads the EL3 memory pool occupancy statistics.
+ *          Returns 1 on error, 0 on success.
+ *  @param  stats  Buffer filled with the per size class counters, mapped at EL3 by the caller
+ *  @return 1 on error, 0 on success
+ */
+uint32_t val_mem_pool_stats_el3(MEM_POOL_STATS *stats)
+{
+  UserCallSMC(ARM_ACS_SMC_FID, RME_MEM_POOL_STATS, (uint64_t)stats, 0, 0);
+  if (val_pe_get_index_mpid(val_pe_get_mpid()) != 0)
+      return shared_data->status_code ? 1 : 0;
+  if (shared_data->status_code != 0) {
+    val_print(ACS_PRINT_ERR, shared_data->error_msg, shared_data->error_code);
+    return 1;
+  }
+  return 0;
+}
+
+/**
+ *  @brief  This API prints the EL3 memory pool size classes that are in use,
+ *          so allocations leaked by tests show up at the end of a run.
+ *  @return None
+ */
+void val_mem_pool_print_stats_el3(void)
+{
+  static MEM_POOL_STATS stats;
+  static uint32_t stats_mapped;
+  MMU_MAP_DESC map;
+  uint32_t cls;
+
+  /* EL3 copies the counters through an NS mapping of the buffer */
+  if (!stats_mapped) {
+      map.va   = (uint64_t)&stats;
+      map.pa   = (uint64_t)&stats;
+      map.size = sizeof(stats);
+      map.attr = LOWER_ATTRS(PGT_ENTRY_ACCESS | SHAREABLE_ATTR(OUTER_SHAREABLE) |
+                             PGT_ENTRY_AP_RW | PAS_ATTR(NONSECURE_PAS));
+      if (val_add_mmu_entries_el3(&map, 1))
+          return;
+      stats_mapped = 1;
+  }
+
+  if (val_mem_pool_stats_el3(&stats))
+      return;
+
+  val_print(ACS_PRINT_DEBUG, "\n EL3 memory pool:", 0);
+  for (cls = 0; cls < MEM_POOL_NUM_CLASSES; cls++) {
+      if (!stats.cls[cls].allocs)
+          continue;
+      val_print(ACS_PRINT_DEBUG, "\n  Class %6lld B", stats.cls[cls].block_size);
+      val_print(ACS_PRINT_DEBUG, " in use %lld", stats.cls[cls].in_use);
+      val_print(ACS_PRINT_DEBUG, " peak %lld", stats.cls[cls].peak);
+      val_print(ACS_PRINT_DEBUG, " allocs %lld", stats.cls[cls].allocs);
+  }
+  val_print(ACS_PRINT_DEBUG, "\n  Large  in use %lld", stats.large_in_use);
+  val_print(ACS_PRINT_DEBUG, " allocs %lld\n", stats.large_allocs);
+}
+
+/* NS copy of the EL3 log ring, mapped at EL3 on first use */
+static EL3_LOG_RING g_el3_log;
+static uint32_t g_el3_log_mapped;
+static uint64_t g_el3_log_seen;
+
+/**
+ *  @brief  This API copies the EL3 log ring to an NS buffer.
+ *          Returns 1 on error, 0 on success.
+ *  @param  ring  Buffer filled with the ring, mapped at EL3 by the caller
+ *  @return 1 on error, 0 on success
+ */
+uint32_t val_read_log_el3(EL3_LOG_RING *ring)
+{
+  UserCallSMC(ARM_ACS_SMC_FID, RME_READ_EL3_LOG, (uint64_t)ring, 0, 0);
+  if (val_pe_get_index_mpid(val_pe_get_mpid()) != 0)
+      return shared_data->status_code ? 1 : 0;
+  if (shared_data->status_code != 0) {
+    val_print(ACS_PRINT_ERR, shared_data->error_msg, 0);
+    return 1;
+  }
+  return 0;
+}
+
+/**
+ *  @brief  This API prints the EL3 log events recorded since the previous call,
+ *          oldest first. Events the ring overwrote in between are only counted.
+ *  @param  level  Print level of the dump
+ *  @return None
+ */
+void val_print_log_el3(uint32_t level)
+{
+  MMU_MAP_DESC map;
+  EL3_LOG_EVENT *event;
+  uint64_t index;
+
+  if (!shared_data_base || val_pe_get_index_mpid(val_pe_get_mpid()) != 0)
+      return;
+
+  if (!g_el3_log_mapped) {
+      map.va   = (uint64_t)&g_el3_log;
+      map.pa   = (uint64_t)&g_el3_log;
+      map.size = sizeof(g_el3_log);
+      map.attr = LOWER_ATTRS(PGT_ENTRY_ACCESS | SHAREABLE_ATTR(OUTER_SHAREABLE) |
+                             PGT_ENTRY_AP_RW | PAS_ATTR(NONSECURE_PAS));
+      if (val_add_mmu_entries_el3(&map, 1))
+          return;
+      g_el3_log_mapped = 1;
+  }
+
+  if (val_read_log_el3(&g_el3_log))
+      return;
+
+  if (g_el3_log.head - g_el3_log_seen > EL3_LOG_NUM_EVENTS) {
+      val_print(level, "\n EL3 log: %lld events overwritten",
+                g_el3_log.head - g_el3_log_seen - EL3_LOG_NUM_EVENTS);
+      g_el3_log_seen = g_el3_log.head - EL3_LOG_NUM_EVENTS;
+  }
+
+  for (index = g_el3_log_seen; index < g_el3_log.head; index++) {
+      event = &g_el3_log.event[index % EL3_LOG_NUM_EVENTS];
+      val_print(level, "\n EL3 log %lld:", index);
+      val_print(level, " t 0x%llx", event->timestamp);
+      val_print(level, " PE 0x%llx", event->mpidr);
+      if (event->id == EL3_LOG_FAULT) {
+          val_print(level, " fault ESR 0x%llx", event->arg[0]);
+          val_print(level, " FAR 0x%llx", event->arg[1]);
+          val_print(level, " ELR 0x%llx", event->arg[2]);
+      } else {
+          val_print(level, " service 0x%llx", event->id);
+          val_print(level, " args 0x%llx", event->arg[0]);
+          val_print(level, " 0x%llx", event->arg[1]);
+          val_print(level, " 0x%llx", event->arg[2]);
+      }
+      val_print(level, " result 0x%llx", event->result);
+  }
+  g_el3_log_seen = g_el3_log.head;
+}
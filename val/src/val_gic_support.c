@@ -294,7 +294,7 @@ uint32_t get_its_index(uint32_t its_id)
 
 /**
   @brief   This function clear msi-x table in PCIe config space
-           1. Caller       -  val_gic_its_clear_lpi_map
+           1. Caller       -  val_gic_free_msi_range
            2. Prerequisite -  val_gic_its_configure
   @param   bdf BDF of the device
   @param   msi_index MSI Index in MSI-X table in Config space
@@ -341,7 +341,7 @@ void clear_msi_x_table(uint32_t bdf, uint32_t msi_index)
 
 /**
   @brief   This function fills msi-x table in PCIe config space
-           1. Caller       -  val_gic_its_create_lpi_map
+           1. Caller       -  val_gic_request_msi_range
            2. Prerequisite -  val_gic_its_configure
   @param   bdf BDF of the device
   @param   msi_index MSI Index in MSI-X table in Config space
@@ -396,18 +396,24 @@ uint32_t fill_msi_x_table(uint32_t bdf, uint32_t msi_index, uint64_t msi_addr, u
 }
 
 /**
-  @brief   This function clear the MSI related mappings.
+  @brief   This function clears the MSI related mappings of a contiguous range of
+           MSI-X vectors. The LPIs are discarded and the device unmapped in a single
+           ITS command batch.
 
-  @param   bdf          B:D:F for the device
-  @param   int_id       Interrupt ID
-  @param   msi_index    msi index in the table
+  @param   bdf            B:D:F for the device
+  @param   device_id      Device ID
+  @param   its_id         ITS ID
+  @param   base_int_id    Interrupt ID of the first vector
+  @param   base_msi_index First msi index in the table
+  @param   num_msis       Number of vectors
 
-  @return  status
+  @return  None
 **/
-void val_gic_free_msi(uint32_t bdf, uint32_t device_id, uint32_t its_id,
-                      uint32_t int_id, uint32_t msi_index)
+void val_gic_free_msi_range(uint32_t bdf, uint32_t device_id, uint32_t its_id,
+                            uint32_t base_int_id, uint32_t base_msi_index, uint32_t num_msis)
 {
   uint32_t its_index;
+  uint32_t i;
 
   its_index = get_its_index(its_id);
   if (its_index >= g_gic_its_info->GicNumIts)
@@ -421,28 +427,50 @@ void val_gic_free_msi(uint32_t bdf, uint32_t device_id, uint32_t its_id,
     val_print(ACS_PRINT_ERR, "GICD/GICRD Base Invalid value.", 0);
   }
 
-  val_gic_its_clear_lpi_map(its_index, device_id, int_id);
-  clear_msi_x_table(bdf, msi_index);
+  if (val_gic_its_clear_lpi_map_range(its_index, device_id, base_int_id, num_msis))
+    val_print(ACS_PRINT_ERR, " ITS unmap failed for device ID [%x]", device_id);
+
+  for (i = 0; i < num_msis; i++)
+    clear_msi_x_table(bdf, base_msi_index + i);
 }
 
 /**
-  @brief   This function creates the MSI mappings, and programs the MSI Table.
+  @brief   This function clear the MSI related mappings.
 
   @param   bdf          B:D:F for the device
-  @param   device_id    Device ID
-  @param   its_id       ITS ID
   @param   int_id       Interrupt ID
   @param   msi_index    msi index in the table
 
   @return  status
 **/
-uint32_t val_gic_request_msi(uint32_t bdf, uint32_t device_id, uint32_t its_id,
-                             uint32_t int_id, uint32_t msi_index)
+void val_gic_free_msi(uint32_t bdf, uint32_t device_id, uint32_t its_id,
+                      uint32_t int_id, uint32_t msi_index)
+{
+  val_gic_free_msi_range(bdf, device_id, its_id, int_id, msi_index, 1);
+}
+
+/**
+  @brief   This function creates the MSI mappings of a contiguous range of MSI-X
+           vectors and programs the MSI Table. Vector i raises LPI base_int_id + i,
+           all LPIs are mapped in a single ITS command batch.
+
+  @param   bdf            B:D:F for the device
+  @param   device_id      Device ID
+  @param   its_id         ITS ID
+  @param   base_int_id    Interrupt ID of the first vector
+  @param   base_msi_index First msi index in the table
+  @param   num_msis       Number of vectors
+
+  @return  status
+**/
+uint32_t val_gic_request_msi_range(uint32_t bdf, uint32_t device_id, uint32_t its_id,
+                                   uint32_t base_int_id, uint32_t base_msi_index,
+                                   uint32_t num_msis)
 {
-  uint32_t status;
+  uint32_t status = ACS_STATUS_PASS;
   uint64_t msi_addr;
-  uint32_t msi_data;
   uint32_t its_index;
+  uint32_t i;
 
    if ((g_gic_its_info == NULL) || (g_gic_its_info->GicNumIts == 0))
     return ACS_STATUS_ERR;
@@ -460,17 +488,37 @@ uint32_t val_gic_request_msi(uint32_t bdf, uint32_t device_id, uint32_t its_id,
     return ACS_STATUS_ERR;
   }
 
-  val_gic_its_create_lpi_map(its_index, device_id, int_id, LPI_PRIORITY1);
+  if (val_gic_its_create_lpi_map_range(its_index, device_id, base_int_id, num_msis,
+                                       LPI_PRIORITY1)) {
+    val_print(ACS_PRINT_ERR, " ITS map failed for device ID [%x]", device_id);
+    return ACS_STATUS_ERR;
+  }
 
   msi_addr = val_gic_its_get_translater_addr(its_index);
-  msi_data = int_id;
-
 
-  status = fill_msi_x_table(bdf, msi_index, msi_addr, msi_data);
+  for (i = 0; i < num_msis && status == ACS_STATUS_PASS; i++)
+    status = fill_msi_x_table(bdf, base_msi_index + i, msi_addr, base_int_id + i);
 
   return status;
 }
 
+/**
+  @brief   This function creates the MSI mappings, and programs the MSI Table.
+
+  @param   bdf          B:D:F for the device
+  @param   device_id    Device ID
+  @param   its_id       ITS ID
+  @param   int_id       Interrupt ID
+  @param   msi_index    msi index in the table
+
+  @return  status
+**/
+uint32_t val_gic_request_msi(uint32_t bdf, uint32_t device_id, uint32_t its_id,
+                             uint32_t int_id, uint32_t msi_index)
+{
+  return val_gic_request_msi_range(bdf, device_id, its_id, int_id, msi_index, 1);
+}
+
 /**
   @brief   This function gets the ITS Base for an ITS block with its_id
            1. Caller       -  Validation layer
@@ -90,6 +90,8 @@ val_rme_mec_execute_tests(uint32_t num_pe)
 
   reset_status = val_read_reset_status();
 
+  g_curr_module = 1 << MEC_MODULE_ID;
+
   if (reset_status != RESET_TST12_FLAG &&
       reset_status != RESET_TST31_FLAG &&
       reset_status != RESET_TST2_FLAG &&
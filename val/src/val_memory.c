@@ -26,18 +26,21 @@
 void *
 val_memory_alloc(uint32_t size)
 {
+  val_test_stats_count(VAL_STAT_ALLOC_BYTES, size);
   return pal_mem_alloc(size);
 }
 
 void *
 val_memory_calloc(uint32_t num, uint32_t size)
 {
+  val_test_stats_count(VAL_STAT_ALLOC_BYTES, (uint64_t)num * size);
   return pal_mem_calloc(num, size);
 }
 
 void *
 val_memory_alloc_cacheable(uint32_t bdf, uint32_t size, void **pa)
 {
+  val_test_stats_count(VAL_STAT_ALLOC_BYTES, size);
   return pal_mem_alloc_cacheable(bdf, size, pa);
 }
 
@@ -97,6 +100,7 @@ uint32_t val_memory_page_size(void)
 void *
 val_memory_alloc_pages(uint32_t num_pages)
 {
+    val_test_stats_count(VAL_STAT_ALLOC_BYTES, (uint64_t)num_pages * val_memory_page_size());
     return pal_mem_alloc_pages(num_pages);
 }
 
@@ -106,6 +110,47 @@ val_memory_free_pages(void *addr, uint32_t num_pages)
     pal_mem_free_pages(addr, num_pages);
 }
 
+/**
+  @brief  Allocates zeroed memory which survives the per-test arena rewind.
+          Use for state that is linked into global structures. Free with val_memory_free.
+
+  @param  num   - Number of elements
+          size  - Size of each element in bytes
+
+  @return Pointer to the allocated memory, NULL on failure
+**/
+void *
+val_memory_calloc_persistent(uint32_t num, uint32_t size)
+{
+  void *ptr;
+
+  val_test_stats_count(VAL_STAT_ALLOC_BYTES, (uint64_t)num * size);
+  ptr = pal_mem_alloc_persistent(num * size);
+  if (ptr != NULL)
+    pal_mem_set(ptr, num * size, 0);
+
+  return ptr;
+}
+
+/**
+  @brief  Opens the per-test heap arena. Memory allocated from here on is
+          reclaimed by val_memory_arena_rewind.
+**/
+void
+val_memory_arena_open(void)
+{
+  pal_mem_arena_open();
+}
+
+/**
+  @brief  Releases every allocation made since val_memory_arena_open.
+**/
+void
+val_memory_arena_rewind(void)
+{
+  pal_mem_arena_rewind();
+}
+
 /**
   @brief  Allocates memory with the given alignment.
 
@@ -117,6 +162,7 @@ val_memory_free_pages(void *addr, uint32_t num_pages)
 void
 *val_aligned_alloc(uint32_t alignment, uint32_t size)
 {
+  val_test_stats_count(VAL_STAT_ALLOC_BYTES, size);
   return pal_aligned_alloc(alignment, size);
 }
 
@@ -29,9 +29,293 @@ PCIE_INFO_TABLE *g_pcie_info_table;
 pcie_device_bdf_table *g_pcie_bdf_table;
 uint32_t pcie_bdf_table_list_flag;
 
+/* Per-segment Bus -> ECAM base map, built once by val_pcie_create_info_table */
+static addr_t *g_pcie_ecam_map[PCIE_MAX_SEGMENT];
+static uint64_t g_pcie_ecam_map_hits;
+static uint64_t g_pcie_ecam_map_misses;
+
+/* Read-only config space shadow, one entry per BDF table entry */
+static pcie_cfg_shadow *g_pcie_cfg_shadow;
+static uint32_t g_pcie_cfg_shadow_sorted;
+
 uint64_t
 pal_get_mcfg_ptr(void);
 
+/**
+  @brief   Builds the (segment, bus) -> ECAM base map from the PCIe info table, so that
+           config space accessors do not need to scan all ECAM blocks on every call.
+           1. Caller       -  val_pcie_create_info_table
+           2. Prerequisite -  g_pcie_info_table populated by PAL
+  @param   None
+
+  @return  None
+**/
+static void
+val_pcie_create_ecam_map(void)
+{
+  uint32_t num_ecam;
+  uint32_t ecam_index;
+  uint32_t seg_num;
+  uint32_t start_bus;
+  uint32_t end_bus;
+  uint32_t bus;
+
+  num_ecam = val_pcie_get_info(PCIE_INFO_NUM_ECAM, 0);
+
+  for (ecam_index = 0; ecam_index < num_ecam; ecam_index++)
+  {
+      seg_num = val_pcie_get_info(PCIE_INFO_SEGMENT, ecam_index);
+      start_bus = val_pcie_get_info(PCIE_INFO_START_BUS, ecam_index);
+      end_bus = val_pcie_get_info(PCIE_INFO_END_BUS, ecam_index);
+
+      if (seg_num >= PCIE_MAX_SEGMENT)
+          continue;
+
+      if (g_pcie_ecam_map[seg_num] == NULL) {
+          g_pcie_ecam_map[seg_num] = pal_mem_alloc(PCIE_MAX_BUS * sizeof(addr_t));
+          if (g_pcie_ecam_map[seg_num] == NULL) {
+              val_print(ACS_PRINT_WARN, " ECAM map allocation failed for segment %d", seg_num);
+              continue;
+          }
+          val_memory_set(g_pcie_ecam_map[seg_num], PCIE_MAX_BUS * sizeof(addr_t), 0);
+      }
+
+      /* First ECAM block claiming a bus wins, as in the linear scan */
+      for (bus = start_bus; (bus <= end_bus) && (bus < PCIE_MAX_BUS); bus++)
+      {
+          if (g_pcie_ecam_map[seg_num][bus] == 0)
+              g_pcie_ecam_map[seg_num][bus] = val_pcie_get_info(PCIE_INFO_ECAM, ecam_index);
+      }
+  }
+}
+
+/**
+  @brief   Returns the ECAM base of the block decoding the segment and bus of the bdf.
+           Uses the precomputed map when present and falls back to a linear scan of
+           the PCIe info table otherwise.
+  @param   bdf    - concatenated Bus(8-bits), device(8-bits) & function(8-bits)
+
+  @return  ECAM base address, 0 if no ECAM block decodes this bus
+**/
+static addr_t
+val_pcie_lookup_ecam_base(uint32_t bdf)
+{
+  uint32_t bus     = PCIE_EXTRACT_BDF_BUS(bdf);
+  uint32_t segment = PCIE_EXTRACT_BDF_SEG(bdf);
+  uint32_t num_ecam;
+  uint32_t i;
+
+  if ((segment < PCIE_MAX_SEGMENT) && (g_pcie_ecam_map[segment] != NULL)) {
+      g_pcie_ecam_map_hits++;
+      return g_pcie_ecam_map[segment][bus];
+  }
+
+  g_pcie_ecam_map_misses++;
+
+  num_ecam = val_pcie_get_info(PCIE_INFO_NUM_ECAM, 0);
+  for (i = 0; i < num_ecam; i++)
+  {
+      if ((bus >= val_pcie_get_info(PCIE_INFO_START_BUS, i)) &&
+           (bus <= val_pcie_get_info(PCIE_INFO_END_BUS, i)) &&
+           (segment == val_pcie_get_info(PCIE_INFO_SEGMENT, i)))
+          return val_pcie_get_info(PCIE_INFO_ECAM, i);
+  }
+
+  return 0;
+}
+
+/**
+  @brief   Returns the number of ECAM base lookups served by the precomputed map
+           (hits) and by the linear ECAM scan (misses) since the info table was created.
+  @param   hits   - Number of lookups served by the map
+  @param   misses - Number of lookups that fell back to the linear scan
+
+  @return  None
+**/
+void
+val_pcie_get_ecam_map_stats(uint64_t *hits, uint64_t *misses)
+{
+  if (hits)
+      *hits = g_pcie_ecam_map_hits;
+  if (misses)
+      *misses = g_pcie_ecam_map_misses;
+}
+
+/**
+  @brief   Populates the config space shadow of a function: Revision ID / Class Code,
+           Header Type and the capability ID to offset index of both capability lists.
+  @param   bdf    - concatenated Bus(8-bits), device(8-bits) & function(8-bits)
+  @param   shadow - Shadow entry to be populated
+
+  @return  None
+**/
+static void
+val_pcie_fill_cfg_shadow(uint32_t bdf, pcie_cfg_shadow *shadow)
+{
+  uint32_t reg_value;
+  uint32_t next_cap_offset;
+
+  val_memory_set(shadow, sizeof(pcie_cfg_shadow), 0);
+
+  val_pcie_read_cfg(bdf, TYPE01_RIDR, &shadow->ridr);
+
+  val_pcie_read_cfg(bdf, TYPE01_CLSR, &reg_value);
+  shadow->hdr_type = (reg_value >> TYPE01_HTR_SHIFT) & TYPE01_HTR_MASK;
+
+  /* Index the PCI capability list */
+  val_pcie_read_cfg(bdf, TYPE01_CPR, &reg_value);
+  next_cap_offset = (reg_value & TYPE01_CPR_MASK);
+  if (reg_value == PCIE_UNKNOWN_RESPONSE)
+      next_cap_offset = 0;
+
+  while (next_cap_offset && (shadow->num_cap < PCIE_SHADOW_MAX_CAP))
+  {
+      val_pcie_read_cfg(bdf, next_cap_offset, &reg_value);
+      shadow->cap[shadow->num_cap].id = reg_value & PCIE_CIDR_MASK;
+      shadow->cap[shadow->num_cap++].offset = next_cap_offset;
+      next_cap_offset = ((reg_value >> PCIE_NCPR_SHIFT) & PCIE_NCPR_MASK);
+  }
+  shadow->cap_overflow = (next_cap_offset != 0);
+
+  /* Index the PCIe extended capability list */
+  next_cap_offset = PCIE_ECAP_START;
+  while (next_cap_offset && (shadow->num_ecap < PCIE_SHADOW_MAX_ECAP))
+  {
+      val_pcie_read_cfg(bdf, next_cap_offset, &reg_value);
+      if ((reg_value == 0) || (reg_value == PCIE_UNKNOWN_RESPONSE)) {
+          next_cap_offset = 0;
+          break;
+      }
+
+      shadow->ecap[shadow->num_ecap].id = reg_value & PCIE_ECAP_CIDR_MASK;
+      shadow->ecap[shadow->num_ecap++].offset = next_cap_offset;
+      next_cap_offset = ((reg_value >> PCIE_ECAP_NCPR_SHIFT) & PCIE_ECAP_NCPR_MASK);
+  }
+  shadow->ecap_overflow = (next_cap_offset != 0);
+
+  shadow->valid = 1;
+}
+
+/**
+  @brief   Returns the config space shadow of a function in the BDF table, populating
+           it on first use or after an invalidation.
+  @param   bdf    - concatenated Bus(8-bits), device(8-bits) & function(8-bits)
+
+  @return  Shadow entry, NULL if the function is not part of the BDF table
+**/
+static pcie_cfg_shadow *
+val_pcie_get_cfg_shadow(uint32_t bdf)
+{
+  uint32_t low;
+  uint32_t high;
+  uint32_t mid;
+  uint32_t entry_bdf;
+
+  if ((g_pcie_cfg_shadow == NULL) || (g_pcie_bdf_table == NULL))
+      return NULL;
+
+  low = 0;
+  high = g_pcie_bdf_table->num_entries;
+
+  if (g_pcie_cfg_shadow_sorted) {
+      /* Binary search over the ascending BDF table */
+      while (low < high)
+      {
+          mid = low + (high - low) / 2;
+          entry_bdf = g_pcie_bdf_table->device[mid].bdf;
+          if (entry_bdf == bdf) {
+              low = mid;
+              break;
+          }
+
+          if (entry_bdf < bdf)
+              low = mid + 1;
+          else
+              high = mid;
+      }
+  } else {
+      while ((low < high) && (g_pcie_bdf_table->device[low].bdf != bdf))
+          low++;
+  }
+
+  if ((low >= g_pcie_bdf_table->num_entries) || (g_pcie_bdf_table->device[low].bdf != bdf))
+      return NULL;
+
+  if (!g_pcie_cfg_shadow[low].valid)
+      val_pcie_fill_cfg_shadow(bdf, &g_pcie_cfg_shadow[low]);
+
+  return &g_pcie_cfg_shadow[low];
+}
+
+/**
+  @brief   Allocates and populates the config space shadow for every BDF table entry.
+           1. Caller       -  val_pcie_create_device_bdf_table
+  @param   None
+
+  @return  None
+**/
+static void
+val_pcie_create_cfg_shadow(void)
+{
+  uint32_t tbl_index;
+
+  if (g_pcie_bdf_table->num_entries == 0)
+      return;
+
+  g_pcie_cfg_shadow = pal_mem_alloc(g_pcie_bdf_table->num_entries * sizeof(pcie_cfg_shadow));
+  if (g_pcie_cfg_shadow == NULL) {
+      val_print(ACS_PRINT_WARN, " PCIe config shadow allocation failed", 0);
+      return;
+  }
+
+  g_pcie_cfg_shadow_sorted = 1;
+  for (tbl_index = 1; tbl_index < g_pcie_bdf_table->num_entries; tbl_index++)
+  {
+      if (g_pcie_bdf_table->device[tbl_index].bdf <= g_pcie_bdf_table->device[tbl_index - 1].bdf)
+          g_pcie_cfg_shadow_sorted = 0;
+  }
+
+  for (tbl_index = 0; tbl_index < g_pcie_bdf_table->num_entries; tbl_index++)
+      val_pcie_fill_cfg_shadow(g_pcie_bdf_table->device[tbl_index].bdf,
+                               &g_pcie_cfg_shadow[tbl_index]);
+}
+
+/**
+  @brief   Invalidates the config space shadow of a function. Must be called by tests
+           that change config space fields held in the shadow, the shadow is then
+           re-read from config space on next use.
+  @param   bdf    - concatenated Bus(8-bits), device(8-bits) & function(8-bits)
+
+  @return  None
+**/
+void
+val_pcie_invalidate_cfg_shadow(uint32_t bdf)
+{
+  pcie_cfg_shadow *shadow;
+
+  shadow = val_pcie_get_cfg_shadow(bdf);
+  if (shadow)
+      shadow->valid = 0;
+}
+
+/**
+  @brief   Invalidates the config space shadow of every function in the BDF table.
+  @param   None
+
+  @return  None
+**/
+void
+val_pcie_invalidate_all_cfg_shadow(void)
+{
+  uint32_t tbl_index;
+
+  if ((g_pcie_cfg_shadow == NULL) || (g_pcie_bdf_table == NULL))
+      return;
+
+  for (tbl_index = 0; tbl_index < g_pcie_bdf_table->num_entries; tbl_index++)
+      g_pcie_cfg_shadow[tbl_index].valid = 0;
+}
+
 /**
   @brief   This API reads 32-bit data from PCIe config space pointed by Bus,
            Device, Function and register offset.
@@ -49,10 +333,8 @@ val_pcie_read_cfg(uint32_t bdf, uint32_t offset, uint32_t *data)
   uint32_t bus     = PCIE_EXTRACT_BDF_BUS(bdf);
   uint32_t dev     = PCIE_EXTRACT_BDF_DEV(bdf);
   uint32_t func    = PCIE_EXTRACT_BDF_FUNC(bdf);
-  uint32_t segment = PCIE_EXTRACT_BDF_SEG(bdf);
   uint32_t cfg_addr;
   addr_t   ecam_base = 0;
-  uint32_t i = 0;
 
 
   if ((bus >= PCIE_MAX_BUS) || (dev >= PCIE_MAX_DEV) || (func >= PCIE_MAX_FUNC)) {
@@ -65,17 +347,7 @@ val_pcie_read_cfg(uint32_t bdf, uint32_t offset, uint32_t *data)
       return PCIE_NO_MAPPING;
   }
 
-  while (i < val_pcie_get_info(PCIE_INFO_NUM_ECAM, 0))
-  {
-
-      if ((bus >= val_pcie_get_info(PCIE_INFO_START_BUS, i)) &&
-           (bus <= val_pcie_get_info(PCIE_INFO_END_BUS, i)) &&
-           (segment == val_pcie_get_info(PCIE_INFO_SEGMENT, i))) {
-          ecam_base = val_pcie_get_info(PCIE_INFO_ECAM, i);
-          break;
-      }
-      i++;
-  }
+  ecam_base = val_pcie_lookup_ecam_base(bdf);
 
   if (ecam_base == 0) {
       val_print(ACS_PRINT_ERR, " Read PCIe_CFG: ECAM Base is zero for bdf %x", bdf);
@@ -87,6 +359,7 @@ val_pcie_read_cfg(uint32_t bdf, uint32_t offset, uint32_t *data)
                (dev * PCIE_MAX_FUNC * 4096) + (func * 4096);
 
   *data = pal_mmio_read(ecam_base + cfg_addr + offset);
+  val_test_stats_count(VAL_STAT_PCIE_CFG_READ, 1);
   return 0;
 
 }
@@ -125,10 +398,8 @@ val_pcie_write_cfg(uint32_t bdf, uint32_t offset, uint32_t data)
   uint32_t bus      = PCIE_EXTRACT_BDF_BUS(bdf);
   uint32_t dev      = PCIE_EXTRACT_BDF_DEV(bdf);
   uint32_t func     = PCIE_EXTRACT_BDF_FUNC(bdf);
-  uint32_t segment  = PCIE_EXTRACT_BDF_SEG(bdf);
   uint32_t cfg_addr;
   addr_t   ecam_base = 0;
-  uint32_t i = 0;
 
 
   if ((bus >= PCIE_MAX_BUS) || (dev >= PCIE_MAX_DEV) || (func >= PCIE_MAX_FUNC)) {
@@ -141,17 +412,7 @@ val_pcie_write_cfg(uint32_t bdf, uint32_t offset, uint32_t data)
       return;
   }
 
-  while (i < val_pcie_get_info(PCIE_INFO_NUM_ECAM, 0))
-  {
-
-      if ((bus >= val_pcie_get_info(PCIE_INFO_START_BUS, i)) &&
-           (bus <= val_pcie_get_info(PCIE_INFO_END_BUS, i)) &&
-           (segment == val_pcie_get_info(PCIE_INFO_SEGMENT, i))) {
-          ecam_base = val_pcie_get_info(PCIE_INFO_ECAM, i);
-          break;
-      }
-      i++;
-  }
+  ecam_base = val_pcie_lookup_ecam_base(bdf);
 
   if (ecam_base == 0) {
       val_print(ACS_PRINT_ERR, " Read PCIe_CFG: ECAM Base is zero ", 0);
@@ -163,6 +424,12 @@ val_pcie_write_cfg(uint32_t bdf, uint32_t offset, uint32_t data)
                (dev * PCIE_MAX_FUNC * 4096) + (func * 4096);
 
   pal_mmio_write(ecam_base + cfg_addr + offset, data);
+  val_test_stats_count(VAL_STAT_PCIE_CFG_WRITE, 1);
+
+  /* Bus number changes on a bridge alter the rootport of every function below it */
+  if ((g_pcie_cfg_shadow != NULL) && ((offset & ~WORD_ALIGN_MASK) == TYPE1_PBN) &&
+      (val_pcie_function_header_type(bdf) == TYPE1_HEADER))
+      val_pcie_invalidate_all_cfg_shadow();
 }
 
 /**
@@ -225,11 +492,8 @@ uint64_t val_pcie_get_bdf_config_addr(uint32_t bdf)
   uint32_t bus      = PCIE_EXTRACT_BDF_BUS(bdf);
   uint32_t dev      = PCIE_EXTRACT_BDF_DEV(bdf);
   uint32_t func     = PCIE_EXTRACT_BDF_FUNC(bdf);
-  uint32_t segment  = PCIE_EXTRACT_BDF_SEG(bdf);
   uint32_t cfg_addr;
-  uint32_t num_ecam;
   addr_t   ecam_base = 0;
-  uint32_t i = 0;
 
   if ((bus >= PCIE_MAX_BUS) || (dev >= PCIE_MAX_DEV) || (func >= PCIE_MAX_FUNC)) {
      val_print(ACS_PRINT_ERR, " Invalid Bus/Dev/Func  %x ", bdf);
@@ -241,18 +505,7 @@ uint64_t val_pcie_get_bdf_config_addr(uint32_t bdf)
       return 0;
   }
 
-  num_ecam = val_pcie_get_info(PCIE_INFO_NUM_ECAM, 0);
-  while (i < num_ecam)
-  {
-
-      if ((bus >= val_pcie_get_info(PCIE_INFO_START_BUS, i)) &&
-           (bus <= val_pcie_get_info(PCIE_INFO_END_BUS, i)) &&
-           (segment == val_pcie_get_info(PCIE_INFO_SEGMENT, i))) {
-          ecam_base = val_pcie_get_info(PCIE_INFO_ECAM, i);
-          break;
-      }
-      i++;
-  }
+  ecam_base = val_pcie_lookup_ecam_base(bdf);
 
   if (ecam_base == 0) {
       val_print(ACS_PRINT_ERR, " Read PCIe_CFG: ECAM Base is zero ", 0);
@@ -438,6 +691,9 @@ val_pcie_create_info_table(uint64_t *pcie_info_table)
         " PCIE_INFO: Number of ECAM regions    :    %lx",
         val_pcie_get_info(PCIE_INFO_NUM_ECAM, 0));
 
+  /* Precompute the (segment, bus) -> ECAM base map used by the config accessors */
+  val_pcie_create_ecam_map();
+
   val_pcie_enumerate();
 
   /* Create the list of valid Pcie Device Functions */
@@ -454,6 +710,10 @@ val_pcie_create_info_table(uint64_t *pcie_info_table)
 
   val_pcie_print_device_info();
 
+  val_print(ACS_PRINT_DEBUG, "\n PCIE_INFO: ECAM map lookups          : %ld",
+            g_pcie_ecam_map_hits);
+  val_print(ACS_PRINT_DEBUG, "\n PCIE_INFO: ECAM linear scan lookups  : %ld",
+            g_pcie_ecam_map_misses);
 }
 
 /**
@@ -486,6 +746,177 @@ static uint32_t val_pcie_populate_device_rootport(void)
   return 0;
 }
 
+/**
+  @brief  Probes a single function and stores its BDF in the BDF table if it is a
+          valid PCIe function.
+  @param  bdf        - Segment/Bus/Dev/Func in PCIE_CREATE_BDF format
+  @param  reg_value  - Vendor/Device ID register value read from the function
+
+  @return PCIE_NO_MAPPING if there is a bdf mapping issue, else PCIE_SUCCESS
+**/
+static uint32_t
+val_pcie_probe_function(uint32_t bdf, uint32_t *reg_value)
+{
+  uint32_t cid_offset;
+  uint32_t status;
+
+  /* Probe pcie device Function with this bdf */
+  if (val_pcie_read_cfg(bdf, TYPE01_VIDR, reg_value) == PCIE_NO_MAPPING)
+  {
+      /* Return if there is a bdf mapping issue */
+      val_print(ACS_PRINT_ERR, " BDF 0x%x mapping issue", bdf);
+      return PCIE_NO_MAPPING;
+  }
+
+  /* Store the Function's BDF only if there was a valid response */
+  if (*reg_value == PCIE_UNKNOWN_RESPONSE)
+      return PCIE_SUCCESS;
+
+  /* Skip if the device is a host bridge */
+  if (val_pcie_is_host_bridge(bdf))
+      return PCIE_SUCCESS;
+
+  /* Skip if the device is a PCI legacy device */
+  if (val_pcie_find_capability(bdf, PCIE_CAP, CID_PCIECS,  &cid_offset) != PCIE_SUCCESS)
+      return PCIE_SUCCESS;
+
+  status = pal_pcie_check_device_valid(bdf);
+  if (status)
+      return PCIE_SUCCESS;
+
+  /* Enable memory access and bus master enable for all BDF's
+   * For BM systems, these bits are enabled during enumeration in PAL
+   * For linux, the driver takes care.
+  */
+  val_pcie_enable_bme(bdf);
+  val_pcie_enable_msa(bdf);
+
+  g_pcie_bdf_table->device[g_pcie_bdf_table->num_entries++].bdf = bdf;
+
+  return PCIE_SUCCESS;
+}
+
+/**
+  @brief  Probes every function of every device on every bus of an ECAM region.
+          Used when the exhaustive scan is requested through g_pcie_full_scan.
+  @param  seg_num    - Segment number of the ECAM region
+  @param  start_bus  - First bus decoded by the ECAM region
+  @param  end_bus    - Last bus decoded by the ECAM region
+
+  @return 0 on success, 1 if there is a bdf mapping issue
+**/
+static uint32_t
+val_pcie_scan_ecam_exhaustive(uint32_t seg_num, uint32_t start_bus, uint32_t end_bus)
+{
+  uint32_t bus_index;
+  uint32_t dev_index;
+  uint32_t func_index;
+  uint32_t bdf;
+  uint32_t reg_value;
+
+  /* Iterate over all buses, devices and functions in this ecam */
+  for (bus_index = start_bus; bus_index <= end_bus; bus_index++)
+  {
+      for (dev_index = 0; dev_index < PCIE_MAX_DEV; dev_index++)
+      {
+          for (func_index = 0; func_index < PCIE_MAX_FUNC; func_index++)
+          {
+              /* Form bdf using seg, bus, device, function numbers */
+              bdf = PCIE_CREATE_BDF(seg_num, bus_index, dev_index, func_index);
+
+              if (val_pcie_probe_function(bdf, &reg_value) == PCIE_NO_MAPPING)
+                  return 1;
+          }
+      }
+  }
+
+  return 0;
+}
+
+/**
+  @brief  Discovers the functions of an ECAM region by following the PCIe topology.
+          Only the start bus and the secondary buses claimed by Type 1 bridges are
+          scanned, function 0 of each device is probed first and functions 1-7 are
+          probed only for multi-function devices. Buses are visited in ascending
+          order, so the BDF table is filled in the same order as the exhaustive scan.
+  @param  seg_num    - Segment number of the ECAM region
+  @param  start_bus  - First bus decoded by the ECAM region
+  @param  end_bus    - Last bus decoded by the ECAM region
+
+  @return 0 on success, 1 if there is a bdf mapping issue
+**/
+static uint32_t
+val_pcie_scan_ecam_topology(uint32_t seg_num, uint32_t start_bus, uint32_t end_bus)
+{
+  uint8_t  bus_pending[PCIE_MAX_BUS];
+  uint32_t bus_index;
+  uint32_t dev_index;
+  uint32_t func_index;
+  uint32_t num_func;
+  uint32_t bdf;
+  uint32_t reg_value;
+  uint32_t hdr_type;
+  uint32_t sec_bus;
+  uint32_t sub_bus;
+  uint32_t num_bus_scanned = 0;
+
+  if (end_bus >= PCIE_MAX_BUS)
+      end_bus = PCIE_MAX_BUS - 1;
+
+  val_memory_set(bus_pending, sizeof(bus_pending), 0);
+  bus_pending[start_bus] = 1;
+
+  for (bus_index = start_bus; bus_index <= end_bus; bus_index++)
+  {
+      if (!bus_pending[bus_index])
+          continue;
+
+      num_bus_scanned++;
+
+      for (dev_index = 0; dev_index < PCIE_MAX_DEV; dev_index++)
+      {
+          num_func = 1;
+
+          for (func_index = 0; func_index < num_func; func_index++)
+          {
+              bdf = PCIE_CREATE_BDF(seg_num, bus_index, dev_index, func_index);
+
+              if (val_pcie_probe_function(bdf, &reg_value) == PCIE_NO_MAPPING)
+                  return 1;
+
+              if (reg_value == PCIE_UNKNOWN_RESPONSE)
+                  continue;
+
+              val_pcie_read_cfg(bdf, TYPE01_CLSR, &hdr_type);
+              hdr_type = (hdr_type >> TYPE01_HTR_SHIFT) & TYPE01_HTR_MASK;
+
+              /* Probe the remaining functions only for multi-function devices */
+              if ((func_index == 0) && ((hdr_type >> HTR_MFD_SHIFT) & HTR_MFD_MASK))
+                  num_func = PCIE_MAX_FUNC;
+
+              if (((hdr_type >> HTR_HL_SHIFT) & HTR_HL_MASK) != TYPE1_HEADER)
+                  continue;
+
+              /* Descend only into the bus range claimed by this bridge */
+              val_pcie_read_cfg(bdf, TYPE1_PBN, &reg_value);
+              sec_bus = (reg_value >> SECBN_SHIFT) & SECBN_MASK;
+              sub_bus = (reg_value >> SUBBN_SHIFT) & SUBBN_MASK;
+
+              if ((sec_bus <= bus_index) || (sec_bus > end_bus) || (sub_bus < sec_bus)) {
+                  val_print(ACS_PRINT_DEBUG, " Bridge 0x%x secondary bus not scanned", bdf);
+                  continue;
+              }
+
+              bus_pending[sec_bus] = 1;
+          }
+      }
+  }
+
+  val_print(ACS_PRINT_DEBUG, " PCIE_INFO: Buses scanned in segment  : %d", num_bus_scanned);
+
+  return 0;
+}
+
 uint32_t
 val_pcie_create_device_bdf_table()
 {
@@ -494,13 +925,7 @@ val_pcie_create_device_bdf_table()
   uint32_t seg_num;
   uint32_t start_bus;
   uint32_t end_bus;
-  uint32_t bus_index;
-  uint32_t dev_index;
-  uint32_t func_index;
   uint32_t ecam_index;
-  uint32_t bdf;
-  uint32_t reg_value;
-  uint32_t cid_offset;
   uint32_t status;
 
   /* if table is already present, return success */
@@ -524,6 +949,9 @@ val_pcie_create_device_bdf_table()
       return 1;
   }
 
+  if (g_pcie_full_scan)
+      val_print(ACS_PRINT_DEBUG, " PCIE_INFO: Using exhaustive BDF scan", 0);
+
   for (ecam_index = 0; ecam_index < num_ecam; ecam_index++)
   {
       /* Derive ecam specific information */
@@ -531,53 +959,18 @@ val_pcie_create_device_bdf_table()
       start_bus = val_pcie_get_info(PCIE_INFO_START_BUS, ecam_index);
       end_bus = val_pcie_get_info(PCIE_INFO_END_BUS, ecam_index);
 
-      /* Iterate over all buses, devices and functions in this ecam */
-      for (bus_index = start_bus; bus_index <= end_bus; bus_index++)
-      {
-          for (dev_index = 0; dev_index < PCIE_MAX_DEV; dev_index++)
-          {
-              for (func_index = 0; func_index < PCIE_MAX_FUNC; func_index++)
-              {
-                  /* Form bdf using seg, bus, device, function numbers */
-                  bdf = PCIE_CREATE_BDF(seg_num, bus_index, dev_index, func_index);
-
-                  /* Probe pcie device Function with this bdf */
-                  if (val_pcie_read_cfg(bdf, TYPE01_VIDR, &reg_value) == PCIE_NO_MAPPING)
-                  {
-                      /* Return if there is a bdf mapping issue */
-                      val_print(ACS_PRINT_ERR, " BDF 0x%x mapping issue", bdf);
-                      return 1;
-                  }
-
-                  /* Store the Function's BDF if there was a valid response */
-                  if (reg_value != PCIE_UNKNOWN_RESPONSE)
-                  {
-                      /* Skip if the device is a host bridge */
-                      if (val_pcie_is_host_bridge(bdf))
-                          continue;
-
-                      /* Skip if the device is a PCI legacy device */
-                      if (val_pcie_find_capability(bdf, PCIE_CAP, CID_PCIECS,  &cid_offset) != PCIE_SUCCESS)
-                          continue;
-
-                      status = pal_pcie_check_device_valid(bdf);
-                      if (status)
-                          continue;
-
-                      /* Enable memory access and bus master enable for all BDF's
-                       * For BM systems, these bits are enabled during enumeration in PAL
-                       * For linux, the driver takes care.
-                      */
-                      val_pcie_enable_bme(bdf);
-                      val_pcie_enable_msa(bdf);
-
-                      g_pcie_bdf_table->device[g_pcie_bdf_table->num_entries++].bdf = bdf;
-                  }
-              }
-          }
-      }
+      if (g_pcie_full_scan)
+          status = val_pcie_scan_ecam_exhaustive(seg_num, start_bus, end_bus);
+      else
+          status = val_pcie_scan_ecam_topology(seg_num, start_bus, end_bus);
+
+      if (status)
+          return 1;
   }
 
+  /* Index the read-only config space of every function found */
+  val_pcie_create_cfg_shadow();
+
   /* Sanity Check : Confirm all EP (normal, integrated) have a rootport */
   val_pcie_populate_device_rootport();
 
@@ -650,6 +1043,21 @@ val_pcie_bdf_table_ptr()
 void
 val_pcie_free_info_table()
 {
+  uint32_t seg_num;
+
+  for (seg_num = 0; seg_num < PCIE_MAX_SEGMENT; seg_num++)
+  {
+      if (g_pcie_ecam_map[seg_num] != NULL) {
+          pal_mem_free((void *)g_pcie_ecam_map[seg_num]);
+          g_pcie_ecam_map[seg_num] = NULL;
+      }
+  }
+
+  if (g_pcie_cfg_shadow != NULL) {
+      pal_mem_free((void *)g_pcie_cfg_shadow);
+      g_pcie_cfg_shadow = NULL;
+  }
+
   pal_mem_free((void *)g_pcie_info_table);
 }
 
@@ -879,9 +1287,15 @@ uint32_t
 val_pcie_multifunction_support(uint32_t bdf)
 {
   uint32_t reg_data;
+  pcie_cfg_shadow *shadow;
 
-  val_pcie_read_cfg(bdf, TYPE01_CLSR, &reg_data);
-  reg_data = ((reg_data >> TYPE01_HTR_SHIFT) & TYPE01_HTR_MASK);
+  shadow = val_pcie_get_cfg_shadow(bdf);
+  if (shadow) {
+      reg_data = shadow->hdr_type;
+  } else {
+      val_pcie_read_cfg(bdf, TYPE01_CLSR, &reg_data);
+      reg_data = ((reg_data >> TYPE01_HTR_SHIFT) & TYPE01_HTR_MASK);
+  }
 
   return !((reg_data >> HTR_MFD_SHIFT) & HTR_MFD_MASK);
 }
@@ -1095,6 +1509,11 @@ val_pcie_device_port_type(uint32_t bdf)
   uint32_t pciecs_base;
   uint32_t reg_value;
   uint32_t dp_type;
+  pcie_cfg_shadow *shadow;
+
+  shadow = val_pcie_get_cfg_shadow(bdf);
+  if (shadow && shadow->dp_type)
+      return shadow->dp_type;
 
   /* Get the PCI Express Capability structure offset and
    * use that offset to read pci express capabilities register
@@ -1116,6 +1535,9 @@ val_pcie_device_port_type(uint32_t bdf)
           dp_type = iEP_RP;
   }
 
+  if (shadow)
+      shadow->dp_type = dp_type;
+
   /* Return device/port type */
   return dp_type;
 }
@@ -1137,6 +1559,34 @@ val_pcie_find_capability(uint32_t bdf, uint32_t cid_type, uint32_t cid, uint32_t
   uint32_t reg_value;
   uint32_t next_cap_offset;
   uint32_t ret;
+  uint32_t index;
+  pcie_cfg_shadow *shadow;
+
+  /* Look up the capability index of the function when it is part of the BDF table */
+  shadow = val_pcie_get_cfg_shadow(bdf);
+  if (shadow && (cid_type == PCIE_CAP)) {
+      for (index = 0; index < shadow->num_cap; index++)
+      {
+          if (shadow->cap[index].id == cid) {
+              *cid_offset = shadow->cap[index].offset;
+              return PCIE_SUCCESS;
+          }
+      }
+
+      if (!shadow->cap_overflow)
+          return PCIE_CAP_NOT_FOUND;
+  } else if (shadow && (cid_type == PCIE_ECAP)) {
+      for (index = 0; index < shadow->num_ecap; index++)
+      {
+          if (shadow->ecap[index].id == cid) {
+              *cid_offset = shadow->ecap[index].offset;
+              return PCIE_SUCCESS;
+          }
+      }
+
+      if (!shadow->ecap_overflow)
+          return PCIE_CAP_NOT_FOUND;
+  }
 
   if (cid_type == PCIE_CAP) {
 
@@ -1755,12 +2205,18 @@ val_pcie_function_header_type(uint32_t bdf)
 {
 
   uint32_t reg_value;
+  pcie_cfg_shadow *shadow;
 
-  /* Read four bytes of config space starting from cache line size register */
-  val_pcie_read_cfg(bdf, TYPE01_CLSR, &reg_value);
+  shadow = val_pcie_get_cfg_shadow(bdf);
+  if (shadow) {
+      reg_value = shadow->hdr_type;
+  } else {
+      /* Read four bytes of config space starting from cache line size register */
+      val_pcie_read_cfg(bdf, TYPE01_CLSR, &reg_value);
 
-  /* Extract header type register value */
-  reg_value = ((reg_value >> TYPE01_HTR_SHIFT) & TYPE01_HTR_MASK);
+      /* Extract header type register value */
+      reg_value = ((reg_value >> TYPE01_HTR_SHIFT) & TYPE01_HTR_MASK);
+  }
 
   /* Header layout bits within header type register indicate the header type */
   return ((reg_value >> HTR_HL_SHIFT) & HTR_HL_MASK);
@@ -1927,14 +2383,14 @@ val_pcie_get_downstream_function(uint32_t bdf, uint32_t *dsf_bdf)
 }
 
 /**
-  @brief  Returns BDF of the upstream Root Port of a pcie device function.
+  @brief  Searches the BDF table for the upstream Root Port of a pcie device function.
 
   @param  bdf       - Function's Segment/Bus/Dev/Func in PCIE_CREATE_BDF format
   @param  usrp_bdf  - Upstream Rootport bdf in PCIE_CREATE_BDF format
   @return 0 for success, 1 for failure.
 **/
-uint32_t
-val_pcie_get_rootport(uint32_t bdf, uint32_t *rp_bdf)
+static uint32_t
+val_pcie_search_rootport(uint32_t bdf, uint32_t *rp_bdf)
 {
 
   uint32_t index;
@@ -1973,14 +2429,16 @@ val_pcie_get_rootport(uint32_t bdf, uint32_t *rp_bdf)
        * upstream Root port and check if the input function's
        * bus number falls within that range.
        */
+      dp_type = val_pcie_device_port_type(*rp_bdf);
+      if ((dp_type != RP) && (dp_type != iEP_RP))
+          continue;
+
       val_pcie_read_cfg(*rp_bdf, TYPE1_PBN, &reg_value);
       seg_num = PCIE_EXTRACT_BDF_SEG(*rp_bdf);
       sec_bus = ((reg_value >> SECBN_SHIFT) & SECBN_MASK);
       sub_bus = ((reg_value >> SUBBN_SHIFT) & SUBBN_MASK);
-      dp_type = val_pcie_device_port_type(*rp_bdf);
 
-      if (((dp_type == RP) || (dp_type == iEP_RP)) &&
-          (sec_bus <= PCIE_EXTRACT_BDF_BUS(bdf)) &&
+      if ((sec_bus <= PCIE_EXTRACT_BDF_BUS(bdf)) &&
           (sub_bus >= PCIE_EXTRACT_BDF_BUS(bdf)) &&
           (seg_num == PCIE_EXTRACT_BDF_SEG(bdf)))
           return 0;
@@ -1993,6 +2451,37 @@ val_pcie_get_rootport(uint32_t bdf, uint32_t *rp_bdf)
 
 }
 
+/**
+  @brief  Returns BDF of the upstream Root Port of a pcie device function.
+          The result is kept in the config space shadow of the function.
+
+  @param  bdf       - Function's Segment/Bus/Dev/Func in PCIE_CREATE_BDF format
+  @param  usrp_bdf  - Upstream Rootport bdf in PCIE_CREATE_BDF format
+  @return 0 for success, 1 for failure.
+**/
+uint32_t
+val_pcie_get_rootport(uint32_t bdf, uint32_t *rp_bdf)
+{
+  uint32_t status;
+  pcie_cfg_shadow *shadow;
+
+  shadow = val_pcie_get_cfg_shadow(bdf);
+  if (shadow && shadow->rp_valid) {
+      *rp_bdf = shadow->rp_bdf;
+      return shadow->rp_status;
+  }
+
+  status = val_pcie_search_rootport(bdf, rp_bdf);
+
+  if (shadow) {
+      shadow->rp_bdf = *rp_bdf;
+      shadow->rp_status = status;
+      shadow->rp_valid = 1;
+  }
+
+  return status;
+}
+
 uint8_t
 val_pcie_parent_is_rootport(uint32_t dsf_bdf, uint32_t *rp_bdf)
 {
@@ -2040,8 +2529,14 @@ uint8_t
 val_pcie_is_host_bridge(uint32_t bdf)
 {
   uint32_t  reg_value;
+  pcie_cfg_shadow *shadow;
+
+  shadow = val_pcie_get_cfg_shadow(bdf);
+  if (shadow)
+      reg_value = shadow->ridr;
+  else
+      val_pcie_read_cfg(bdf, TYPE01_RIDR, &reg_value);
 
-  val_pcie_read_cfg(bdf, TYPE01_RIDR, &reg_value);
   if ((HB_BASE_CLASS == ((reg_value >> CC_BASE_SHIFT) & CC_BASE_MASK)) &&
       (HB_SUB_CLASS == ((reg_value >> CC_SUB_SHIFT) & CC_SUB_MASK)))
     return 1;
@@ -2216,6 +2711,27 @@ val_pcie_find_da_capability(uint32_t bdf, uint32_t *cid_offset)
 
   uint32_t reg_value;
   uint32_t next_cap_offset;
+  uint32_t index;
+  pcie_cfg_shadow *shadow;
+
+  /* Only the DVSEC entries of the extended capability index need to be read */
+  shadow = val_pcie_get_cfg_shadow(bdf);
+  if (shadow) {
+      for (index = 0; index < shadow->num_ecap; index++)
+      {
+          if (shadow->ecap[index].id != ECID_DVSEC)
+              continue;
+
+          val_pcie_read_cfg(bdf, shadow->ecap[index].offset + RMEDA_HEAD2, &reg_value);
+          if ((reg_value & RMEDA_HEAD2_DVSEC_ID_MASK) == RMEDA_HEAD2_DVSEC_ID) {
+              *cid_offset = shadow->ecap[index].offset;
+              return PCIE_SUCCESS;
+          }
+      }
+
+      if (!shadow->ecap_overflow)
+          return PCIE_CAP_NOT_FOUND;
+  }
 
   /* Serach in PCIe extended configuration space */
   next_cap_offset = PCIE_ECAP_START;
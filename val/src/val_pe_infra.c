@@ -180,9 +180,70 @@ val_pe_get_index_mpid(uint64_t mpid)
 }
 
 
+/**
+  @brief   Return the mailbox slot of a PE in the shared memory.
+           1. Caller       -  VAL
+           2. Prerequisite -  val_allocate_shared_mem
+  @param   index - PE index
+  @return  Pointer to the shared memory entry of the PE
+**/
+static volatile VAL_SHARED_MEM_t *
+val_pe_mailbox(uint32_t index)
+{
+  volatile VAL_SHARED_MEM_t *mem;
+
+  mem = (VAL_SHARED_MEM_t *)pal_mem_get_shared_addr();
+  return mem + index;
+}
+
+/**
+  @brief   Park a resident worker PE in WFE and run every payload posted to its
+           mailbox, until the mailbox asks it to power off.
+           1. Caller       -  val_test_entry
+           2. Prerequisite -  PE woken with the resident flag set
+  @param   index - Index of the calling PE
+  @return  None
+**/
+static void
+val_pe_resident_park(uint32_t index)
+{
+  volatile VAL_SHARED_MEM_t *mem = val_pe_mailbox(index);
+  uint64_t test_arg;
+  void (*vector)(uint64_t args);
+
+  mem->mailbox = VAL_PE_MBOX_PARKED;
+  val_data_cache_ops_by_va((addr_t)&mem->mailbox, CLEAN_AND_INVALIDATE);
+
+  while (1) {
+      val_data_cache_ops_by_va((addr_t)&mem->mailbox, INVALIDATE);
+      if (mem->mailbox == VAL_PE_MBOX_EXIT)
+          break;
+
+      if (mem->mailbox != VAL_PE_MBOX_RUN) {
+          ArmCallWFE();
+          continue;
+      }
+
+      mem->mailbox = VAL_PE_MBOX_BUSY;
+      val_data_cache_ops_by_va((addr_t)&mem->mailbox, CLEAN_AND_INVALIDATE);
+
+      val_get_test_data(index, (uint64_t *)&vector, &test_arg);
+      vector(test_arg);
+      val_log_flush();
+
+      mem->mailbox = VAL_PE_MBOX_PARKED;
+      val_data_cache_ops_by_va((addr_t)&mem->mailbox, CLEAN_AND_INVALIDATE);
+  }
+
+  mem->mailbox = VAL_PE_MBOX_OFF;
+  val_data_cache_ops_by_va((addr_t)&mem->mailbox, CLEAN_AND_INVALIDATE);
+  ArmCallSEV();
+}
+
 /**
   @brief   'C' Entry point for Secondary PE.
-           Uses PSCI_CPU_OFF to switch off PE after payload execution.
+           Uses PSCI_CPU_OFF to switch off PE after payload execution, unless the
+           PE was woken as a resident worker, in which case it parks first.
            1. Caller       -  PAL code
            2. Prerequisite -  Stack pointer for this PE is setup by PAL
   @param   None
@@ -194,9 +255,16 @@ val_test_entry(void)
   uint64_t test_arg;
   ARM_SMC_ARGS smc_args;
   void (*vector)(uint64_t args);
+  uint32_t index = val_pe_get_index_mpid(val_pe_get_mpid());
+  volatile VAL_SHARED_MEM_t *mem = val_pe_mailbox(index);
 
-  val_get_test_data(val_pe_get_index_mpid(val_pe_get_mpid()), (uint64_t *)&vector, &test_arg);
+  val_get_test_data(index, (uint64_t *)&vector, &test_arg);
   vector(test_arg);
+  val_log_flush();
+
+  val_data_cache_ops_by_va((addr_t)&mem->mailbox, INVALIDATE);
+  if (mem->resident)
+      val_pe_resident_park(index);
 
   // We have completed our TEST code. So, switch off the PE now
   smc_args.Arg0 = ARM_SMC_ID_PSCI_CPU_OFF;
@@ -204,6 +272,54 @@ val_test_entry(void)
   pal_pe_call_smc(&smc_args, gPsciConduit);
 }
 
+/**
+  @brief   Wait until a resident worker PE is parked in its mailbox loop.
+           1. Caller       -  VAL
+           2. Prerequisite -  val_allocate_shared_mem
+  @param   mem - Shared memory entry of the PE
+  @return  1 if the PE is parked, 0 if it did not park within TIMEOUT_LARGE
+**/
+static uint32_t
+val_pe_resident_wait_parked(volatile VAL_SHARED_MEM_t *mem)
+{
+  uint64_t deadline = val_deadline_start(TIMEOUT_LARGE);
+
+  do {
+      val_data_cache_ops_by_va((addr_t)&mem->mailbox, INVALIDATE);
+      if (mem->mailbox == VAL_PE_MBOX_PARKED)
+          return 1;
+  } while (!val_deadline_expired(deadline));
+
+  return 0;
+}
+
+/**
+  @brief   Post a payload to a resident worker PE, once it has parked after
+           its previous payload.
+           1. Caller       -  VAL
+           2. Prerequisite -  PE woken with the resident flag set
+  @param   index - Index of the PE
+  @param   payload - Function pointer of the test to be executed on the PE
+  @param   test_input - arguments to be passed to the test.
+  @return  1 if the payload was posted, 0 if the PE did not park in time
+**/
+static uint32_t
+val_pe_resident_post(uint32_t index, void (*payload)(void), uint64_t test_input)
+{
+  volatile VAL_SHARED_MEM_t *mem = val_pe_mailbox(index);
+
+  if (!val_pe_resident_wait_parked(mem))
+      return 0;
+
+  val_set_test_data(index, (uint64_t)payload, test_input);
+
+  mem->mailbox = VAL_PE_MBOX_RUN;
+  val_data_cache_ops_by_va((addr_t)&mem->mailbox, CLEAN_AND_INVALIDATE);
+  ArmCallSEV();
+
+  return 1;
+}
+
 void
 val_system_reset()
 {
@@ -216,18 +332,22 @@ val_system_reset()
 /**
   @brief   This API initiates the execution of a test on a secondary PE.
            Uses PSCI_CPU_ON to wake a secondary PE
-           1. Caller       -  Test Suite
+           1. Caller       -  VAL
            2. Prerequisite -  val_create_peinfo_table
   @param   index - Index of the PE to be woken up
   @param   payload - Function pointer of the test to be executed on the PE
   @param   test_input - arguments to be passed to the test.
+  @param   smc_args - PSCI argument block used for the CPU_ON call
+  @param   resident - park the PE after the payload instead of powering it off
   @return  None
 **/
-void
-val_execute_on_pe(uint32_t index, void (*payload)(void), uint64_t test_input)
+static void
+val_pe_cpu_on(uint32_t index, void (*payload)(void), uint64_t test_input,
+              ARM_SMC_ARGS *smc_args, uint32_t resident)
 {
 
-  int timeout = TIMEOUT_LARGE;
+  uint64_t deadline;
+  volatile VAL_SHARED_MEM_t *mem;
 
   if (index > g_pe_info_table->header.num_of_pe) {
       val_print(ACS_PRINT_ERR, "Input Index exceeds Num of PE %x ", index);
@@ -235,29 +355,173 @@ val_execute_on_pe(uint32_t index, void (*payload)(void), uint64_t test_input)
       return;
   }
 
+  mem = val_pe_mailbox(index);
+  val_data_cache_ops_by_va((addr_t)&mem->mailbox, INVALIDATE);
+
+  /* A resident worker never powers off between payloads, so it is never sent CPU_ON */
+  if (mem->resident) {
+      if (val_pe_resident_post(index, payload, test_input))
+          return;
+      val_print(ACS_PRINT_ERR, " Resident PE index = %d did not park", index);
+      val_set_status(index, "FAIL", 0x120);
+      return;
+  }
+
+  mem->resident = resident;
+  val_data_cache_ops_by_va((addr_t)&mem->mailbox, CLEAN_AND_INVALIDATE);
+
+  /* A PE still powering down from the previous payload reports ALREADY_ON */
+  deadline = val_deadline_start(TIMEOUT_LARGE);
   do {
-      g_smc_args.Arg0 = ARM_SMC_ID_PSCI_CPU_ON_AARCH64;
+      smc_args->Arg0 = ARM_SMC_ID_PSCI_CPU_ON_AARCH64;
 
       /* Set the TEST function pointer in a shared memory location. This location is
          read by the Secondary PE (val_test_entry()) and executes the test. */
-      g_smc_args.Arg1 = val_pe_get_mpid_index(index);
+      smc_args->Arg1 = val_pe_get_mpid_index(index);
 
       val_set_test_data(index, (uint64_t)payload, test_input);
-      pal_pe_execute_payload(&g_smc_args);
+      val_test_stats_count(VAL_STAT_PSCI_WAKE, 1);
+      pal_pe_execute_payload(smc_args);
 
-  } while (g_smc_args.Arg0 == (uint64_t)ARM_SMC_PSCI_RET_ALREADY_ON && timeout--);
+  } while (smc_args->Arg0 == (uint64_t)ARM_SMC_PSCI_RET_ALREADY_ON &&
+           !val_deadline_expired(deadline));
 
-  if (g_smc_args.Arg0 == (uint64_t)ARM_SMC_PSCI_RET_ALREADY_ON)
+  if (smc_args->Arg0 == (uint64_t)ARM_SMC_PSCI_RET_ALREADY_ON)
       val_print(ACS_PRINT_ERR, " PSCI_CPU_ON: cpu already on  ", 0);
   else {
-      if (g_smc_args.Arg0 == 0) {
+      if (smc_args->Arg0 == 0) {
           val_print(ACS_PRINT_INFO, " PSCI_CPU_ON: success  ", 0);
           return;
       } else
           val_print(ACS_PRINT_ERR, " PSCI_CPU_ON: failure  ", 0);
 
   }
-  val_set_status(index, "FAIL", (0x120 - (int)g_smc_args.Arg0));
+  val_set_status(index, "FAIL", (0x120 - (int)smc_args->Arg0));
+}
+
+/**
+  @brief   This API initiates the execution of a test on a secondary PE.
+           1. Caller       -  Test Suite
+           2. Prerequisite -  val_create_peinfo_table
+  @param   index - Index of the PE to be woken up
+  @param   payload - Function pointer of the test to be executed on the PE
+  @param   test_input - arguments to be passed to the test.
+  @return  None
+**/
+void
+val_execute_on_pe(uint32_t index, void (*payload)(void), uint64_t test_input)
+{
+  val_pe_cpu_on(index, payload, test_input, &g_smc_args, g_pe_resident);
+}
+
+/**
+  @brief   This API initiates the execution of a test on a secondary PE through
+           a real PSCI CPU_ON, for tests that need power-up and CPU_OFF
+           semantics. A parked resident worker is powered off first.
+           1. Caller       -  Test Suite
+           2. Prerequisite -  val_create_peinfo_table
+  @param   index - Index of the PE to be woken up
+  @param   payload - Function pointer of the test to be executed on the PE
+  @param   test_input - arguments to be passed to the test.
+  @return  None
+**/
+void
+val_execute_on_pe_cold(uint32_t index, void (*payload)(void), uint64_t test_input)
+{
+  val_pe_resident_release(index);
+  val_pe_cpu_on(index, payload, test_input, &g_smc_args, 0);
+}
+
+/**
+  @brief   This API asks a parked resident worker PE to power off and waits
+           until it has left its park loop.
+           1. Caller       -  Test Suite, Application layer
+           2. Prerequisite -  val_allocate_shared_mem
+  @param   index - Index of the PE
+  @return  None
+**/
+void
+val_pe_resident_release(uint32_t index)
+{
+  volatile VAL_SHARED_MEM_t *mem = val_pe_mailbox(index);
+  uint64_t deadline;
+
+  val_data_cache_ops_by_va((addr_t)&mem->mailbox, INVALIDATE);
+  if (!mem->resident)
+      return;
+
+  /* A worker still running a payload is released once it parks */
+  if (!val_pe_resident_wait_parked(mem)) {
+      val_print(ACS_PRINT_WARN, " Resident PE index = %d did not park", index);
+      return;
+  }
+
+  mem->mailbox = VAL_PE_MBOX_EXIT;
+  val_data_cache_ops_by_va((addr_t)&mem->mailbox, CLEAN_AND_INVALIDATE);
+  ArmCallSEV();
+
+  deadline = val_deadline_start(TIMEOUT_LARGE);
+  while (!val_deadline_expired(deadline)) {
+      val_data_cache_ops_by_va((addr_t)&mem->mailbox, INVALIDATE);
+      if (mem->mailbox == VAL_PE_MBOX_OFF) {
+          /* Powered off, the next payload wakes it with CPU_ON */
+          mem->resident = 0;
+          val_data_cache_ops_by_va((addr_t)&mem->mailbox, CLEAN_AND_INVALIDATE);
+          return;
+      }
+  }
+
+  val_print(ACS_PRINT_WARN, " Resident PE index = %d did not power off", index);
+}
+
+/**
+  @brief   This API powers off every parked resident worker PE.
+           1. Caller       -  Application layer
+           2. Prerequisite -  val_allocate_shared_mem
+  @param   None
+  @return  None
+**/
+void
+val_pe_resident_release_all(void)
+{
+  uint32_t my_index = val_pe_get_index_mpid(val_pe_get_mpid());
+  uint32_t i;
+
+  for (i = 0; i < val_pe_get_num(); i++) {
+      if (i != my_index)
+          val_pe_resident_release(i);
+  }
+}
+
+/**
+  @brief   This API wakes a PE the same way as val_execute_on_pe, but keeps the
+           PSCI arguments on the caller's stack so that several PEs can wake
+           their own children concurrently during a fan-out.
+           1. Caller       -  VAL
+           2. Prerequisite -  val_create_peinfo_table
+  @param   index - Index of the PE to be woken up
+  @param   payload - Function pointer of the test to be executed on the PE
+  @param   test_input - arguments to be passed to the test.
+  @return  None
+**/
+void
+val_pe_fanout_wake(uint32_t index, void (*payload)(void), uint64_t test_input)
+{
+  ARM_SMC_ARGS smc_args;
+  volatile VAL_SHARED_MEM_t *mem;
+  uint32_t my_index = val_pe_get_index_mpid(val_pe_get_mpid());
+  uint32_t resident;
+
+  /* The primary PE owns the resident mode, children inherit the mode this PE was woken with */
+  if (my_index == 0) {
+      resident = g_pe_resident;
+  } else {
+      mem = val_pe_mailbox(my_index);
+      val_data_cache_ops_by_va((addr_t)&mem->mailbox, INVALIDATE);
+      resident = mem->resident;
+  }
+
+  val_pe_cpu_on(index, payload, test_input, &smc_args, resident);
 }
 
 /**
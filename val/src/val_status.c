@@ -19,6 +19,30 @@
 #include "include/val_common.h"
 #include "include/val_cfg.h"
 #include "include/val_pe.h"
+#include "include/val_memory.h"
+#include "include/val_timer_support.h"
+
+#define VAL_MAX_TEST_STATS  128
+#define VAL_SLOWEST_TESTS   10
+
+/* Run time and resource usage of one test, from val_initialize_test to END */
+typedef struct {
+  char8_t  *name;
+  uint32_t module;
+  uint64_t ticks;
+  uint64_t count[VAL_STAT_MAX];
+} VAL_TEST_STAT;
+
+static VAL_TEST_STAT g_test_stats[VAL_MAX_TEST_STATS];
+static uint32_t g_num_test_stats;
+static VAL_TEST_STAT *g_test_stat_cur;
+static uint64_t g_test_stat_start;
+
+/* Indexed by MODULE_ID_e */
+static char8_t *g_test_stat_module[] = {
+  RME_MODULE, GIC_MODULE, SMMU_MODULE, DA_MODULE,
+  DPT_MODULE, MEC_MODULE, LEGACY_MODULE, TIMER_MODULE
+};
 
 /**
   @brief  Print the appropriate information to console based on string state
@@ -52,6 +76,8 @@ val_report_status(uint32_t index, char8_t *state)
     if (val_memory_compare("FAIL", state, sizeof("FAIL")) == 0) {
         val_print(ACS_PRINT_ALWAYS, " Checkpoint -- %2d", (uint64_t)pe_mem->checkpoint);
         val_print(ACS_PRINT_ALWAYS, "\nResult: FAIL \n", 0);
+        /* EL3 services and faults seen by the failing test */
+        val_print_log_el3(ACS_PRINT_ERR);
     }
     else
       if (val_memory_compare("SKIP", state, sizeof("SKIP")) == 0) {
@@ -62,6 +88,12 @@ val_report_status(uint32_t index, char8_t *state)
         if (val_memory_compare("END", state, sizeof("END")) == 0) {
           g_print_in_test_context = 0;
           g_print_test_check_id = 0;
+          val_test_stats_close();
+          /* Consumes the EL3 events of a passing test, shown at debug verbosity */
+          val_print_log_el3(ACS_PRINT_DEBUG);
+          /* Reclaim everything the test allocated in one step */
+          val_memory_arena_rewind();
+          val_release_test_windows();
           val_print(ACS_PRINT_ALWAYS,
             "\n*******************************************************\n", 0);
         }
@@ -69,8 +101,10 @@ val_report_status(uint32_t index, char8_t *state)
             val_print(ACS_PRINT_ALWAYS, "\nResult=", 0);
             val_print(ACS_PRINT_ALWAYS, state, 0);
             val_print(ACS_PRINT_ALWAYS, " \n", 0);
-            return;
         }
+
+  /* Test boundary, emit the prints recorded while the test ran */
+  val_log_flush();
 }
 
 /**
@@ -87,6 +121,10 @@ val_set_status(uint32_t index, char8_t *state, uint32_t checkpoint)
 {
   volatile VAL_SHARED_MEM_t *mem;
 
+  /* A secondary PE emits its prints before the primary PE sees its status */
+  if (val_pe_get_index_mpid(val_pe_get_mpid()) != 0)
+    val_log_flush();
+
   mem = (VAL_SHARED_MEM_t *) pal_mem_get_shared_addr();
   mem = mem + index;
 
@@ -97,6 +135,16 @@ val_set_status(uint32_t index, char8_t *state, uint32_t checkpoint)
 
   val_pe_cache_invalidate_range((addr_t)mem->state, sizeof(mem->state));
   val_data_cache_ops_by_va((addr_t)&mem->checkpoint, CLEAN_AND_INVALIDATE);
+
+  /* Publish the numeric status last and wake the primary PE waiting in WFE */
+  if (val_memory_compare("PENDING", state, sizeof("PENDING")) == 0)
+    mem->status = VAL_PE_STATUS_PENDING;
+  else
+    mem->status = VAL_PE_STATUS_DONE;
+  val_data_cache_ops_by_va((addr_t)&mem->status, CLEAN_AND_INVALIDATE);
+
+  if (mem->status == VAL_PE_STATUS_DONE)
+    ArmCallSEV();
 }
 
 /**
@@ -118,3 +166,135 @@ val_get_status(uint32_t index)
 
   return (char8_t *)(mem->state);
 }
+
+/**
+  @brief  Start the accounting record of a test and sample CNTPCT.
+          1. Caller       - val_initialize_test
+          2. Prerequisite - None
+  @param  testname - name of the test, must outlive the run
+  @return none
+**/
+void
+val_test_stats_open(char8_t *testname)
+{
+  /* Tests beyond the table still run, they are just not accounted */
+  if (g_num_test_stats >= VAL_MAX_TEST_STATS) {
+      g_test_stat_cur = NULL;
+      return;
+  }
+
+  g_test_stat_cur = &g_test_stats[g_num_test_stats++];
+  val_memory_set(g_test_stat_cur, sizeof(VAL_TEST_STAT), 0);
+  g_test_stat_cur->name   = testname;
+  g_test_stat_cur->module = g_curr_module;
+
+  g_test_stat_start = ArmReadCntPct();
+}
+
+/**
+  @brief  Close the accounting record of the running test.
+          1. Caller       - val_report_status on END
+          2. Prerequisite - None
+  @return none
+**/
+void
+val_test_stats_close(void)
+{
+  if (g_test_stat_cur == NULL)
+      return;
+
+  g_test_stat_cur->ticks = ArmReadCntPct() - g_test_stat_start;
+  g_test_stat_cur = NULL;
+}
+
+/**
+  @brief  Charge a resource to the running test. Outside a test this is a no-op.
+          Updates from secondary PEs are not serialised, so the counts of
+          multi-PE payloads are approximate.
+          1. Caller       - VAL
+          2. Prerequisite - None
+  @param  type  - VAL_STAT_e counter
+  @param  value - amount to add
+  @return none
+**/
+void
+val_test_stats_count(uint32_t type, uint64_t value)
+{
+  if ((g_test_stat_cur != NULL) && (type < VAL_STAT_MAX))
+      g_test_stat_cur->count[type] += value;
+}
+
+static void
+val_test_stats_print(char8_t *name, VAL_TEST_STAT *stat, uint64_t freq)
+{
+  val_print(ACS_PRINT_ALWAYS, "\n  ", 0);
+  val_print(ACS_PRINT_ALWAYS, name, 0);
+  val_print(ACS_PRINT_ALWAYS, "\n     Time(ms) = %ld;", (stat->ticks * 1000) / freq);
+  val_print(ACS_PRINT_ALWAYS, " SMC = %ld;", stat->count[VAL_STAT_SMC]);
+  val_print(ACS_PRINT_ALWAYS, " CFG RD = %ld;", stat->count[VAL_STAT_PCIE_CFG_READ]);
+  val_print(ACS_PRINT_ALWAYS, " CFG WR = %ld;", stat->count[VAL_STAT_PCIE_CFG_WRITE]);
+  val_print(ACS_PRINT_ALWAYS, " MMIO = %ld;", stat->count[VAL_STAT_MMIO]);
+  val_print(ACS_PRINT_ALWAYS, " PSCI = %ld;", stat->count[VAL_STAT_PSCI_WAKE]);
+  val_print(ACS_PRINT_ALWAYS, " Alloc = 0x%lx", stat->count[VAL_STAT_ALLOC_BYTES]);
+}
+
+/**
+  @brief  Print the slowest tests and the per-module totals of the run.
+          1. Caller       - Application layer, after all modules have run
+          2. Prerequisite - None
+  @return none
+**/
+void
+val_test_stats_report(void)
+{
+  uint8_t  order[VAL_MAX_TEST_STATS];
+  uint32_t i, j, m, tests;
+  uint64_t freq;
+  VAL_TEST_STAT total;
+
+  val_test_stats_close();
+
+  if (g_num_test_stats == 0)
+      return;
+
+  freq = ArmReadCntFrq();
+  if (freq == 0)
+      freq = 1000000;
+
+  /* Insertion sort of record indices, slowest first */
+  for (i = 0; i < g_num_test_stats; i++) {
+      j = i;
+      while ((j > 0) && (g_test_stats[order[j - 1]].ticks < g_test_stats[i].ticks)) {
+          order[j] = order[j - 1];
+          j--;
+      }
+      order[j] = i;
+  }
+
+  val_print(ACS_PRINT_ALWAYS, "\n Slowest tests:", 0);
+  for (i = 0; (i < g_num_test_stats) && (i < VAL_SLOWEST_TESTS); i++)
+      val_test_stats_print(g_test_stats[order[i]].name, &g_test_stats[order[i]], freq);
+
+  val_print(ACS_PRINT_ALWAYS, "\n\n Module totals:", 0);
+  for (m = 0; m < sizeof(g_test_stat_module) / sizeof(g_test_stat_module[0]); m++) {
+      val_memory_set(&total, sizeof(total), 0);
+      tests = 0;
+
+      for (i = 0; i < g_num_test_stats; i++) {
+          if (g_test_stats[i].module != (1u << m))
+              continue;
+
+          tests++;
+          total.ticks += g_test_stats[i].ticks;
+          for (j = 0; j < VAL_STAT_MAX; j++)
+              total.count[j] += g_test_stats[i].count[j];
+      }
+
+      if (tests == 0)
+          continue;
+
+      val_test_stats_print(g_test_stat_module[m], &total, freq);
+      val_print(ACS_PRINT_ALWAYS, "; Tests = %d", tests);
+  }
+  val_print(ACS_PRINT_ALWAYS, "\n", 0);
+}
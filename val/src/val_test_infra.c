@@ -25,16 +25,275 @@
 #include "include/val_exerciser.h"
 #include "include/val_smmu.h"
 #include "include/val_pgt.h"
+#include "include/val_timer_support.h"
+#include "include/val_memory.h"
 
 uint64_t free_mem_var_pa;
 uint64_t free_mem_var_va;
 uint64_t rme_nvm_mem;
 
-struct_sh_data *shared_data;
+uint64_t shared_data_base;
+
+/* PA/VA windows handed out by val_get_free_pa and val_get_free_va */
+#define FREE_WINDOW_MAX 64
+
+typedef struct {
+  uint64_t base;
+  uint64_t size;
+  uint32_t in_test;       /* Released automatically at the END of the test */
+} FREE_WINDOW;
+
+typedef struct {
+  uint64_t *cursor;       /* Lowest never used address of the window */
+  uint32_t is_pa;
+  uint32_t num_live;
+  uint32_t num_avail;
+  FREE_WINDOW live[FREE_WINDOW_MAX];
+  FREE_WINDOW avail[FREE_WINDOW_MAX]; /* Released ranges, address ordered */
+} FREE_WINDOW_POOL;
+
+static FREE_WINDOW_POOL g_free_pa_pool = { .cursor = &free_mem_var_pa, .is_pa = 1 };
+static FREE_WINDOW_POOL g_free_va_pool = { .cursor = &free_mem_var_va, .is_pa = 0 };
+static uint32_t g_free_window_in_test;
+
+/* Released windows whose EL3 MMU/GPT entries are still to be torn down */
+static MMU_MAP_DESC g_window_release[MAX_MMU_MAP_DESC];
+static uint32_t g_window_release_num;
+
+/* Per-PE print ring, see val_log_ring_init() */
+#define VAL_LOG_RING_ENTRIES 64
+#define VAL_LOG_TEXT_LEN     120
+
+typedef struct {
+  uint32_t level;
+  uint32_t line;
+  uint32_t in_test;       /* g_print_in_test_context when the print was recorded */
+  uint32_t check_id;      /* Check number assigned when the print was recorded */
+  uint64_t data;
+  const char *file;
+  char8_t text[VAL_LOG_TEXT_LEN]; /* Format string, then the %a/%s argument if any */
+} VAL_LOG_ENTRY;
+
+/* A ring is written and drained only by the PE that owns it */
+typedef struct {
+  volatile uint32_t head;
+  volatile uint32_t tail;
+  VAL_LOG_ENTRY entry[VAL_LOG_RING_ENTRIES];
+} VAL_LOG_RING;
+
+static VAL_LOG_RING *g_log_ring;
+static uint32_t g_log_ring_num_pe;
+
+/**
+  @brief  Format one print record to the console or log file in the ACS text format.
+
+  @param level     The print verbosity
+  @param string    Formatted ASCII string
+  @param data      64-bit data
+  @param file      File name from which the print was invoked
+  @param line      Line number from which the print was invoked
+  @param in_test   Whether the print was issued inside a test
+  @param check_id  Check number for ACS_PRINT_TEST prints
+
+  @return        None
+ **/
+static void val_log_emit(uint32_t level, char8_t *string, uint64_t data, const char *file,
+                         int line, uint32_t in_test, uint32_t check_id)
+{
+#ifndef TARGET_BM_BOOT
+  if (level == ACS_PRINT_DEBUG)
+  {
+    if (in_test)
+      pal_print("\n\t\tDBG : ", 0);
+    else
+      pal_print("\n\tDBG : ", 0);
+  } else if (level == ACS_PRINT_ERR)
+  {
+    if (in_test)
+      pal_print("\n\t\tERR : ", 0);
+    else
+      pal_print("\n\tERR : ", 0);
+  } else if (level == ACS_PRINT_INFO)
+  {
+    if (in_test)
+      pal_print("\n\t\tINFO: ", 0);
+    else
+      pal_print("\n\tINFO: ", 0);
+  } else if (level == ACS_PRINT_WARN)
+  {
+    if (in_test)
+      pal_print("\n\t\tWARN: ", 0);
+    else
+      pal_print("\n\tWARN: ", 0);
+  } else if (level == ACS_PRINT_ALWAYS)
+  {
+    // Do not print prefix or newline
+    pal_print(string, data);
+    return;
+  } else
+  {
+    if (check_id == 1)
+      pal_print("  Check %d : ", check_id);
+    else
+      pal_print("\n  Check %d : ", check_id);
+  }
+  pal_print(string, data);
+  /* Print file name and line number for ERR and WARN */
+  if (level == ACS_PRINT_ERR || level == ACS_PRINT_WARN)
+  {
+    pal_print("[FILE: %a]", (uint64_t)file);
+    pal_print("  [LINE: %d]", line);
+  }
+#else
+  if (level == ACS_PRINT_DEBUG)
+  {
+    if (in_test)
+      pal_uart_print(level, "\n\t\tDBG: ", 0);
+    else
+      pal_uart_print(level, "\n\tDBG: ", 0);
+  } else if (level == ACS_PRINT_ERR)
+  {
+    if (in_test)
+      pal_uart_print(level, "\n\t\tERR: ", 0);
+    else
+      pal_uart_print(level, "\n\tERR: ", 0);
+  } else if (level == ACS_PRINT_INFO)
+  {
+    if (in_test)
+      pal_uart_print(level, "\n\t\tINFO: ", 0);
+    else
+      pal_uart_print(level, "\n\tINFO", 0);
+  } else if (level == ACS_PRINT_WARN)
+  {
+    if (in_test)
+      pal_uart_print(level, "\n\t\tWARN: ", 0);
+    else
+      pal_uart_print(level, "\n\tWARN: ", 0);
+  } else if (level == ACS_PRINT_ALWAYS)
+  {
+    // Do not print prefix or newline
+    pal_uart_print(level, string, data);
+    return;
+  } else
+  {
+    pal_uart_print(level, "\n  Check %d : ", check_id);
+  }
+  pal_uart_print(level, string, data);
+  /* Print file name and line number for ERR and WARN */
+  if (level == ACS_PRINT_ERR || level == ACS_PRINT_WARN)
+  {
+    pal_uart_print(level, "  [FILE: %a]", (uint64_t)file);
+    pal_uart_print(level, "  [LINE: %d]", line);
+  }
+#endif
+}
+
+
+/**
+  @brief  Return the length of a string argument consumed by the format string,
+          so that it can be copied into the ring with the format.
+
+  @param string  Formatted ASCII string
+  @param data    64-bit data passed with the string
+
+  @return  Length of the %a/%s argument including the terminator, 0 if none
+ **/
+static uint32_t val_log_string_arg_len(char8_t *string, uint64_t data)
+{
+  uint32_t i = 0, len = 0;
+
+  while (string[i] != '\0') {
+    if (string[i++] != '%')
+      continue;
+    while (string[i] == 'l' || (string[i] >= '0' && string[i] <= '9') || string[i] == '-')
+      i++;
+    if ((string[i] == 'a' || string[i] == 's') && data) {
+      while (((char8_t *)data)[len] != '\0')
+        len++;
+      return len + 1;
+    }
+  }
+  return 0;
+}
+
+/**
+  @brief  Drain the print ring of the calling PE in recording order.
+
+  @param index  PE index owning the ring, the calling PE
+
+  @return  None
+ **/
+static void val_log_drain(uint32_t index)
+{
+  VAL_LOG_RING *ring = &g_log_ring[index];
+  VAL_LOG_ENTRY *entry;
+  uint32_t tail = ring->tail;
+  uint32_t head = ring->head;
+  uint64_t data;
+
+  while (tail != head) {
+    entry = &ring->entry[tail % VAL_LOG_RING_ENTRIES];
+    data = entry->data;
+    /* A string argument was copied right after the format string */
+    if (entry->text[VAL_LOG_TEXT_LEN - 1] != '\0')
+      data = (uint64_t)&entry->text[(uint8_t)entry->text[VAL_LOG_TEXT_LEN - 1]];
+    val_log_emit(entry->level, entry->text, data, entry->file, entry->line,
+                 entry->in_test, entry->check_id);
+    tail++;
+  }
+  ring->tail = tail;
+}
+
+/**
+  @brief  Record a print in the ring of the calling PE. The format string (and a
+          %a/%s argument) is copied so that stack buffers stay valid until the drain.
+
+  @return  0 if recorded, 1 if the print has to be emitted directly
+ **/
+static uint32_t val_log_record(uint32_t level, char8_t *string, uint64_t data, const char *file,
+                               int line, uint32_t in_test, uint32_t check_id)
+{
+  uint32_t index = val_pe_get_index_mpid(val_pe_get_mpid());
+  uint32_t len = 0, arg_len, head;
+  VAL_LOG_RING *ring;
+  VAL_LOG_ENTRY *entry;
+
+  if (index >= g_log_ring_num_pe)
+    return 1;
+
+  while (string[len] != '\0')
+    len++;
+  arg_len = val_log_string_arg_len(string, data);
+  /* Last byte of text holds the argument offset, the format keeps its terminator */
+  if (len + 1 + arg_len > VAL_LOG_TEXT_LEN - 1)
+    return 1;
+
+  ring = &g_log_ring[index];
+  head = ring->head;
+  if (head - ring->tail == VAL_LOG_RING_ENTRIES)
+    val_log_drain(index);
+
+  entry = &ring->entry[head % VAL_LOG_RING_ENTRIES];
+  entry->level = level;
+  entry->line = line;
+  entry->in_test = in_test;
+  entry->check_id = check_id;
+  entry->data = data;
+  entry->file = file;
+  val_memcpy(entry->text, string, len + 1);
+  entry->text[VAL_LOG_TEXT_LEN - 1] = '\0';
+  if (arg_len) {
+    val_memcpy(&entry->text[len + 1], (void *)data, arg_len);
+    entry->text[VAL_LOG_TEXT_LEN - 1] = (char8_t)(len + 1);
+  }
+  ring->head = head + 1;
+  return 0;
+}
 
 /**
   @brief  This API calls PAL layer to print a formatted string
-          to the output console.
+          to the output console. When the print ring is enabled the print is
+          recorded and emitted at the next val_log_flush() instead.
           1. Caller       - Application layer
           2. Prerequisite - None.
 
@@ -48,97 +307,95 @@ struct_sh_data *shared_data;
  **/
 void val_log_context(uint32_t level, char8_t *string, uint64_t data, const char *file, int line)
 {
-#ifndef TARGET_BM_BOOT
-  if (level >= g_print_level)
+  uint32_t check_id = 0;
+
+  if (level < g_print_level)
+    return;
+
+  if (level != ACS_PRINT_DEBUG && level != ACS_PRINT_ERR && level != ACS_PRINT_INFO &&
+      level != ACS_PRINT_WARN && level != ACS_PRINT_ALWAYS)
+    check_id = ++g_print_test_check_id;
+
+  if (g_log_ring == NULL ||
+      val_log_record(level, string, data, file, line, g_print_in_test_context, check_id))
   {
-    if (level == ACS_PRINT_DEBUG)
-    {
-      if (g_print_in_test_context)
-        pal_print("\n\t\tDBG : ", 0);
-      else
-        pal_print("\n\tDBG : ", 0);
-    } else if (level == ACS_PRINT_ERR)
-    {
-      if (g_print_in_test_context)
-        pal_print("\n\t\tERR : ", 0);
-      else
-        pal_print("\n\tERR : ", 0);
-    } else if (level == ACS_PRINT_INFO)
-    {
-      if (g_print_in_test_context)
-        pal_print("\n\t\tINFO: ", 0);
-      else
-        pal_print("\n\tINFO: ", 0);
-    } else if (level == ACS_PRINT_WARN)
-    {
-      if (g_print_in_test_context)
-        pal_print("\n\t\tWARN: ", 0);
-      else
-        pal_print("\n\tWARN: ", 0);
-    } else if (level == ACS_PRINT_ALWAYS)
-    {
-      // Do not print prefix or newline
-      pal_print(string, data);
-      return;
-    } else
-    {
-      if (g_print_test_check_id == 0)
-        pal_print("  Check %d : ", ++g_print_test_check_id);
-      else
-        pal_print("\n  Check %d : ", ++g_print_test_check_id);
-    }
-    pal_print(string, data);
-    /* Print file name and line number for ERR and WARN */
-    if (level == ACS_PRINT_ERR || level == ACS_PRINT_WARN)
-    {
-      pal_print("[FILE: %a]", (uint64_t)file);
-      pal_print("  [LINE: %d]", line);
-    }
+    val_log_flush();
+    val_log_emit(level, string, data, file, line, g_print_in_test_context, check_id);
   }
-#else
-  if (level >= g_print_level) {
-    if (level == ACS_PRINT_DEBUG)
-    {
-      if (g_print_in_test_context)
-        pal_uart_print(level, "\n\t\tDBG: ", 0);
-      else
-        pal_uart_print(level, "\n\tDBG: ", 0);
-    } else if (level == ACS_PRINT_ERR)
-    {
-      if (g_print_in_test_context)
-        pal_uart_print(level, "\n\t\tERR: ", 0);
-      else
-        pal_uart_print(level, "\n\tERR: ", 0);
-    } else if (level == ACS_PRINT_INFO)
-    {
-      if (g_print_in_test_context)
-        pal_uart_print(level, "\n\t\tINFO: ", 0);
-      else
-        pal_uart_print(level, "\n\tINFO", 0);
-    } else if (level == ACS_PRINT_WARN)
-    {
-      if (g_print_in_test_context)
-        pal_uart_print(level, "\n\t\tWARN: ", 0);
-      else
-        pal_uart_print(level, "\n\tWARN: ", 0);
-    } else if (level == ACS_PRINT_ALWAYS)
-    {
-      // Do not print prefix or newline
-      pal_uart_print(level, string, data);
-      return;
-    } else
-    {
-      pal_uart_print(level, "\n  Check %d : ", ++g_print_test_check_id);
-    }
-    pal_uart_print(level, string, data);
-    /* Print file name and line number for ERR and WARN */
-    if (level == ACS_PRINT_ERR || level == ACS_PRINT_WARN)
-    {
-      pal_uart_print(level, "  [FILE: %a]", (uint64_t)file);
-      pal_uart_print(level, "  [LINE: %d]", line);
-    }
+}
+
+/**
+  @brief  Drain the print ring of the calling PE to the console or log file. The
+          primary PE drains at test boundaries, other PEs when they report their
+          status and when their payload returns.
+          1. Caller       - VAL, Application layer
+          2. Prerequisite - None.
+
+  @return        None
+ **/
+void val_log_flush(void)
+{
+  uint32_t index;
+
+  if (g_log_ring == NULL)
+    return;
+
+  index = val_pe_get_index_mpid(val_pe_get_mpid());
+  if (index < g_log_ring_num_pe)
+    val_log_drain(index);
+}
+
+/**
+  @brief  Enable the per-PE print rings so that val_print does not wait on the
+          console while tests run.
+          1. Caller       - Application layer
+          2. Prerequisite - val_pe_create_info_table
+
+  @param num_pe  Number of PEs in the system
+
+  @return        None
+ **/
+void val_log_ring_init(uint32_t num_pe)
+{
+  VAL_LOG_RING *ring;
+
+  if (g_log_ring != NULL || num_pe == 0)
+    return;
+
+  ring = pal_mem_alloc(num_pe * sizeof(VAL_LOG_RING));
+  if (ring == NULL) {
+    val_print(ACS_PRINT_WARN, " Print ring allocation failed, printing synchronously", 0);
+    return;
   }
-#endif
+  val_memory_set(ring, num_pe * sizeof(VAL_LOG_RING), 0);
+  g_log_ring_num_pe = num_pe;
+  g_log_ring = ring;
+
+  /* Secondary PEs may run with the MMU off, make the rings visible at PoC */
+  val_pe_cache_clean_invalidate_range((uint64_t)ring, num_pe * sizeof(VAL_LOG_RING));
+  val_data_cache_ops_by_va((addr_t)&g_log_ring, CLEAN_AND_INVALIDATE);
+  val_data_cache_ops_by_va((addr_t)&g_log_ring_num_pe, CLEAN_AND_INVALIDATE);
+}
+
+/**
+  @brief  Drain and release the per-PE print rings, later prints are synchronous.
+          1. Caller       - Application layer
+          2. Prerequisite - val_log_ring_init
+
+  @return        None
+ **/
+void val_log_ring_free(void)
+{
+  VAL_LOG_RING *ring = g_log_ring;
+
+  if (ring == NULL)
+    return;
+
+  val_log_flush();
+  g_log_ring = NULL;
+  g_log_ring_num_pe = 0;
+  val_data_cache_ops_by_va((addr_t)&g_log_ring, CLEAN_AND_INVALIDATE);
+  pal_mem_free(ring);
 }
 
 /**
@@ -172,6 +429,7 @@ void val_print_raw(uint64_t uart_address, uint32_t level, char8_t *string, uint6
  **/
 uint8_t val_mmio_read8(addr_t addr)
 {
+  val_test_stats_count(VAL_STAT_MMIO, 1);
   return pal_mmio_read8(addr);
 }
 
@@ -187,6 +445,7 @@ uint8_t val_mmio_read8(addr_t addr)
  **/
 uint16_t val_mmio_read16(addr_t addr)
 {
+  val_test_stats_count(VAL_STAT_MMIO, 1);
   return pal_mmio_read16(addr);
 }
 
@@ -202,6 +461,7 @@ uint16_t val_mmio_read16(addr_t addr)
  **/
 uint32_t val_mmio_read(addr_t addr)
 {
+  val_test_stats_count(VAL_STAT_MMIO, 1);
   return pal_mmio_read(addr);
 }
 
@@ -217,6 +477,7 @@ uint32_t val_mmio_read(addr_t addr)
  **/
 uint64_t val_mmio_read64(addr_t addr)
 {
+  val_test_stats_count(VAL_STAT_MMIO, 1);
   return pal_mmio_read64(addr);
 }
 
@@ -233,7 +494,7 @@ uint64_t val_mmio_read64(addr_t addr)
  **/
 void val_mmio_write8(addr_t addr, uint8_t data)
 {
-
+  val_test_stats_count(VAL_STAT_MMIO, 1);
   pal_mmio_write8(addr, data);
 }
 
@@ -250,7 +511,7 @@ void val_mmio_write8(addr_t addr, uint8_t data)
  **/
 void val_mmio_write16(addr_t addr, uint16_t data)
 {
-
+  val_test_stats_count(VAL_STAT_MMIO, 1);
   pal_mmio_write16(addr, data);
 }
 
@@ -267,7 +528,7 @@ void val_mmio_write16(addr_t addr, uint16_t data)
  **/
 void val_mmio_write(addr_t addr, uint32_t data)
 {
-
+  val_test_stats_count(VAL_STAT_MMIO, 1);
   pal_mmio_write(addr, data);
 }
 /**
@@ -283,7 +544,7 @@ void val_mmio_write(addr_t addr, uint32_t data)
  **/
 void val_mmio_write64(addr_t addr, uint64_t data)
 {
-
+  val_test_stats_count(VAL_STAT_MMIO, 1);
   pal_mmio_write64(addr, data);
 }
 
@@ -364,6 +625,9 @@ uint32_t val_initialize_test(char8_t *testname, char8_t *desc, uint32_t num_pe,
   uint32_t dont_skip = 0;
 
   g_print_in_test_context = 1;
+  /* Heap allocations and PA/VA windows of the test are released at its END report */
+  val_memory_arena_open();
+  val_open_test_windows();
   val_print(ACS_PRINT_ALWAYS, "\n", 0);
   print_suite_from_testname(testname);
   val_print(ACS_PRINT_ALWAYS, ", Test: ", 0), val_print(ACS_PRINT_ALWAYS, testname, 0);
@@ -413,6 +677,7 @@ uint32_t val_initialize_test(char8_t *testname, char8_t *desc, uint32_t num_pe,
 
   dont_skip = 1;
   g_rme_tests_total++;
+  val_test_stats_open(testname);
 
   return ACS_STATUS_PASS;
 }
@@ -426,8 +691,18 @@ uint32_t val_initialize_test(char8_t *testname, char8_t *desc, uint32_t num_pe,
 **/
 void val_allocate_shared_mem(void)
 {
+  volatile VAL_SHARED_MEM_t *mem;
+  uint32_t i;
 
   pal_mem_allocate_shared(val_pe_get_num(), sizeof(VAL_SHARED_MEM_t));
+
+  /* No PE is a parked resident worker yet */
+  mem = (VAL_SHARED_MEM_t *)pal_mem_get_shared_addr();
+  for (i = 0; i < val_pe_get_num(); i++) {
+    mem[i].mailbox = VAL_PE_MBOX_OFF;
+    mem[i].resident = 0;
+    val_data_cache_ops_by_va((addr_t)&mem[i].mailbox, CLEAN_AND_INVALIDATE);
+  }
 }
 
 /**
@@ -510,40 +785,286 @@ void val_get_test_data(uint32_t index, uint64_t *data0, uint64_t *data1)
   *data1 = mem->data1;
 }
 
+/**
+  @brief  Enable the generic counter event stream so that a PE sleeping in WFE
+          is woken periodically even if the PE it waits on never sends SEV.
+          1. Caller       - VAL
+
+  @return  Previous value of the counter-timer control register
+**/
+static uint64_t val_wait_event_stream_enable(void)
+{
+  uint64_t cntctl;
+
+  if (AA64ReadCurrentEL() == AARCH64_EL2) {
+    cntctl = ArmReadCnthCtl();
+    ArmWriteCnthCtl((cntctl & ~CNTCTL_EVNTI_MASK) | CNTCTL_EVNTEN | CNTCTL_EVNTI_WAIT);
+  } else {
+    cntctl = ArmReadCntkCtl();
+    ArmWriteCntkCtl((cntctl & ~CNTCTL_EVNTI_MASK) | CNTCTL_EVNTEN | CNTCTL_EVNTI_WAIT);
+  }
+
+  return cntctl;
+}
+
+/**
+  @brief  Restore the counter-timer control register saved by
+          val_wait_event_stream_enable.
+          1. Caller       - VAL
+
+  @param cntctl  Value returned by val_wait_event_stream_enable
+
+  @return  None
+**/
+static void val_wait_event_stream_restore(uint64_t cntctl)
+{
+  if (AA64ReadCurrentEL() == AARCH64_EL2)
+    ArmWriteCnthCtl(cntctl);
+  else
+    ArmWriteCntkCtl(cntctl);
+}
+
+/**
+  @brief  Read the numeric completion status published by val_set_status
+          for a PE index.
+          1. Caller       - VAL
+
+  @param index  PE index
+
+  @return  1 if the PE is still pending, else 0
+**/
+static uint32_t val_pe_status_pending(uint32_t index)
+{
+  volatile VAL_SHARED_MEM_t *mem;
+
+  mem = (VAL_SHARED_MEM_t *)pal_mem_get_shared_addr();
+  mem = mem + index;
+  val_data_cache_ops_by_va((addr_t)&mem->status, INVALIDATE);
+
+  return (mem->status == VAL_PE_STATUS_PENDING);
+}
+
 /**
   @brief  This function will wait for all PEs to report their status
           or we timeout and set a failure for the PE which timed-out
           1. Caller       - Application layer
           2. Prerequisite - val_set_status
 
-  @param num_pe    Number of PE who are executing this test
-  @param timeout   integer value ob expiry the API will timeout and return
+  @param num_pe      Number of PE who are executing this test
+  @param timeout_us  Wait budget in microseconds before the API times out
 
   @return        None
  **/
 
-void val_wait_for_test_completion(uint32_t num_pe, uint32_t timeout)
+void val_wait_for_test_completion(uint32_t num_pe, uint64_t timeout_us)
 {
-  uint32_t i = 0, j = 0;
+  uint32_t done = 0, i;
+  uint64_t cntctl, deadline;
 
   // For single PE tests, there is no need to wait for the results
   if (num_pe == 1)
     return;
 
-  while (--timeout)
+  cntctl = val_wait_event_stream_enable();
+  deadline = val_deadline_start(timeout_us);
+
+  /* PEs below 'done' have all completed, so each PE is looked at until it completes */
+  while (!val_deadline_expired(deadline))
   {
-    j = 0;
-    for (i = 0; i < num_pe; i++)
-    {
-      if (val_memory_compare(val_get_status(i), "PENDING", val_strnlen(val_get_status(i))) == 0)
-        j = i + 1;
+    while ((done < num_pe) && !val_pe_status_pending(done))
+      done++;
+    if (done == num_pe)
+      break;
+    ArmCallWFE();
+  }
+
+  val_wait_event_stream_restore(cntctl);
+
+  if (done == num_pe)
+    return;
+
+  // We are here if we timed-out, set the PEs still pending as failed
+  for (i = done; i < num_pe; i++) {
+    if (val_pe_status_pending(i))
+      val_set_status(i, "FAIL", 0xF);
+  }
+}
+
+/**
+  @brief  This function will wait for a single PE to report its status,
+          sleeping in WFE between checks instead of spinning on the string status.
+          1. Caller       - Test Suite
+          2. Prerequisite - val_execute_on_pe
+
+  @param index       PE index to wait for
+  @param timeout_us  Wait budget in microseconds before the API times out
+
+  @return  Non-zero if the PE completed, 0 if it did not complete in time
+ **/
+uint32_t val_wait_for_pe_completion(uint32_t index, uint64_t timeout_us)
+{
+  uint64_t cntctl, deadline;
+  uint32_t pending;
+
+  cntctl = val_wait_event_stream_enable();
+  deadline = val_deadline_start(timeout_us);
+
+  while ((pending = val_pe_status_pending(index)) && !val_deadline_expired(deadline))
+    ArmCallWFE();
+
+  val_wait_event_stream_restore(cntctl);
+
+  return !pending;
+}
+
+/* Number of PEs each woken PE wakes in a fan-out. PE indices follow the
+   affinity order of the PE info table, so children share the parent's cluster
+   wherever possible. */
+#define VAL_FANOUT_ARITY 2
+
+/* Payload descriptor published once by the primary PE for a fan-out */
+typedef struct {
+  uint64_t payload;
+  uint64_t test_input;
+  uint32_t num_pe;
+  uint32_t primary;
+  uint32_t gen;
+  uint32_t release;   // set to gen once every PE reached the barrier
+} __attribute__((aligned(64))) VAL_FANOUT_DESC;
+
+static VAL_FANOUT_DESC g_val_fanout;
+
+/**
+  @brief  Wake the children of a PE in the fan-out tree. PEs are ranked relative
+          to the primary PE, and rank r wakes ranks r * VAL_FANOUT_ARITY + 1 ...
+          1. Caller       - VAL
+
+  @param desc      Fan-out descriptor
+  @param my_index  Index of the calling PE
+  @param entry     Secondary entry function used for the children
+
+  @return  None
+**/
+static void val_fanout_wake_children(volatile VAL_FANOUT_DESC *desc, uint32_t my_index,
+                                     void (*entry)(void))
+{
+  uint32_t rank, child, i;
+
+  rank = (my_index + desc->num_pe - desc->primary) % desc->num_pe;
+
+  for (i = 1; i <= VAL_FANOUT_ARITY; i++) {
+    child = rank * VAL_FANOUT_ARITY + i;
+    if (child >= desc->num_pe)
+      break;
+    val_pe_fanout_wake((child + desc->primary) % desc->num_pe, entry, (uint64_t)desc);
+  }
+}
+
+/**
+  @brief  Entry function of a PE woken by a fan-out. Wakes its own children,
+          reports arrival at the barrier, waits for the release from the
+          primary PE and then runs the test payload.
+          1. Caller       - val_test_entry on the secondary PE
+
+  @param desc_addr  Address of the fan-out descriptor
+
+  @return  None
+**/
+static void val_fanout_entry(uint64_t desc_addr)
+{
+  volatile VAL_FANOUT_DESC *desc = (VAL_FANOUT_DESC *)desc_addr;
+  volatile VAL_SHARED_MEM_t *mem;
+  uint32_t my_index = val_pe_get_index_mpid(val_pe_get_mpid());
+  uint64_t cntctl, deadline;
+  void (*payload)(uint64_t);
+
+  val_data_cache_ops_by_va((addr_t)desc, INVALIDATE);
+
+  val_fanout_wake_children(desc, my_index, (void (*)(void))val_fanout_entry);
+
+  /* Restore the payload as this PE's test data, as val_execute_on_pe would */
+  val_set_test_data(my_index, desc->payload, desc->test_input);
+
+  mem = (VAL_SHARED_MEM_t *)pal_mem_get_shared_addr();
+  mem = mem + my_index;
+  mem->arrived = desc->gen;
+  val_data_cache_ops_by_va((addr_t)&mem->arrived, CLEAN_AND_INVALIDATE);
+  ArmCallSEV();
+
+  cntctl = val_wait_event_stream_enable();
+  deadline = val_deadline_start(TIMEOUT_LARGE);
+  while (!val_deadline_expired(deadline)) {
+    val_data_cache_ops_by_va((addr_t)desc, INVALIDATE);
+    if (desc->release == desc->gen)
+      break;
+    ArmCallWFE();
+  }
+  val_wait_event_stream_restore(cntctl);
+
+  /* Run the payload regardless, a missed release only costs concurrency */
+  payload = (void (*)(uint64_t))desc->payload;
+  payload(desc->test_input);
+}
+
+/**
+  @brief  Run the payload on all PEs by waking them in a tree and releasing
+          them together from a common barrier.
+          1. Caller       - val_run_test_payload
+          2. Prerequisite - val_pe_create_info_table
+
+  @param num_pe     The number of PEs to run this test on
+  @param payload    Function pointer of the test entry function
+  @param test_input optional parameter for the test payload
+
+  @return        None
+ **/
+static void val_run_test_payload_fanout(uint32_t num_pe, void (*payload)(void),
+                                        uint64_t test_input)
+{
+  volatile VAL_FANOUT_DESC *desc = &g_val_fanout;
+  volatile VAL_SHARED_MEM_t *mem;
+  uint32_t my_index = val_pe_get_index_mpid(val_pe_get_mpid());
+  uint32_t arrived = 0;
+  uint64_t cntctl, deadline;
+
+  desc->payload = (uint64_t)payload;
+  desc->test_input = test_input;
+  desc->num_pe = num_pe;
+  desc->primary = my_index;
+  desc->gen++;
+  val_data_cache_ops_by_va((addr_t)desc, CLEAN_AND_INVALIDATE);
+
+  val_fanout_wake_children(desc, my_index, (void (*)(void))val_fanout_entry);
+
+  /* Barrier: wait for every PE to report the current generation */
+  mem = (VAL_SHARED_MEM_t *)pal_mem_get_shared_addr();
+  cntctl = val_wait_event_stream_enable();
+  deadline = val_deadline_start(TIMEOUT_LARGE);
+  while (!val_deadline_expired(deadline)) {
+    while (arrived < num_pe) {
+      if (arrived != my_index) {
+        val_data_cache_ops_by_va((addr_t)&mem[arrived].arrived, INVALIDATE);
+        if (mem[arrived].arrived != desc->gen)
+          break;
+      }
+      arrived++;
     }
-    // If None of the PE have the status as Pending, return
-    if (!j)
-      return;
+    if (arrived == num_pe)
+      break;
+    ArmCallWFE();
   }
-  // We are here if we timed-out, set the last index PE as failed
-  val_set_status(j - 1, "FAIL", 0xF);
+  val_wait_event_stream_restore(cntctl);
+
+  if (arrived != num_pe)
+    val_print(ACS_PRINT_WARN, " Fan-out barrier timed out at PE index = %d", arrived);
+
+  desc->release = desc->gen;
+  val_data_cache_ops_by_va((addr_t)desc, CLEAN_AND_INVALIDATE);
+  ArmCallSEV();
+
+  payload();
+
+  val_wait_for_test_completion(num_pe, TIMEOUT_LARGE);
 }
 
 /**
@@ -562,6 +1083,11 @@ void val_run_test_payload(uint32_t num_pe, void (*payload)(void), uint64_t test_
   uint32_t my_index = val_pe_get_index_mpid(val_pe_get_mpid());
   uint32_t i;
 
+  if ((num_pe > 1) && g_pe_fanout) {
+    val_run_test_payload_fanout(num_pe, payload, test_input);
+    return;
+  }
+
   payload(); // this is test run separately on present PE
   if (num_pe == 1)
     return;
@@ -740,29 +1266,278 @@ uint32_t val_read_reset_status(void)
   return pal_read_reset_status(rme_nvm_mem);
 }
 
-uint64_t val_get_free_pa(uint64_t size, uint64_t alignment)
+/**
+  @brief  Tear down the EL3 MMU and GPT entries of the windows released since the
+          last flush with a single SMC. The ranges are reusable afterwards.
+**/
+static void free_window_flush(void)
 {
-  uint64_t mem_base;
+  if (g_window_release_num == 0)
+    return;
+
+  if (shared_data_base)
+    val_release_windows_el3(g_window_release, g_window_release_num);
+
+  g_window_release_num = 0;
+}
+
+/**
+  @brief  Natural alignment of a window, so 2MB and 1GB sized windows can be
+          mapped with block descriptors.
+**/
+static uint64_t free_window_align(uint64_t size, uint64_t alignment)
+{
+  uint64_t natural = SIZE_4K;
+
+  if ((size & (SIZE_1G - 1)) == 0)
+    natural = SIZE_1G;
+  else if ((size & (SIZE_2M - 1)) == 0)
+    natural = SIZE_2M;
+
+  return (alignment > natural) ? alignment : natural;
+}
 
-  mem_base = free_mem_var_pa & ~(alignment - 1);
+/**
+  @brief  Return [base, base + size) to the pool, merging it with its neighbours.
+**/
+static void free_window_insert(FREE_WINDOW_POOL *pool, uint64_t base, uint64_t size)
+{
+  uint32_t i, n;
 
-  if (alignment < size)
-    free_mem_var_pa = mem_base + size;
+  /* A range at the top shrinks the pool instead of becoming a free range */
+  if (base + size == *pool->cursor)
+  {
+    *pool->cursor = base;
+    if (pool->num_avail &&
+        (pool->avail[pool->num_avail - 1].base + pool->avail[pool->num_avail - 1].size == base))
+      *pool->cursor = pool->avail[--pool->num_avail].base;
+    return;
+  }
+
+  for (i = 0; (i < pool->num_avail) && (pool->avail[i].base < base); i++)
+    ;
+
+  /* Merge with the preceding and the following range */
+  if (i && (pool->avail[i - 1].base + pool->avail[i - 1].size == base))
+  {
+    pool->avail[i - 1].size += size;
+    if ((i < pool->num_avail) && (base + size == pool->avail[i].base))
+    {
+      pool->avail[i - 1].size += pool->avail[i].size;
+      for (; i + 1 < pool->num_avail; i++)
+        pool->avail[i] = pool->avail[i + 1];
+      pool->num_avail--;
+    }
+    return;
+  }
+  if ((i < pool->num_avail) && (base + size == pool->avail[i].base))
+  {
+    pool->avail[i].base = base;
+    pool->avail[i].size += size;
+    return;
+  }
+
+  if (pool->num_avail == FREE_WINDOW_MAX)
+  {
+    val_print(ACS_PRINT_DEBUG, " Free range table full, 0x%lx is not reused", base);
+    return;
+  }
+
+  for (n = pool->num_avail; n > i; n--)
+    pool->avail[n] = pool->avail[n - 1];
+  pool->avail[i].base = base;
+  pool->avail[i].size = size;
+  pool->avail[i].in_test = 0;
+  pool->num_avail++;
+}
+
+/**
+  @brief  Place a window of size bytes at the given alignment. Released ranges are
+          searched first fit before the window grows.
+**/
+static uint64_t free_window_get(FREE_WINDOW_POOL *pool, uint64_t size, uint64_t alignment)
+{
+  FREE_WINDOW *range;
+  uint64_t base = 0, end;
+  uint32_t i, n;
+
+  size = (size + SIZE_4K - 1) & ~((uint64_t)SIZE_4K - 1);
+  alignment = free_window_align(size, alignment);
+
+  /* Stale EL3 entries must be gone before released space is handed out again */
+  free_window_flush();
+
+  for (i = 0; i < pool->num_avail; i++)
+  {
+    range = &pool->avail[i];
+    base = (range->base + alignment - 1) & ~(alignment - 1);
+    end = range->base + range->size;
+    if (base + size > end)
+      continue;
+
+    if ((base + size < end) && (base > range->base) && (pool->num_avail < FREE_WINDOW_MAX))
+    {
+      /* Keep both the leading and the trailing leftover */
+      for (n = pool->num_avail; n > i + 1; n--)
+        pool->avail[n] = pool->avail[n - 1];
+      pool->avail[i + 1].base = base + size;
+      pool->avail[i + 1].size = end - (base + size);
+      range->size = base - range->base;
+      pool->num_avail++;
+    }
+    else if (base > range->base)
+      range->size = base - range->base;
+    else if (base + size < end)
+    {
+      range->base = base + size;
+      range->size = end - range->base;
+    }
+    else
+    {
+      for (n = i; n + 1 < pool->num_avail; n++)
+        pool->avail[n] = pool->avail[n + 1];
+      pool->num_avail--;
+    }
+    break;
+  }
+
+  if (i == pool->num_avail)
+  {
+    end = *pool->cursor;
+    base = (end + alignment - 1) & ~(alignment - 1);
+    *pool->cursor = base + size;
+    /* Keep the alignment gap for smaller windows */
+    if (base > end)
+      free_window_insert(pool, end, base - end);
+  }
+
+  if (pool->num_live < FREE_WINDOW_MAX)
+  {
+    pool->live[pool->num_live].base = base;
+    pool->live[pool->num_live].size = size;
+    pool->live[pool->num_live].in_test = g_free_window_in_test;
+    pool->num_live++;
+  }
   else
-    free_mem_var_pa = mem_base + alignment;
+    val_print(ACS_PRINT_DEBUG, " Window table full, 0x%lx can not be released", base);
+
+  return base;
+}
+
+/**
+  @brief  Return the live window at index to the pool and queue the teardown of its
+          EL3 entries.
+**/
+static void free_window_put(FREE_WINDOW_POOL *pool, uint32_t index)
+{
+  FREE_WINDOW win = pool->live[index];
+  MMU_MAP_DESC *desc;
+
+  pool->live[index] = pool->live[--pool->num_live];
+
+  if (g_window_release_num == MAX_MMU_MAP_DESC)
+    free_window_flush();
+
+  desc = &g_window_release[g_window_release_num++];
+  desc->va = pool->is_pa ? 0 : win.base;
+  desc->pa = pool->is_pa ? win.base : 0;
+  desc->attr = FREE_PA_RELEASE_GPI;
+  desc->size = win.size;
+
+  free_window_insert(pool, win.base, win.size);
+}
+
+static void free_window_release(FREE_WINDOW_POOL *pool, uint64_t base)
+{
+  uint32_t i;
+
+  for (i = 0; i < pool->num_live; i++)
+  {
+    if (pool->live[i].base == base)
+    {
+      free_window_put(pool, i);
+      return;
+    }
+  }
+  val_print(ACS_PRINT_DEBUG, " 0x%lx is not a live window", base);
+}
+
+/**
+  @brief  Allocate a window of free Physical Address space. Windows obtained while
+          a test runs are released at its END, others live until released.
+  @param  size      - Size of the window in bytes
+  @param  alignment - Minimum alignment, raised to 2MB/1GB for block sized windows
+  @return Base address of the window
+**/
+uint64_t val_get_free_pa(uint64_t size, uint64_t alignment)
+{
+  uint64_t mem_base;
+
+  mem_base = free_window_get(&g_free_pa_pool, size, alignment);
 
   val_print(ACS_PRINT_DEBUG, "The PA allocated = 0x%lx", mem_base);
   return mem_base;
 }
 
+/**
+  @brief  Allocate a window of free Virtual Address space, see val_get_free_pa.
+  @param  size - Size of the window in bytes
+  @return Base address of the window
+**/
 uint64_t val_get_free_va(uint64_t size)
 {
-  uint64_t mem_base;
+  return free_window_get(&g_free_va_pool, size, SIZE_4K);
+}
 
-  mem_base = free_mem_var_va;
-  free_mem_var_va += size;
-  // val_print(ACS_PRINT_DEBUG, "The VA allocated = 0x%lx\n", mem_base);
-  return mem_base;
+/**
+  @brief  Release a window returned by val_get_free_pa. Its GPT entries are
+          returned to FREE_PA_RELEASE_GPI with the next batch.
+  @param  pa - Base address of the window
+**/
+void val_release_free_pa(uint64_t pa)
+{
+  free_window_release(&g_free_pa_pool, pa);
+}
+
+/**
+  @brief  Release a window returned by val_get_free_va. Its EL3 mappings are
+          removed with the next batch.
+  @param  va - Base address of the window
+**/
+void val_release_free_va(uint64_t va)
+{
+  free_window_release(&g_free_va_pool, va);
+}
+
+/**
+  @brief  Open the window scope of a test. Windows allocated from here on are
+          released by val_release_test_windows.
+**/
+void val_open_test_windows(void)
+{
+  g_free_window_in_test = 1;
+}
+
+/**
+  @brief  Release every window allocated since val_open_test_windows and tear down
+          their EL3 MMU and GPT entries in one batch.
+**/
+void val_release_test_windows(void)
+{
+  FREE_WINDOW_POOL *pool[2] = {&g_free_pa_pool, &g_free_va_pool};
+  uint32_t i, p;
+
+  for (p = 0; p < 2; p++)
+  {
+    for (i = pool[p]->num_live; i > 0; i--)
+    {
+      if (pool[p]->live[i - 1].in_test)
+        free_window_put(pool[p], i - 1);
+    }
+  }
+
+  free_window_flush();
+  g_free_window_in_test = 0;
 }
 
 uint64_t val_get_min_tg(void)
@@ -825,7 +1600,7 @@ uint32_t val_configure_acs(void)
     uint64_t s3_off = val_get_smmu_root_reg_offset();
 
     if (!s3_off)
-      s3_off = shared_data->cfg_smmu_root_reg_offset;
+      s3_off = shared_data_hdr->cfg_smmu_root_reg_offset;
     smmu_root_page = smmu_base + s3_off;
   }
   smmu_rlm_page0 = smmu_base + SMMU_R_PAGE_0_OFFSET;
@@ -898,6 +1673,63 @@ uint32_t val_generate_stream_id(void)
   return unique_stream_id;
 }
 
+/**
+  @brief  Give every PE its own shared_data slot, so EL3 services called from
+          different PEs do not overwrite each other's arguments and status.
+          The table is cleaned to PoC for EL3 and for PEs running with the
+          MMU off.
+          1. Caller       -  Application layer.
+          2. Prerequisite -  val_pe_create_info_table, val_init_runtime_params
+  @return ACS_STATUS_ERR if the PEs do not fit in SHARED_MAX_SLOTS, else 0
+**/
+uint32_t val_shared_data_assign_slots(void)
+{
+  uint32_t num_slots, index;
+
+  if (!shared_data_base)
+    return 0;
+
+  num_slots = val_pe_get_num();
+  if (num_slots > SHARED_MAX_SLOTS) {
+    val_print(ACS_PRINT_ERR, "\n PE count %d exceeds the EL3 shared data slots,", num_slots);
+    val_print(ACS_PRINT_ERR, " rebuild with SHARED_MAX_SLOTS >= PE count", 0);
+    return ACS_STATUS_ERR;
+  }
+
+  for (index = 0; index < num_slots; index++)
+    shared_data_hdr->slot_mpidr[index] = val_pe_get_mpid_index(index);
+
+  shared_data_hdr->num_slots = num_slots;
+  val_pe_cache_clean_range((uint64_t)shared_data_hdr, sizeof(SHARED_DATA_HDR));
+
+  return 0;
+}
+
+/**
+  @brief  Return the shared_data slot of the calling PE. Every PE uses slot 0
+          until the slots are assigned, after that a PE missing from the
+          slot table gets NULL. NULL until the shared region is mapped.
+**/
+struct_sh_data *val_shared_data_slot(void)
+{
+  uint64_t mpidr;
+  uint32_t index;
+
+  if (!shared_data_base)
+    return NULL;
+
+  if (!shared_data_hdr->num_slots)
+    return (struct_sh_data *)shared_data_base;
+
+  mpidr = val_pe_get_mpid();
+  for (index = 0; index < shared_data_hdr->num_slots; index++) {
+    if (shared_data_hdr->slot_mpidr[index] == mpidr)
+      return (struct_sh_data *)(shared_data_base + index * SHARED_SLOT_SIZE);
+  }
+
+  return NULL;
+}
+
 void val_init_runtime_params(void)
 {
   uint64_t shared_addr;
@@ -911,18 +1743,18 @@ void val_init_runtime_params(void)
 
   val_map_shared_mem_el3((uint64_t)&shared_addr);
   val_print(ACS_PRINT_DEBUG, " Shared memory address = 0x%lx\n", (uint64_t)shared_addr);
-  shared_data = (struct_sh_data *)shared_addr;
+  shared_data_base = shared_addr;
   /* Prefer EL3-provided free memory hints; fall back to platform getters. */
   {
     sva = val_get_free_va_test();
     spa = val_get_free_pa_test();
 
-    if ((!sva || !spa) && shared_data)
+    if ((!sva || !spa) && shared_data_base)
     {
       if (!sva)
-        sva = shared_data->cfg_free_mem_start + 0x200000;
+        sva = shared_data_hdr->cfg_free_mem_start + 0x200000;
       if (!spa)
-        spa = shared_data->cfg_free_mem_start + 0x300000;
+        spa = shared_data_hdr->cfg_free_mem_start + 0x300000;
     }
 
     free_mem_var_va = sva;
@@ -179,3 +179,41 @@ val_timer_ArmArchTimerWriteReg(
       val_print(ACS_PRINT_WARN, "Unknown ARM Generic Timer register %x. \n ", Reg);
     }
 }
+
+/**
+  @brief  Start a wait deadline on the generic counter.
+          The budget is scaled by the -timeout multiple, so every wait ends in
+          bounded wall time whatever the PE speed.
+          1. Caller       - VAL, Test Suite
+
+  @param  timeout_us  Wait budget in microseconds, TIMEOUT_LARGE/MEDIUM/SMALL
+
+  @return Deadline in CNTPCT_EL0 ticks, to be passed to val_deadline_expired
+**/
+uint64_t
+val_deadline_start(uint64_t timeout_us)
+{
+  uint64_t freq = ArmReadCntFrq();
+
+  /* CNTFRQ_EL0 left unprogrammed by firmware, assume a 1MHz counter */
+  if (freq == 0)
+    freq = 1000000;
+
+  if (g_timeout_multiple > 1)
+    timeout_us *= g_timeout_multiple;
+
+  return ArmReadCntPct() + (timeout_us * freq) / 1000000;
+}
+
+/**
+  @brief  Check a deadline returned by val_deadline_start.
+
+  @param  deadline  Deadline in CNTPCT_EL0 ticks
+
+  @return 1 once the deadline has passed, 0 otherwise
+**/
+uint32_t
+val_deadline_expired(uint64_t deadline)
+{
+  return (ArmReadCntPct() >= deadline);
+}
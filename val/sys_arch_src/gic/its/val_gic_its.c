@@ -18,11 +18,14 @@
 #include "val_gic_its.h"
 #include "include/val_gic_support.h"
 #include "include/val.h"
+#include "include/val_pe.h"
 
 uint64_t ArmReadMpidr(void);
+uint32_t PollTillCommandQueueDone(uint32_t its_index);
 
 extern GIC_ITS_INFO    *g_gic_its_info;
 static uint32_t        *g_cwriter_ptr;
+static uint32_t        *g_cwriter_pub;
 static uint32_t        g_its_setup_done;
 
 uint32_t GET_NUM_BITS(uint64_t value)
@@ -303,6 +306,78 @@ void EnableITS(uint64_t GicItsBase)
   val_mmio_write(GicItsBase + ARM_GITS_CTLR, (value | ARM_GITS_CTLR_ENABLE));
 }
 
+/**
+  @brief  Hand every command staged since the last submit to the ITS. The
+          staged range is cleaned to the PoC once, GITS_CWRITER is written once
+          and CREADR is polled until the ITS has consumed the whole batch.
+  @param  its_index  ITS index
+  @return 0 on success, 1 if the ITS did not drain the queue in time
+**/
+static uint32_t its_cmdq_submit(uint32_t its_index)
+{
+  uint64_t    ItsBase;
+  uint64_t    ItsCommandBase;
+  uint32_t    start, end;
+
+  start = g_cwriter_pub[its_index];
+  end   = g_cwriter_ptr[its_index];
+  if (start == end)
+    return 0;
+
+  ItsBase        = g_gic_its_info->GicIts[its_index].Base;
+  ItsCommandBase = g_gic_its_info->GicIts[its_index].CommandQBase;
+
+  /* The staged range may wrap past the end of the queue */
+  if (end > start) {
+    val_pe_cache_clean_range(ItsCommandBase + (start * NUM_BYTES_IN_DW),
+                             (end - start) * NUM_BYTES_IN_DW);
+  } else {
+    val_pe_cache_clean_range(ItsCommandBase + (start * NUM_BYTES_IN_DW),
+                             (ITS_CMDQ_NUM_DW - start) * NUM_BYTES_IN_DW);
+    val_pe_cache_clean_range(ItsCommandBase, end * NUM_BYTES_IN_DW);
+  }
+
+  TestExecuteBarrier();
+
+  /* Update the CWRITER Register so that all the commands from Command queue gets executed.*/
+  val_mmio_write64((ItsBase + ARM_GITS_CWRITER), (uint64_t)end * NUM_BYTES_IN_DW);
+  g_cwriter_pub[its_index] = end;
+
+  /* Check CREADR value which ensures Command Queue is processed */
+  return PollTillCommandQueueDone(its_index);
+}
+
+/**
+  @brief  Stage one 32-byte ITS command in the command queue using plain
+          cacheable stores. Nothing is visible to the ITS until
+          its_cmdq_submit. If the queue is full the staged commands are
+          submitted first.
+  @param  its_index  ITS index
+  @param  CMDQ_BASE  Command queue base
+  @param  dw0 - dw3  Command double words
+  @return None
+**/
+static void its_cmd_write(uint32_t its_index, uint64_t *CMDQ_BASE,
+                          uint64_t dw0, uint64_t dw1, uint64_t dw2, uint64_t dw3)
+{
+  volatile uint64_t *cmd;
+  uint32_t next;
+
+  next = (g_cwriter_ptr[its_index] + ITS_NEXT_CMD_PTR) % ITS_CMDQ_NUM_DW;
+
+  /* Keep one slot free so that a full queue is never mistaken for an empty one */
+  if (next == g_cwriter_pub[its_index])
+    its_cmdq_submit(its_index);
+
+  cmd = (volatile uint64_t *)(CMDQ_BASE + g_cwriter_ptr[its_index]);
+  cmd[0] = dw0;
+  cmd[1] = dw1;
+  cmd[2] = dw2;
+  cmd[3] = dw3;
+
+  g_cwriter_ptr[its_index] = next;
+}
+
 void
 WriteCmdQMAPD(
    uint32_t     its_index,
@@ -313,13 +388,11 @@ WriteCmdQMAPD(
    uint64_t     Valid
   )
 {
-    val_mmio_write64((uint64_t)(CMDQ_BASE + g_cwriter_ptr[its_index]),
-                     (uint64_t)((device_id << ITS_CMD_SHIFT_DEVID) | ARM_ITS_CMD_MAPD));
-    val_mmio_write64((uint64_t)(CMDQ_BASE + g_cwriter_ptr[its_index] + 1), (uint64_t)(Size));
-    val_mmio_write64((uint64_t)(CMDQ_BASE + g_cwriter_ptr[its_index] + 2),
-                     (uint64_t)((Valid << ITS_CMD_SHIFT_VALID) | (ITT_BASE & ITT_PAR_MASK)));
-    val_mmio_write64((uint64_t)(CMDQ_BASE + g_cwriter_ptr[its_index] + 3), (uint64_t)(0x0));
-    g_cwriter_ptr[its_index] = g_cwriter_ptr[its_index] + ITS_NEXT_CMD_PTR;
+    its_cmd_write(its_index, CMDQ_BASE,
+                  (uint64_t)((device_id << ITS_CMD_SHIFT_DEVID) | ARM_ITS_CMD_MAPD),
+                  (uint64_t)(Size),
+                  (uint64_t)((Valid << ITS_CMD_SHIFT_VALID) | (ITT_BASE & ITT_PAR_MASK)),
+                  (uint64_t)(0x0));
 }
 
 void
@@ -331,13 +404,11 @@ WriteCmdQMAPC(
    uint64_t     Valid
   )
 {
-    val_mmio_write64((uint64_t)(CMDQ_BASE + g_cwriter_ptr[its_index]),
-                     (uint64_t)(ARM_ITS_CMD_MAPC));
-    val_mmio_write64((uint64_t)(CMDQ_BASE + g_cwriter_ptr[its_index] + 1), (uint64_t)(0x0));
-    val_mmio_write64((uint64_t)(CMDQ_BASE + g_cwriter_ptr[its_index] + 2),
-                     (uint64_t)((Valid << ITS_CMD_SHIFT_VALID) | RDBase | Clctn_ID));
-    val_mmio_write64((uint64_t)(CMDQ_BASE + g_cwriter_ptr[its_index] + 3), (uint64_t)(0x0));
-    g_cwriter_ptr[its_index] = g_cwriter_ptr[its_index] + ITS_NEXT_CMD_PTR;
+    its_cmd_write(its_index, CMDQ_BASE,
+                  (uint64_t)(ARM_ITS_CMD_MAPC),
+                  (uint64_t)(0x0),
+                  (uint64_t)((Valid << ITS_CMD_SHIFT_VALID) | RDBase | Clctn_ID),
+                  (uint64_t)(0x0));
 }
 
 void
@@ -349,13 +420,11 @@ WriteCmdQMAPI(
    uint32_t     Clctn_ID
   )
 {
-    val_mmio_write64((uint64_t)(CMDQ_BASE + g_cwriter_ptr[its_index]),
-                     (uint64_t)((device_id << ITS_CMD_SHIFT_DEVID) | ARM_ITS_CMD_MAPTI));
-    val_mmio_write64((uint64_t)(CMDQ_BASE + g_cwriter_ptr[its_index] + 1),
-                     ((uint64_t)(int_id) | ((uint64_t)int_id << 32)));
-    val_mmio_write64((uint64_t)(CMDQ_BASE + g_cwriter_ptr[its_index] + 2), (uint64_t)(Clctn_ID));
-    val_mmio_write64((uint64_t)(CMDQ_BASE + g_cwriter_ptr[its_index] + 3), (uint64_t)(0));
-    g_cwriter_ptr[its_index] = g_cwriter_ptr[its_index] + ITS_NEXT_CMD_PTR;
+    its_cmd_write(its_index, CMDQ_BASE,
+                  (uint64_t)((device_id << ITS_CMD_SHIFT_DEVID) | ARM_ITS_CMD_MAPTI),
+                  ((uint64_t)(int_id) | ((uint64_t)int_id << 32)),
+                  (uint64_t)(Clctn_ID),
+                  (uint64_t)(0));
 }
 
 void
@@ -366,12 +435,25 @@ WriteCmdQINV(
    uint32_t     int_id
   )
 {
-    val_mmio_write64((uint64_t)(CMDQ_BASE + g_cwriter_ptr[its_index]),
-                     (uint64_t)((device_id << ITS_CMD_SHIFT_DEVID) | ARM_ITS_CMD_INV));
-    val_mmio_write64((uint64_t)(CMDQ_BASE + g_cwriter_ptr[its_index] + 1), (uint64_t)(int_id));
-    val_mmio_write64((uint64_t)(CMDQ_BASE + g_cwriter_ptr[its_index] + 2), (uint64_t)(0x0));
-    val_mmio_write64((uint64_t)(CMDQ_BASE + g_cwriter_ptr[its_index] + 3), (uint64_t)(0x0));
-    g_cwriter_ptr[its_index] = g_cwriter_ptr[its_index] + ITS_NEXT_CMD_PTR;
+    its_cmd_write(its_index, CMDQ_BASE,
+                  (uint64_t)((device_id << ITS_CMD_SHIFT_DEVID) | ARM_ITS_CMD_INV),
+                  (uint64_t)(int_id),
+                  (uint64_t)(0x0),
+                  (uint64_t)(0x0));
+}
+
+void
+WriteCmdQINVALL(
+   uint32_t     its_index,
+   uint64_t     *CMDQ_BASE,
+   uint32_t     Clctn_ID
+  )
+{
+    its_cmd_write(its_index, CMDQ_BASE,
+                  (uint64_t)(ARM_ITS_CMD_INVALL),
+                  (uint64_t)(0x0),
+                  (uint64_t)(Clctn_ID),
+                  (uint64_t)(0x0));
 }
 
 void
@@ -382,13 +464,11 @@ WriteCmdQDISCARD(
    uint32_t     int_id
   )
 {
-    val_mmio_write64((uint64_t)(CMDQ_BASE + g_cwriter_ptr[its_index]),
-                     (uint64_t)((device_id << ITS_CMD_SHIFT_DEVID) | ARM_ITS_CMD_DISCARD));
-    val_mmio_write64((uint64_t)(CMDQ_BASE + g_cwriter_ptr[its_index] + 1),
-                     (uint64_t)(int_id));
-    val_mmio_write64((uint64_t)(CMDQ_BASE + g_cwriter_ptr[its_index] + 2), (uint64_t)(0x0));
-    val_mmio_write64((uint64_t)(CMDQ_BASE + g_cwriter_ptr[its_index] + 3), (uint64_t)(0x0));
-    g_cwriter_ptr[its_index] = g_cwriter_ptr[its_index] + ITS_NEXT_CMD_PTR;
+    its_cmd_write(its_index, CMDQ_BASE,
+                  (uint64_t)((device_id << ITS_CMD_SHIFT_DEVID) | ARM_ITS_CMD_DISCARD),
+                  (uint64_t)(int_id),
+                  (uint64_t)(0x0),
+                  (uint64_t)(0x0));
 }
 
 
@@ -399,48 +479,52 @@ WriteCmdQSYNC(
    uint32_t     RDBase
   )
 {
-    val_mmio_write64((uint64_t)(CMDQ_BASE + g_cwriter_ptr[its_index]),
-                     (uint64_t)(ARM_ITS_CMD_SYNC));
-    val_mmio_write64((uint64_t)(CMDQ_BASE + g_cwriter_ptr[its_index] + 1), (uint64_t)(0x0));
-    val_mmio_write64((uint64_t)(CMDQ_BASE + g_cwriter_ptr[its_index] + 2), (uint64_t)(RDBase));
-    val_mmio_write64((uint64_t)(CMDQ_BASE + g_cwriter_ptr[its_index] + 3), (uint64_t)(0x0));
-    g_cwriter_ptr[its_index] = g_cwriter_ptr[its_index] + ITS_NEXT_CMD_PTR;
+    its_cmd_write(its_index, CMDQ_BASE,
+                  (uint64_t)(ARM_ITS_CMD_SYNC),
+                  (uint64_t)(0x0),
+                  (uint64_t)(RDBase),
+                  (uint64_t)(0x0));
 }
 
-void PollTillCommandQueueDone(uint32_t its_index)
+/**
+  @brief  Wait for GITS_CREADR to reach the last published GITS_CWRITER
+          offset. The wait is bounded by a generic timer deadline rather
+          than a loop count so it does not depend on the PE clock.
+  @param  its_index  ITS index
+  @return 0 on success, 1 on timeout
+**/
+uint32_t PollTillCommandQueueDone(uint32_t its_index)
 {
-  uint32_t    count;
   uint64_t    creadr_value;
-  uint64_t    stall_value;
   uint64_t    cwriter_value;
+  uint64_t    deadline;
   uint64_t    ItsBase;
 
-  count = 0;
   ItsBase = g_gic_its_info->GicIts[its_index].Base;
-  cwriter_value = val_mmio_read64(ItsBase + ARM_GITS_CWRITER);
+  cwriter_value = val_mmio_read64(ItsBase + ARM_GITS_CWRITER) & ARM_GITS_CREADR_OFFSET_MASK;
   creadr_value = val_mmio_read64(ItsBase + ARM_GITS_CREADR);
 
-  while (creadr_value != cwriter_value) {
-    /* Check Stall Value */
-    stall_value = creadr_value & ARM_GITS_CREADR_STALL;
+  deadline = val_deadline_start(ITS_CMDQ_TIMEOUT_US);
 
-    if (stall_value) {
+  while ((creadr_value & ARM_GITS_CREADR_OFFSET_MASK) != cwriter_value) {
+    /* Check Stall Value */
+    if (creadr_value & ARM_GITS_CREADR_STALL) {
       /* Retry */
       val_mmio_write64((ItsBase + ARM_GITS_CWRITER),
                   (cwriter_value | ARM_GITS_CWRITER_RETRY)
                  );
     }
 
-    count++;
-    if (count > WAIT_ITS_COMMAND_DONE) {
+    if (val_deadline_expired(deadline)) {
       val_print(ACS_PRINT_ERR,
                 " ITS : Command Queue READR not moving, Test may not pass", 0);
-      break;
+      return 1;
     }
 
     creadr_value = val_mmio_read64(ItsBase + ARM_GITS_CREADR);
   }
 
+  return 0;
 }
 
 uint64_t GetRDBaseFormat(uint32_t its_index)
@@ -470,15 +554,12 @@ uint64_t GetRDBaseFormat(uint32_t its_index)
 
 void val_gic_its_clear_lpi_map(uint32_t its_index, uint32_t device_id, uint32_t int_id)
 {
-  uint64_t    value;
   uint64_t    RDBase;
-  uint64_t    ItsBase;
   uint64_t    ItsCommandBase;
 
   if (!g_its_setup_done)
     return;
 
-  ItsBase        = g_gic_its_info->GicIts[its_index].Base;
   ItsCommandBase = g_gic_its_info->GicIts[its_index].CommandQBase;
 
   /* Clear Config table for LPI=int_id */
@@ -496,13 +577,7 @@ void val_gic_its_clear_lpi_map(uint32_t its_index, uint32_t device_id, uint32_t
   /* ITS SYNC Command */
   WriteCmdQSYNC(its_index, (uint64_t *)(ItsCommandBase), RDBase);
 
-  TestExecuteBarrier();
-  /* Update the CWRITER Register so that all the commands from Command queue gets executed.*/
-  value = ((g_cwriter_ptr[its_index] * NUM_BYTES_IN_DW));
-  val_mmio_write64((ItsBase + ARM_GITS_CWRITER), value);
-
-  /* Check CREADR value which ensures Command Queue is processed */
-  PollTillCommandQueueDone(its_index);
+  its_cmdq_submit(its_index);
   TestExecuteBarrier();
 
 }
@@ -510,7 +585,6 @@ void val_gic_its_clear_lpi_map(uint32_t its_index, uint32_t device_id, uint32_t
 void val_gic_its_create_lpi_map(uint32_t its_index, uint32_t device_id,
                             uint32_t int_id, uint32_t Priority)
 {
-  uint64_t    value;
   uint64_t    RDBase;
   uint64_t    ItsBase;
   uint64_t    ItsCommandBase;
@@ -547,16 +621,107 @@ void val_gic_its_create_lpi_map(uint32_t its_index, uint32_t device_id,
   /* ITS SYNC Command */
   WriteCmdQSYNC(its_index, (uint64_t *)(ItsCommandBase), RDBase);
 
+  its_cmdq_submit(its_index);
   TestExecuteBarrier();
 
-  /* Update the CWRITER Register so that all the commands from Command queue gets executed.*/
-  value = ((g_cwriter_ptr[its_index] * NUM_BYTES_IN_DW));
-  val_mmio_write64((ItsBase + ARM_GITS_CWRITER), value);
+}
+
+/**
+  @brief  Map a contiguous range of LPIs for one device in a single command
+          batch: one MAPD, one MAPC, a MAPI per LPI, one INVALL and one
+          SYNC, published with a single GITS_CWRITER update.
+  @param  its_index    ITS index
+  @param  device_id    Device ID
+  @param  base_int_id  First LPI INTID, also used as the first EventID
+  @param  num_lpis     Number of LPIs to map
+  @param  Priority     LPI priority
+  @return 0 on success, 1 on failure
+**/
+uint32_t val_gic_its_create_lpi_map_range(uint32_t its_index, uint32_t device_id,
+                            uint32_t base_int_id, uint32_t num_lpis, uint32_t Priority)
+{
+  uint64_t    RDBase;
+  uint64_t    ItsBase;
+  uint64_t    ItsCommandBase;
+  uint32_t    int_id;
+
+  if (!g_its_setup_done)
+    return 1;
+
+  ItsBase        = g_gic_its_info->GicIts[its_index].Base;
+  ItsCommandBase = g_gic_its_info->GicIts[its_index].CommandQBase;
+
+  for (int_id = base_int_id; int_id < base_int_id + num_lpis; int_id++)
+    val_gic_its_SetConfigTable(int_id, Priority);
+
+  /* Enable Redistributor */
+  val_gic_its_EnableLPIsRD(g_gic_its_info->GicRdBase);
+
+  /* Enable ITS */
+  EnableITS(ItsBase);
+
+  /* Get RDBase Depending on GITS_TYPER.PTA */
+  RDBase = GetRDBaseFormat(its_index);
+
+  WriteCmdQMAPD(its_index, (uint64_t *)(ItsCommandBase), device_id,
+                g_gic_its_info->GicIts[its_index].ITTBase,
+                g_gic_its_info->GicIts[its_index].IDBits, 0x1 /*Valid*/);
+  WriteCmdQMAPC(its_index, (uint64_t *)(ItsCommandBase),
+                0x1 /*Clctn_ID*/, RDBase, 0x1 /*Valid*/);
+
+  for (int_id = base_int_id; int_id < base_int_id + num_lpis; int_id++)
+    WriteCmdQMAPI(its_index, (uint64_t *)(ItsCommandBase), device_id, int_id, 0x1 /*Clctn_ID*/);
+
+  /* One INVALL on the collection instead of an INV per LPI */
+  WriteCmdQINVALL(its_index, (uint64_t *)(ItsCommandBase), 0x1 /*Clctn_ID*/);
+  WriteCmdQSYNC(its_index, (uint64_t *)(ItsCommandBase), RDBase);
+
+  if (its_cmdq_submit(its_index))
+    return 1;
 
-  /* Check CREADR value which ensures Command Queue is processed */
-  PollTillCommandQueueDone(its_index);
   TestExecuteBarrier();
+  return 0;
+}
 
+/**
+  @brief  Discard a contiguous range of LPIs for one device and unmap the
+          device in a single command batch.
+  @param  its_index    ITS index
+  @param  device_id    Device ID
+  @param  base_int_id  First LPI INTID
+  @param  num_lpis     Number of LPIs to discard
+  @return 0 on success, 1 on failure
+**/
+uint32_t val_gic_its_clear_lpi_map_range(uint32_t its_index, uint32_t device_id,
+                            uint32_t base_int_id, uint32_t num_lpis)
+{
+  uint64_t    RDBase;
+  uint64_t    ItsCommandBase;
+  uint32_t    int_id;
+
+  if (!g_its_setup_done)
+    return 1;
+
+  ItsCommandBase = g_gic_its_info->GicIts[its_index].CommandQBase;
+
+  /* Get RDBase Depending on GITS_TYPER.PTA */
+  RDBase = GetRDBaseFormat(its_index);
+
+  for (int_id = base_int_id; int_id < base_int_id + num_lpis; int_id++) {
+    val_gic_its_ClearConfigTable(int_id);
+    WriteCmdQDISCARD(its_index, (uint64_t *)(ItsCommandBase), device_id, int_id);
+  }
+
+  WriteCmdQMAPD(its_index, (uint64_t *)(ItsCommandBase), device_id,
+                g_gic_its_info->GicIts[its_index].ITTBase,
+                0, 0 /*InValid*/);
+  WriteCmdQSYNC(its_index, (uint64_t *)(ItsCommandBase), RDBase);
+
+  if (its_cmdq_submit(its_index))
+    return 1;
+
+  TestExecuteBarrier();
+  return 0;
 }
 
 
@@ -626,13 +791,18 @@ uint32_t val_gic_its_init(void)
   g_cwriter_ptr = (uint32_t *)pal_aligned_alloc(MEM_ALIGN_4K,
                                                 sizeof(uint32_t) * (g_gic_its_info->GicNumIts));
 
-  if (g_cwriter_ptr == NULL) {
+  g_cwriter_pub = (uint32_t *)pal_aligned_alloc(MEM_ALIGN_4K,
+                                                sizeof(uint32_t) * (g_gic_its_info->GicNumIts));
+
+  if ((g_cwriter_ptr == NULL) || (g_cwriter_pub == NULL)) {
     val_print(ACS_PRINT_ERR, " ITS : Could Not Allocate Memory CWriteR. Test may not pass.", 0);
     return 0;
   }
 
-  for (index = 0; index < g_gic_its_info->GicNumIts; index++)
+  for (index = 0; index < g_gic_its_info->GicNumIts; index++) {
     g_cwriter_ptr[index] = 0;
+    g_cwriter_pub[index] = 0;
+  }
 
   for (index = 0; index < g_gic_its_info->GicNumIts; index++)
   {
@@ -41,7 +41,8 @@
 #define ARM_LPI_MIN_IDBITS  14
 #define ARM_LPI_MAX_IDBITS  31
 
-#define WAIT_ITS_COMMAND_DONE   10000
+/* Deadline for the ITS to consume a submitted command batch */
+#define ITS_CMDQ_TIMEOUT_US     10000
 
 /* GICv3 specific registers */
 
@@ -132,6 +133,7 @@
 
 /* GITS_CREADR Bits */
 #define ARM_GITS_CREADR_STALL       (1 << 0)
+#define ARM_GITS_CREADR_OFFSET_MASK 0xFFFE0
 
 /* GITS_CWRITER Bits */
 #define ARM_GITS_CWRITER_RETRY      (1 << 0)
@@ -177,6 +179,7 @@
 #define ARM_ITS_CMD_MAPI    0xB
 #define ARM_ITS_CMD_MAPTI   0xA
 #define ARM_ITS_CMD_INV     0xC
+#define ARM_ITS_CMD_INVALL  0xD
 #define ARM_ITS_CMD_DISCARD 0xF
 #define ARM_ITS_CMD_SYNC    0x5
 
@@ -187,6 +190,7 @@
 #define ITS_CMD_SHIFT_VALID 63
 #define ITS_NEXT_CMD_PTR    4
 #define NUM_BYTES_IN_DW     8
+#define ITS_CMDQ_NUM_DW     ((NUM_PAGES_8 * SIZE_4KB) / NUM_BYTES_IN_DW)
 
 uint32_t val_gic_its_ArmGicRedistributorConfigurationForLPI(uint64_t rd_base);
 
@@ -201,6 +205,10 @@ void val_gic_its_EnableLPIsRD(uint64_t rd_base);
 void val_gic_its_create_lpi_map(uint32_t its_index, uint32_t device_id,
                             uint32_t int_id, uint32_t Priority);
 void val_gic_its_clear_lpi_map(uint32_t its_index, uint32_t device_id, uint32_t int_id);
+uint32_t val_gic_its_create_lpi_map_range(uint32_t its_index, uint32_t device_id,
+                            uint32_t base_int_id, uint32_t num_lpis, uint32_t Priority);
+uint32_t val_gic_its_clear_lpi_map_range(uint32_t its_index, uint32_t device_id,
+                            uint32_t base_int_id, uint32_t num_lpis);
 
 uint64_t val_gic_its_get_translater_addr(uint32_t its_index);
 uint32_t val_gic_its_get_max_lpi(void);
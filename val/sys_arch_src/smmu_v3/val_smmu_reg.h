@@ -30,6 +30,7 @@ BITFIELD_DECL(uint32_t, IDR0_ST_LEVEL, 28, 27)
 #define SMMU_IDR0_OFFSET 0x0
 #define IDR0_ST_LEVEL_2LVL 1
 #define IDR0_CD2L (1 << 19)
+#define IDR0_MSI (1 << 13)
 #define IDR0_HYP (1 << 9)
 #define IDR0_COHACC (1 << 4)
 
@@ -155,7 +156,17 @@ BITFIELD_DECL(uint64_t, CMDQ_0_OP, 7, 0)
 BITFIELD_DECL(uint64_t, CMDQ_CFGI_1_RANGE, 4, 0)
 #define CMDQ_CFGI_1_ALL_STES 31
 
-#define SMMU_CMDQ_POLL_TIMEOUT 0x100000
+/* Wait budget in microseconds for CONS, CMD_SYNC and register ACK polling */
+#define SMMU_POLL_TIMEOUT_US TIMEOUT_MEDIUM
+
+/* CMD_SYNC completion signalled with an MSI write to memory */
+BITFIELD_DECL(uint64_t, CMDQ_SYNC_0_CS, 13, 12)
+BITFIELD_DECL(uint64_t, CMDQ_SYNC_0_MSH, 23, 22)
+BITFIELD_DECL(uint64_t, CMDQ_SYNC_0_MSIATTR, 27, 24)
+BITFIELD_DECL(uint64_t, CMDQ_SYNC_0_MSIDATA, 63, 32)
+#define CMDQ_SYNC_0_CS_IRQ        1
+#define CMDQ_SYNC_MSIATTR_OIWB    0xF
+#define CMDQ_SYNC_1_MSIADDR_MASK  0xFFFFFFFFFFFFCULL
 
 #define CDTAB_SPLIT			10
 #define CDTAB_L2_ENTRY_COUNT	(1 << CDTAB_SPLIT)
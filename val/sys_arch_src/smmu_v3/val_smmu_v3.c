@@ -75,75 +75,144 @@ static int smmu_cmdq_build_cmd(uint64_t *cmd, uint8_t opcode)
     return 0;
 }
 
-static int smmu_cmdq_write_cmd(smmu_dev_t *smmu, uint64_t *cmd)
+static void smmu_cmdq_poll_until_consumed(smmu_dev_t *smmu)
 {
-    uint32_t timeout = SMMU_CMDQ_POLL_TIMEOUT;
-    int ret = 0, i;
-    uint64_t *cmd_dst;
+    uint64_t deadline = val_deadline_start(SMMU_POLL_TIMEOUT_US);
     smmu_cmd_queue_t *cmdq = &smmu->cmdq;
-
     smmu_queue_t queue = {
-                .log2nent = cmdq->queue.log2nent,
+                .log2nent = smmu->cmdq.queue.log2nent,
+                .prod = val_mmio_read((uint64_t)smmu->cmdq.prod_reg),
+                .cons = val_mmio_read((uint64_t)smmu->cmdq.cons_reg)
             };
 
-    while (smmu_queue_full(&cmdq->queue) && timeout)
-        timeout--;
+    while (!smmu_queue_empty(&queue) && !val_deadline_expired(deadline))
+        queue.cons = val_mmio_read((uint64_t)cmdq->cons_reg);
 
-    if (!timeout) {
-        val_print(ACS_PRINT_ERR, " SMMU CMD queue is full     ", 0);
-        return -1;
+    if (!smmu_queue_empty(&queue)) {
+        val_print(ACS_PRINT_ERR,
+            " CMDQ poll timeout at 0x%08x", queue.prod);
+        val_print(ACS_PRINT_ERR,
+            " prod_reg = 0x%08x", val_mmio_read((uint64_t)smmu->cmdq.prod_reg));
+        val_print(ACS_PRINT_ERR,
+            " cons_reg = 0x%08x", val_mmio_read((uint64_t)smmu->cmdq.cons_reg));
+        val_print(ACS_PRINT_ERR,
+            " gerror   = 0x%08x", val_mmio_read(smmu->base + SMMU_GERROR_OFFSET));
     }
+}
 
-    queue.prod = val_mmio_read((uint64_t)cmdq->prod_reg);
-    cmd_dst = (uint64_t *)(cmdq->base + ((queue.prod & ((0x1ull << queue.log2nent) - 1)) * (cmdq->entry_size)));
-    for (i = 0; i < CMDQ_DWORDS_PER_ENT; ++i)
-        cmd_dst[i] = cmd[i];
-    queue.prod = smmu_cmdq_inc_prod(&queue);
+static void smmu_cmdq_batch_init(smmu_dev_t *smmu, smmu_cmdq_batch_t *batch)
+{
+    smmu_cmd_queue_t *cmdq = &smmu->cmdq;
+
+    batch->smmu = smmu;
+    batch->queue.log2nent = cmdq->queue.log2nent;
+    batch->queue.prod = val_mmio_read((uint64_t)cmdq->prod_reg);
+    batch->queue.cons = val_mmio_read((uint64_t)cmdq->cons_reg);
+    batch->pending = 0;
+}
+
+/* Publish all staged commands to the SMMU with a single PROD write */
+static void smmu_cmdq_batch_publish(smmu_cmdq_batch_t *batch)
+{
+    if (!batch->pending)
+        return;
 
     ArmExecuteMemoryBarrier();
-    val_mmio_write((uint64_t)cmdq->prod_reg, queue.prod);
+    val_mmio_write((uint64_t)batch->smmu->cmdq.prod_reg, batch->queue.prod);
+    batch->pending = 0;
+}
 
-    return ret;
+static uint64_t *smmu_cmdq_batch_slot(smmu_cmdq_batch_t *batch)
+{
+    smmu_cmd_queue_t *cmdq = &batch->smmu->cmdq;
+    uint64_t deadline;
+
+    /* CONS is only read again once the staged commands have filled the queue */
+    if (smmu_queue_full(&batch->queue)) {
+        smmu_cmdq_batch_publish(batch);
+        deadline = val_deadline_start(SMMU_POLL_TIMEOUT_US);
+        while (smmu_queue_full(&batch->queue) && !val_deadline_expired(deadline))
+            batch->queue.cons = val_mmio_read((uint64_t)cmdq->cons_reg);
+
+        if (smmu_queue_full(&batch->queue)) {
+            val_print(ACS_PRINT_ERR, " SMMU CMD queue is full     ", 0);
+            return NULL;
+        }
+    }
+
+    return (uint64_t *)(cmdq->base +
+           ((batch->queue.prod & ((0x1ull << batch->queue.log2nent) - 1)) * (cmdq->entry_size)));
 }
 
-static int smmu_cmdq_issue_cmd(smmu_dev_t *smmu,
-                   uint8_t opcode)
+static int smmu_cmdq_batch_add(smmu_cmdq_batch_t *batch, uint8_t opcode)
 {
-    uint64_t cmd[CMDQ_DWORDS_PER_ENT];
+    uint64_t *cmd;
+
+    cmd = smmu_cmdq_batch_slot(batch);
+    if (!cmd)
+        return -1;
 
     if (smmu_cmdq_build_cmd(cmd, opcode))
         return -1;
 
-    return smmu_cmdq_write_cmd(smmu, cmd);
+    batch->queue.prod = smmu_cmdq_inc_prod(&batch->queue);
+    batch->pending++;
+    return 0;
 }
 
-static void smmu_cmdq_poll_until_consumed(smmu_dev_t *smmu)
+/**
+  @brief Close the batch with a single CMD_SYNC, publish it and wait for the
+         SMMU to complete every staged command. When the SMMU supports MSIs
+         the CMD_SYNC writes a sequence number to memory, which is polled
+         instead of the CONS register.
+  @param batch - staged commands
+  @return 0 on success, -1 on timeout
+**/
+static int smmu_cmdq_batch_submit(smmu_cmdq_batch_t *batch)
 {
-    uint32_t timeout = SMMU_CMDQ_POLL_TIMEOUT;
+    uint64_t deadline;
+    smmu_dev_t *smmu = batch->smmu;
     smmu_cmd_queue_t *cmdq = &smmu->cmdq;
-    smmu_queue_t queue = {
-                .log2nent = smmu->cmdq.queue.log2nent,
-                .prod = val_mmio_read((uint64_t)smmu->cmdq.prod_reg),
-                .cons = val_mmio_read((uint64_t)smmu->cmdq.cons_reg)
-            };
+    uint32_t seq = 0;
+    uint64_t *cmd;
 
-    while (timeout > 0) {
-        if (smmu_queue_empty(&queue))
-            break;
-        queue.cons = val_mmio_read((uint64_t)cmdq->cons_reg);
-        timeout--;
+    cmd = smmu_cmdq_batch_slot(batch);
+    if (!cmd || smmu_cmdq_build_cmd(cmd, CMDQ_OP_CMD_SYNC))
+        return -1;
+
+    if (smmu->supported.msi) {
+        seq = ++cmdq->sync_seq;
+        cmd[0] |= BITFIELD_SET(CMDQ_SYNC_0_CS, CMDQ_SYNC_0_CS_IRQ) |
+                  BITFIELD_SET(CMDQ_SYNC_0_MSH, SMMU_SH_ISH) |
+                  BITFIELD_SET(CMDQ_SYNC_0_MSIATTR, CMDQ_SYNC_MSIATTR_OIWB) |
+                  BITFIELD_SET(CMDQ_SYNC_0_MSIDATA, seq);
+        cmd[1] |= cmdq->sync_phys & CMDQ_SYNC_1_MSIADDR_MASK;
     }
 
-    if (!timeout) {
-        val_print(ACS_PRINT_ERR,
-            " CMDQ poll timeout at 0x%08x", queue.prod);
-        val_print(ACS_PRINT_ERR,
-            " prod_reg = 0x%08x", val_mmio_read((uint64_t)smmu->cmdq.prod_reg));
-        val_print(ACS_PRINT_ERR,
-            " cons_reg = 0x%08x", val_mmio_read((uint64_t)smmu->cmdq.cons_reg));
-        val_print(ACS_PRINT_ERR,
-            " gerror   = 0x%08x", val_mmio_read(smmu->base + SMMU_GERROR_OFFSET));
+    batch->queue.prod = smmu_cmdq_inc_prod(&batch->queue);
+    batch->pending++;
+    smmu_cmdq_batch_publish(batch);
+
+    if (!smmu->supported.msi) {
+        smmu_cmdq_poll_until_consumed(smmu);
+        return 0;
+    }
+
+    deadline = val_deadline_start(SMMU_POLL_TIMEOUT_US);
+    while (!val_deadline_expired(deadline)) {
+        val_data_cache_ops_by_va((addr_t)cmdq->sync_ptr, INVALIDATE);
+        if (*(volatile uint32_t *)cmdq->sync_ptr == seq)
+            return 0;
     }
+
+    val_print(ACS_PRINT_ERR, " CMD_SYNC timeout, seq 0x%08x", seq);
+    val_print(ACS_PRINT_ERR,
+        " prod_reg = 0x%08x", val_mmio_read((uint64_t)cmdq->prod_reg));
+    val_print(ACS_PRINT_ERR,
+        " cons_reg = 0x%08x", val_mmio_read((uint64_t)cmdq->cons_reg));
+    val_print(ACS_PRINT_ERR,
+        " gerror   = 0x%08x", val_mmio_read(smmu->base + SMMU_GERROR_OFFSET));
+    return -1;
 }
 
 static void smmu_strtab_write_ste(smmu_master_t *master, uint64_t *ste)
@@ -253,6 +322,16 @@ static uint32_t smmu_cmd_queue_init(smmu_dev_t *smmu)
                        BITFIELD_SET(QUEUE_BASE_LOG2SIZE, cmdq->queue.log2nent);
 
     cmdq->queue.prod = cmdq->queue.cons = 0;
+
+    /* CMD_SYNC completion word, written by the SMMU through an MSI */
+    if (smmu->supported.msi) {
+        cmdq->sync_ptr = val_memory_calloc(1, sizeof(uint64_t));
+        if (cmdq->sync_ptr)
+            cmdq->sync_phys = (uint64_t)val_memory_virt_to_phys(cmdq->sync_ptr);
+        else
+            smmu->supported.msi = 0;
+    }
+    cmdq->sync_seq = 0;
     return 1;
 }
 
@@ -303,7 +382,7 @@ static int smmu_strtab_init_level2(smmu_dev_t *smmu, uint32_t sid)
     strtab = &cfg->strtab64[(sid >> STRTAB_SPLIT) * STRTAB_L1_DESC_DWORDS];
 
     desc->span = STRTAB_SPLIT + 1;
-    desc->l2ptr = val_memory_calloc(2, size);
+    desc->l2ptr = val_memory_calloc_persistent(2, size);
     if (!desc->l2ptr) {
         val_print(ACS_PRINT_ERR, "	failed to allocate l2 stream table for SID %u	", sid);
         return 0;
@@ -389,12 +468,13 @@ static uint32_t smmu_strtab_init(smmu_dev_t *smmu)
 static int smmu_reg_write_sync(smmu_dev_t *smmu, uint32_t val,
                    unsigned int reg_off, unsigned int ack_off)
 {
-    uint64_t timeout = 0x1000000;
+    uint64_t deadline;
     uint32_t reg;
 
     val_mmio_write(smmu->base + reg_off, val);
 
-    while (timeout--) {
+    deadline = val_deadline_start(SMMU_POLL_TIMEOUT_US);
+    while (!val_deadline_expired(deadline)) {
         reg = val_mmio_read(smmu->base + ack_off);
         if (reg == val)
             return 0;
@@ -416,14 +496,15 @@ static int smmu_dev_disable(smmu_dev_t *smmu)
 
 static void smmu_tlbi_cfgi(smmu_dev_t *smmu)
 {
+    smmu_cmdq_batch_t batch;
+
     /* Invalidate any cached configuration */
-    smmu_cmdq_issue_cmd(smmu, CMDQ_OP_CFGI_ALL);
+    smmu_cmdq_batch_init(smmu, &batch);
+    smmu_cmdq_batch_add(&batch, CMDQ_OP_CFGI_ALL);
     if (smmu->supported.hyp)
-        smmu_cmdq_issue_cmd(smmu, CMDQ_OP_TLBI_EL2_ALL);
-    smmu_cmdq_issue_cmd(smmu, CMDQ_OP_TLBI_NSNH_ALL);
-    smmu_cmdq_issue_cmd(smmu, CMDQ_OP_CMD_SYNC);
-
-    smmu_cmdq_poll_until_consumed(smmu);
+        smmu_cmdq_batch_add(&batch, CMDQ_OP_TLBI_EL2_ALL);
+    smmu_cmdq_batch_add(&batch, CMDQ_OP_TLBI_NSNH_ALL);
+    smmu_cmdq_batch_submit(&batch);
 }
 
 static int smmu_reset(smmu_dev_t *smmu)
@@ -547,6 +628,9 @@ static uint32_t smmu_probe(smmu_dev_t *smmu)
     if (data & IDR0_HYP)
         smmu->supported.hyp = 1;
 
+    if (data & IDR0_MSI)
+        smmu->supported.msi = 1;
+
     if (data & IDR0_S1P)
         smmu->supported.s1p = 1;
 
@@ -647,7 +731,7 @@ static int smmu_cdtab_alloc_leaf_table(smmu_cdtab_l1_ctx_desc_t *l1_desc)
 {
     uint64_t size = CDTAB_L2_ENTRY_COUNT * (CDTAB_CD_DWORDS << 3);
 
-    l1_desc->l2ptr = val_memory_alloc(size*2);
+    l1_desc->l2ptr = val_memory_calloc_persistent(2, size);
     if (!l1_desc->l2ptr) {
         val_print(ACS_PRINT_ERR, " failed to allocate context descriptor table     ", 0);
         return 1;
@@ -755,7 +839,8 @@ static int smmu_cdtab_alloc(smmu_master_t *master)
         cfg->s1fmt = STRTAB_STE_0_S1FMT_64K_L2;
         cdcfg->l1_ent_count = (cdmax + CDTAB_L2_ENTRY_COUNT - 1)/CDTAB_L2_ENTRY_COUNT;
 
-        cdcfg->l1_desc = val_memory_calloc(cdcfg->l1_ent_count, sizeof(*cdcfg->l1_desc));
+        cdcfg->l1_desc = val_memory_calloc_persistent(cdcfg->l1_ent_count,
+                                                      sizeof(*cdcfg->l1_desc));
         if (!cdcfg->l1_desc)
             return 0;
 
@@ -766,7 +851,7 @@ static int smmu_cdtab_alloc(smmu_master_t *master)
         l1_tbl_size = cdmax * (CDTAB_CD_DWORDS << 3);
     }
 
-    cdcfg->cdtab_ptr = val_memory_calloc(2, l1_tbl_size);
+    cdcfg->cdtab_ptr = val_memory_calloc_persistent(2, l1_tbl_size);
     if (!cdcfg->cdtab_ptr) {
         val_print(ACS_PRINT_ERR, " smmu_cdtab_alloc: alloc failed     ", 0);
         return 0;
@@ -788,11 +873,11 @@ smmu_master_t *smmu_master_at(uint32_t sid)
             return node->master;
         node = node->next;
     }
-    node = val_memory_alloc(sizeof(struct smmu_master_node));
+    node = val_memory_calloc_persistent(1, sizeof(struct smmu_master_node));
     if (node == NULL)
         return NULL;
 
-    node->master = val_memory_calloc(1, sizeof(smmu_master_t));
+    node->master = val_memory_calloc_persistent(1, sizeof(smmu_master_t));
     if (node->master == NULL)
     {
         val_memory_free(node);
@@ -995,6 +1080,8 @@ void val_smmu_stop(void)
         smmu_dev_disable(smmu);
         if (smmu->cmdq.base_ptr)
             val_memory_free(smmu->cmdq.base_ptr);
+        if (smmu->cmdq.sync_ptr)
+            val_memory_free(smmu->cmdq.sync_ptr);
         smmu_free_strtab(smmu);
     }
     val_memory_free(g_smmu);
@@ -50,6 +50,9 @@ typedef struct {
     uint64_t entry_size;
     uint32_t *prod_reg;
     uint32_t *cons_reg;
+    uint32_t *sync_ptr;   // CMD_SYNC MSI completion word
+    uint64_t sync_phys;
+    uint32_t sync_seq;
 } smmu_cmd_queue_t;
 
 typedef struct {
@@ -118,11 +121,19 @@ typedef struct {
            uint32_t hyp:1;
            uint32_t s1p:1;
            uint32_t s2p:1;
+           uint32_t msi:1;
         };
         uint32_t bitmap;
     } supported;
 } smmu_dev_t;
 
+/* Commands staged in the command queue memory, published with one PROD write */
+typedef struct {
+    smmu_dev_t   *smmu;
+    smmu_queue_t queue;    // staged PROD and last CONS read
+    uint32_t     pending;  // staged commands not yet published
+} smmu_cmdq_batch_t;
+
 typedef enum {
     SMMU_STAGE_S1 = 0,
     SMMU_STAGE_S2,
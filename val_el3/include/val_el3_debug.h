@@ -20,6 +20,25 @@
 
 #ifndef __ASSEMBLER__
 #include "pal_el3_print.h"
+#include <val_el3_helpers.h>
+
+/*
+ * Console prints of the per-SMC and per-fault path. Release builds set
+ * ACS_EL3_TRACE_CONSOLE to 0 and keep only the EL3 log ring events.
+ */
+#ifndef ACS_EL3_TRACE_CONSOLE
+#define ACS_EL3_TRACE_CONSOLE 1
+#endif
+
+#if ACS_EL3_TRACE_CONSOLE
+# define INFO_TRACE(...)  INFO(__VA_ARGS__)
+#else
+# define INFO_TRACE(...)  no_tf_log(LOG_MARKER_INFO __VA_ARGS__)
+#endif
+
+void val_el3_log_event(uint64_t id, uint64_t arg0, uint64_t arg1, uint64_t arg2,
+                       uint64_t result);
+void val_el3_log_read(EL3_LOG_RING *ring);
 #endif
 
 #endif /* VAL_EL3_DEBUG_H */
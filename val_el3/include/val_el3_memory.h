@@ -34,6 +34,13 @@
 #define ACS_EL3_STACK (PLAT_SHARED_ADDRESS + SIZE_4KB - 0x100)
 #define ACS_EL3_HANDLER_SAVED_POINTER (PLAT_SHARED_ADDRESS + 0x800)
 
+/* Slab size classes: 1 << SLAB_MIN_SHIFT up to 1 << SLAB_MAX_SHIFT bytes */
+#define SLAB_MIN_SHIFT          6
+#define SLAB_MAX_SHIFT          (SLAB_MIN_SHIFT + MEM_POOL_NUM_CLASSES - 1)
+/* A slab chunk is one page, or a single block for classes above a page */
+#define SLAB_PAGE_SHIFT         12
+#define SLAB_PAGE_SIZE          ((size_t)1 << SLAB_PAGE_SHIFT)
+
 #define CIPOPA_NS_BIT           63
 #define CIPOPA_NSE_BIT          62
 #define CIPAE_NS_BIT           63
@@ -47,6 +54,19 @@ typedef struct BlockHeader {
     struct BlockHeader *next;   // Pointer to the next block
 } BlockHeader;
 
+/* Free slab block, the link lives in the block itself */
+typedef struct SlabBlock {
+    struct SlabBlock *next;
+} SlabBlock;
+
+/* Slab chunk header, kept per pool page and indexed by the chunk base page */
+typedef struct SlabChunk {
+    struct SlabChunk *next;     // Next chunk of the class with free blocks
+    SlabBlock *free;            // Free blocks of this chunk
+    uint16_t in_use;            // Blocks handed out from this chunk
+    uint8_t cls;                // Size class + 1, 0 if the page is not a chunk base
+} SlabChunk;
+
 typedef struct {
     uint8_t *base;              // Base address of the memory pool
     size_t size;                // Total size of the pool
@@ -64,9 +84,11 @@ void *val_el3_memory_phys_to_virt(uint64_t pa);
 void *val_el3_memory_alloc(size_t size, size_t alignment);
 void val_el3_memory_free(void *ptr);
 void *val_el3_memory_calloc(size_t num, size_t size, size_t alignment);
+void val_el3_memory_pool_stats(MEM_POOL_STATS *stats);
 void val_el3_cmo_cipapa(uint64_t PA);
 void val_el3_tlbi_paallos(void);
 void val_el3_cln_and_invldt_cache(uint64_t *desc_addr);
+void val_el3_cln_and_invldt_cache_range(uint64_t *start, uint64_t size);
 void val_el3_clean_cache(uint64_t *address);
 void val_el3_invalidate_cache(uint64_t *address);
 void val_el3_mmio_write(uintptr_t addr, uint32_t val);
@@ -75,6 +97,11 @@ uint32_t val_el3_mmio_read64(uintptr_t addr);
 void val_el3_mmio_write64(uintptr_t addr, uint64_t val);
 void val_el3_mem_barrier(void);
 void val_el3_cmo_cipae(uint64_t PA);
+void val_el3_cmo_cipapa_range(uint64_t PA, uint64_t size);
+void val_el3_cmo_cipae_range(uint64_t PA, uint64_t size);
+uint64_t val_el3_read_cntpct(void);
+uint64_t val_el3_read_cntfrq(void);
+uint32_t val_el3_cmo_range(uint64_t PA, uint64_t size, uint64_t arg);
 void val_el3_acs_str(uint64_t *address, uint64_t data);
 void val_el3_tlbi_vae3(uint64_t VA);
 void val_el3_tlbi_alle3is(void);
@@ -82,6 +109,8 @@ void val_el3_isb(void);
 void val_el3_map_shared_mem(uint64_t shared_addr);
 void val_el3_access_mut(void);
 void val_el3_acs_ldr_pas_filter(uint64_t *address, uint64_t data);
+uint64_t val_el3_probe_access(uint64_t va, uint64_t access_type, uint64_t data);
+uint32_t val_el3_probe_matrix(PROBE_MATRIX *mx);
 
 #endif /* __ASSEMBLER__ */
 
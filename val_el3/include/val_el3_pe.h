@@ -34,6 +34,7 @@
 #define ID_AA64MMFR3_EL1_MEC_MASK           ULL(0xf)
 #define ID_AA64MMFR3_EL1_SCTLRX_SHIFT       U(4)
 #define ID_AA64MMFR3_EL1_SCTLRX_MASK        ULL(0xf)
+#define MPIDR_AFF_MASK                      ULL(0xFF00FFFFFF)
 
 /* Prototypes moved from ack_common.c */
 #ifndef __ASSEMBLER__
@@ -42,6 +43,7 @@ void val_el3_pe_reg_list_cmp_msd(void);
 uint64_t val_el3_pe_reg_read(uint32_t reg_id);
 uint64_t val_el3_read_elr_el3(void);
 uint64_t val_el3_read_far(void);
+uint64_t val_el3_read_mpidr(void);
 uint64_t val_el3_read_esr_el3(void);
 uint64_t val_el3_read_sp_el0(void);
 uint64_t val_el3_read_spsr_el3(void);
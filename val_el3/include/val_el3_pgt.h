@@ -137,12 +137,15 @@ typedef struct {
 
 void val_el3_setup_acs_pgt_values(void);
 void val_el3_add_gpt_entry(uint64_t arg0, uint64_t arg1);
+uint32_t val_el3_add_gpt_range(uint64_t base, uint64_t size, uint64_t gpi);
 uint64_t val_el3_get_gpt_index(uint64_t pa, uint8_t level, uint8_t l0gptsz,
                        uint8_t pps, uint8_t p);
 bool val_el3_is_gpi_valid(uint64_t gpi);
 uint64_t val_el3_modify_gpt_gpi(uint64_t entry, uint64_t pa, uint8_t level,
                         uint8_t p, uint64_t GPI);
 uint32_t val_el3_add_mmu_entry(uint64_t arg0, uint64_t arg1, uint64_t arg2);
+uint32_t val_el3_add_mmu_entries(void);
+uint32_t val_el3_release_windows(void);
 uint64_t val_el3_modify_desc(uint64_t table_desc, uint8_t start_bit,
                      uint64_t value_to_set, uint8_t num_bits);
 uint32_t val_el3_log2_page_size(uint64_t size);
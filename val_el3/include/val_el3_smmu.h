@@ -42,6 +42,7 @@
 #define SMMU_IDR0_OFFSET 0x0
 #define IDR0_ST_LEVEL_2LVL 1
 #define IDR0_CD2L (1 << 19)
+#define IDR0_MSI (1 << 13)
 #define IDR0_HYP (1 << 9)
 #define IDR0_COHACC (1 << 4)
 
@@ -263,7 +264,13 @@
 #define CMD_SID_SHIFT 		 U(32)
 #define CMD_SID_MASK 		 0xFFFFFFFF
 
-#define SMMU_CMDQ_POLL_TIMEOUT 0x100000
+/* Budget of every SMMU poll, in microseconds */
+#define SMMU_POLL_TIMEOUT_US 1000000
+
+/* CMD_SYNC completion signalled with an MSI write to memory */
+#define CMDQ_SYNC_0_CS_IRQ        1
+#define CMDQ_SYNC_MSIATTR_OIWB    0xF
+#define CMDQ_SYNC_1_MSIADDR_MASK  0xFFFFFFFFFFFFCULL
 
 #define CDTAB_SPLIT			10
 #define CDTAB_L2_ENTRY_COUNT	(1 << CDTAB_SPLIT)
@@ -308,6 +315,9 @@ typedef struct {
     uint64_t entry_size;
     uint32_t *prod_reg;
     uint32_t *cons_reg;
+    uint32_t *sync_ptr;   // CMD_SYNC MSI completion word, command queue only
+    uint64_t sync_phys;
+    uint32_t sync_seq;
 } smmu_queue_type_t;
 
 typedef struct {
@@ -377,11 +387,19 @@ typedef struct {
            uint32_t hyp:1;
            uint32_t s1p:1;
            uint32_t s2p:1;
+           uint32_t msi:1;
         };
         uint32_t bitmap;
     } supported;
 } smmu_dev_t;
 
+/* Commands staged in the command queue memory, published with one PROD write */
+typedef struct {
+    smmu_dev_t   *smmu;
+    smmu_queue_t queue;    // staged PROD and last CONS read
+    uint32_t     pending;  // staged commands not yet published
+} smmu_cmdq_batch_t;
+
 typedef enum {
     SMMU_STAGE_S1 = 0,
     SMMU_STAGE_S2,
@@ -422,7 +440,10 @@ void val_el3_smmu_access_enable(uint64_t smmu_base);
 void val_el3_smmu_root_config_service(uint64_t arg0, uint64_t arg1, uint64_t arg2);
 void val_el3_smmu_init(uint32_t num_smmu, uint64_t smmu_base_arr[]);
 uint32_t val_el3_smmu_rlm_map(smmu_master_attributes_t master_attr, pgt_descriptor_t pgt_desc);
+void val_el3_smmu_unmap(smmu_master_attributes_t master_attr);
 uint32_t val_el3_dpt_add_entry(uint64_t translated_addr, uint64_t smmu_info);
+uint32_t val_el3_dpt_add_range(uint64_t base, uint64_t size, uint64_t access, uint32_t smmu_index,
+                               uint64_t flags);
 void val_el3_dpt_invalidate_all(uint64_t smmu_index);
 uint32_t val_el3_smmu_set_rlm_ste_mecid(smmu_master_attributes_t master_attr, uint32_t mecid);
 bool val_el3_smmu_supports_mec(uint64_t smmu_base);
@@ -0,0 +1,57 @@
+/** @file
+  * Copyright (c) 2025, Arm Limited or its affiliates. All rights reserved.
+  * SPDX-License-Identifier : Apache-2.0
+
+  * Licensed under the Apache License, Version 2.0 (the "License");
+  * you may not use this file except in compliance with the License.
+  * You may obtain a copy of the License at
+  *
+  *  http://www.apache.org/licenses/LICENSE-2.0
+  *
+  * Unless required by applicable law or agreed to in writing, software
+  * distributed under the License is distributed on an "AS IS" BASIS,
+  * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  * See the License for the specific language governing permissions and
+  * limitations under the License.
+  **/
+#include <val_el3_debug.h>
+#include <val_el3_memory.h>
+#include <val_el3_pe.h>
+
+/* Lives in BL31 memory, NS world only sees the copies made by RME_READ_EL3_LOG */
+static EL3_LOG_RING el3_log;
+
+/**
+ * @brief Record one event in the EL3 log ring, overwriting the oldest one when full.
+ *        PEs may record concurrently, each claims its entry with an atomic increment.
+ *
+ * @param id      SMC service, or EL3_LOG_FAULT.
+ * @param arg0    First argument of the event.
+ * @param arg1    Second argument of the event.
+ * @param arg2    Third argument of the event.
+ * @param result  Outcome of the event.
+ */
+void val_el3_log_event(uint64_t id, uint64_t arg0, uint64_t arg1, uint64_t arg2,
+                       uint64_t result)
+{
+  uint64_t head = __atomic_fetch_add(&el3_log.head, 1, __ATOMIC_RELAXED);
+  EL3_LOG_EVENT *event = &el3_log.event[head % EL3_LOG_NUM_EVENTS];
+
+  event->timestamp = val_el3_read_cntpct();
+  event->mpidr     = val_el3_read_mpidr() & MPIDR_AFF_MASK;
+  event->id        = id;
+  event->arg[0]    = arg0;
+  event->arg[1]    = arg1;
+  event->arg[2]    = arg2;
+  event->result    = result;
+}
+
+/**
+ * @brief Copy the EL3 log ring to an NS buffer mapped by the caller.
+ *
+ * @param ring  Destination of the copy.
+ */
+void val_el3_log_read(EL3_LOG_RING *ring)
+{
+  memcpy(ring, &el3_log, sizeof(el3_log));
+}
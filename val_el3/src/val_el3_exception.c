@@ -52,12 +52,15 @@ void val_el3_ack_handler(void)
 
   elr_ptr = (uint64_t *) SHARED_OFFSET_ELR;
   spsr_ptr = (uint64_t *) SHARED_OFFSET_SPSR;
-  INFO("Inside EL3 ACK Handler\n");
+  INFO_TRACE("Inside EL3 ACK Handler\n");
 
   if (shared_data->exception_expected == SET && shared_data->access_mut == CLEAR) {
-    INFO("The Fault is encountered\n");
+    INFO_TRACE("The Fault is encountered\n");
+    shared_data->esr_value = val_el3_read_esr_el3();
     if (val_el3_read_esr_el3() == GPF_ESR_READ || val_el3_read_esr_el3() == GPF_ESR_WRITE) {
-        INFO("The GPF was expected, encountered and handled\n");
+        INFO_TRACE("The GPF was expected, encountered and handled\n");
+        val_el3_log_event(EL3_LOG_FAULT, shared_data->esr_value, val_el3_read_far(),
+                          val_el3_read_elr_el3(), 1);
         shared_data->exception_generated = SET;
         shared_data->exception_expected = CLEAR;
         VERBOSE("Saved elr = %lx\n", *(elr_ptr));
@@ -72,6 +75,8 @@ void val_el3_ack_handler(void)
         VERBOSE("Saved spsr = %lx\n", *(spsr_ptr));
         VERBOSE("Current elr = %lx\n", val_el3_read_elr_el3());
         VERBOSE("Current spsr = %lx\n", val_el3_read_spsr_el3());
+        val_el3_log_event(EL3_LOG_FAULT, shared_data->esr_value, val_el3_read_far(),
+                          val_el3_read_elr_el3(), 0);
         shared_data->exception_expected = CLEAR;
         val_el3_asm_eret();
     }
@@ -81,7 +86,7 @@ void val_el3_ack_handler(void)
 
     // The access_mut flag is unset as the purpose is served in this section
     shared_data->access_mut = CLEAR;
-    INFO("Argument 1: 0x%lx\n", shared_data->arg1);
+    INFO_TRACE("Argument 1: 0x%lx\n", shared_data->arg1);
     //Store the elr_el3 and spsr_el3 to restore it later
     shared_data->elr_el3 = val_el3_read_elr_el3();
     shared_data->spsr_el3 = val_el3_read_spsr_el3();
@@ -102,7 +107,7 @@ void val_el3_ack_handler(void)
     val_el3_asm_eret_smc();
 
   } else {
-    INFO("Branch to arm-tf handler\n");
+    INFO_TRACE("Branch to arm-tf handler\n");
     val_el3_branch_asm(*(armtf_handler + 1));
   }
 }
@@ -146,22 +146,22 @@ void val_el3_mec_service(uint64_t arg0, uint64_t arg1, uint64_t arg2)
   switch (arg0)
   {
     case ENABLE_MEC:
-      INFO("Enabling MEC\n");
+      INFO_TRACE("Enabling MEC\n");
       val_el3_enable_mec();
       break;
 
     case CONFIG_MECID:
-      INFO("Config mecid\n");
+      INFO_TRACE("Config mecid\n");
       val_el3_write_mecid(arg1);
       break;
 
     case DISABLE_MEC:
-      INFO("Disabling MEC\n");
+      INFO_TRACE("Disabling MEC\n");
       val_el3_disable_mec();
       break;
 
     default:
-      INFO("Invalid MEC service\n");
+      INFO_TRACE("Invalid MEC service\n");
       break;
   }
 }
@@ -16,12 +16,16 @@
  **/
 
 #include <val_el3_debug.h>
+#include <val_el3_exception.h>
 #include <val_el3_memory.h>
 #include <val_el3_mec.h>
 #include <val_el3_pe.h>
 #include <val_el3_pgt.h>
 
-struct_sh_data *shared_data = (struct_sh_data *) PLAT_SHARED_ADDRESS;
+uint64_t shared_data_base = PLAT_SHARED_ADDRESS;
+
+/* Set once the shared region is mapped, the header is not read before that */
+static bool shared_data_mapped;
 
 static MemoryPool mem_pool = {
     .base = (uint8_t *)PLAT_FREE_MEM_SMMU, // Hardcoded address
@@ -29,6 +33,13 @@ static MemoryPool mem_pool = {
     .free_list = NULL,
 };
 
+/* Per size class lists of chunks that still have free blocks */
+static SlabChunk *slab_partial[MEM_POOL_NUM_CLASSES];
+static MEM_POOL_STATS slab_stats;
+
+/* Chunk headers, indexed by the pool page a chunk starts on */
+static SlabChunk slab_chunk[PLAT_MEMORY_POOL_SIZE >> SLAB_PAGE_SHIFT];
+
 /**
  * @brief  Returns the sligned address with the given size
  *
@@ -51,24 +62,54 @@ static size_t align_size(size_t size, size_t alignment)
 void val_el3_map_shared_mem(uint64_t shared_addr)
 {
   uint64_t pgt_attr_el3;
+  uint64_t offset;
 
   pgt_attr_el3 = LOWER_ATTRS(PGT_ENTRY_ACCESS | SHAREABLE_ATTR(OUTER_SHAREABLE)
                                       | PGT_ENTRY_AP_RW | PAS_ATTR(NONSECURE_PAS));
 
-  // Store base address in shared_addr pointer which will be used by NS world
-  val_el3_add_mmu_entry((uint64_t)shared_data, (uint64_t)shared_data, pgt_attr_el3);
+  // Map the per PE slots and the global header
+  for (offset = 0; offset < SHARED_REGION_SIZE; offset += SHARED_SLOT_SIZE)
+    val_el3_add_mmu_entry(shared_data_base + offset, shared_data_base + offset, pgt_attr_el3);
 
   // Store base address in shared_addr pointer which will be used by NS world
   val_el3_add_mmu_entry(shared_addr, shared_addr, pgt_attr_el3);
-  *(uint64_t *)shared_addr = (uint64_t)shared_data;
+  *(uint64_t *)shared_addr = shared_data_base;
 
-  struct_sh_data *sd = (struct_sh_data *)shared_data;
+  SHARED_DATA_HDR *hdr = shared_data_hdr;
+  /* Every PE uses slot 0 until NS world assigns the slots */
+  hdr->num_slots = 0;
   /* EL3 cfg populated for NS consumption */
-  sd->cfg_free_mem_start       = PLAT_FREE_MEM_START;
-  sd->cfg_free_mem_smmu        = PLAT_FREE_MEM_SMMU;
-  sd->cfg_memory_pool_size     = PLAT_MEMORY_POOL_SIZE;
-  sd->cfg_smmu_root_reg_offset = SMMUV3_ROOT_REG_OFFSET;
+  hdr->cfg_free_mem_start       = PLAT_FREE_MEM_START;
+  hdr->cfg_free_mem_smmu        = PLAT_FREE_MEM_SMMU;
+  hdr->cfg_memory_pool_size     = PLAT_MEMORY_POOL_SIZE;
+  hdr->cfg_smmu_root_reg_offset = SMMUV3_ROOT_REG_OFFSET;
+  shared_data_mapped = true;
+}
+
+/**
+ *  @brief  Returns the shared_data slot of the calling PE, looked up by its MPIDR in the
+ *          slot table NS world writes to the shared header. Slot 0 until NS world assigns
+ *          the slots.
+ *  @return Slot of the calling PE, NULL if the PE is missing from the slot table
+**/
+struct_sh_data *val_shared_data_slot(void)
+{
+  uint64_t mpidr;
+  uint64_t index;
+
+  if (!shared_data_mapped)
+    return (struct_sh_data *)shared_data_base;
+
+  if (!shared_data_hdr->num_slots)
+    return (struct_sh_data *)shared_data_base;
+
+  mpidr = val_el3_read_mpidr() & MPIDR_AFF_MASK;
+  for (index = 0; index < shared_data_hdr->num_slots && index < SHARED_MAX_SLOTS; index++) {
+    if (shared_data_hdr->slot_mpidr[index] == mpidr)
+      return (struct_sh_data *)(shared_data_base + index * SHARED_SLOT_SIZE);
+  }
 
+  return NULL;
 }
 
 /**
@@ -117,13 +158,101 @@ void val_el3_memory_set(void *address, uint32_t size, uint8_t value)
 }
 
 /**
- * @brief Free memory previously allocated from EL3 pool.
+ * @brief Return a block to the first-fit list and coalesce free neighbours.
+ *
+ * @param ptr  Pointer returned by val_el3_pool_list_alloc.
+ */
+static void val_el3_pool_list_free(void *ptr)
+{
+    BlockHeader *block = (BlockHeader *)((uint8_t *)ptr - sizeof(BlockHeader));
+    block->is_free = 1;
+
+    // Coalesce adjacent free blocks
+    BlockHeader *current = mem_pool.free_list;
+    while (current) {
+        if (current->is_free && current->next && current->next->is_free) {
+            current->size += current->next->size + sizeof(BlockHeader);
+            current->next = current->next->next;
+            continue;
+        }
+        current = current->next;
+    }
+}
+
+/**
+ * @brief Return the slab chunk header of a pool address. A chunk is either
+ *        one page or a single block, so a block always starts on the page
+ *        its chunk starts on.
+ *
+ * @param ptr  Pointer into the EL3 pool.
+ * @return chunk header, or NULL if ptr is not slab memory
+ */
+static SlabChunk *val_el3_slab_chunk_of(void *ptr)
+{
+    uintptr_t offset = (uintptr_t)ptr - (uintptr_t)mem_pool.base;
+
+    if (((uintptr_t)ptr < (uintptr_t)mem_pool.base) || (offset >= mem_pool.size))
+        return NULL;
+
+    if (!slab_chunk[offset >> SLAB_PAGE_SHIFT].cls)
+        return NULL;
+
+    return &slab_chunk[offset >> SLAB_PAGE_SHIFT];
+}
+
+/**
+ * @brief Push a block back on its chunk. A chunk whose blocks are all free
+ *        goes back to the first-fit list, unless it is the last chunk of
+ *        its class with free blocks.
+ *
+ * @param chunk  Chunk header of the block.
+ * @param ptr    Block to free.
+ */
+static void val_el3_slab_free(SlabChunk *chunk, void *ptr)
+{
+    uint32_t cls = chunk->cls - 1;
+    size_t block_size = (size_t)1 << (cls + SLAB_MIN_SHIFT);
+    size_t chunk_size = (block_size > SLAB_PAGE_SIZE) ? block_size : SLAB_PAGE_SIZE;
+    SlabBlock *block = (SlabBlock *)ptr;
+    SlabChunk **link;
+
+    /* A full chunk is off the partial list, put it back */
+    if (!chunk->free) {
+        chunk->next = slab_partial[cls];
+        slab_partial[cls] = chunk;
+    }
+
+    block->next = chunk->free;
+    chunk->free = block;
+    chunk->in_use--;
+    slab_stats.cls[cls].in_use--;
+    slab_stats.cls[cls].free++;
+    slab_stats.cls[cls].frees++;
+
+    if (chunk->in_use || ((slab_partial[cls] == chunk) && !chunk->next))
+        return;
+
+    for (link = &slab_partial[cls]; *link != chunk; link = &(*link)->next)
+        ;
+    *link = chunk->next;
+
+    slab_stats.cls[cls].free -= chunk_size / block_size;
+    chunk->cls = 0;
+    val_el3_pool_list_free((uint8_t *)mem_pool.base +
+                           ((chunk - slab_chunk) << SLAB_PAGE_SHIFT));
+}
+
+/**
+ * @brief Free memory previously allocated from EL3 pool. Slab blocks are
+ *        pushed back on their chunk in O(1); larger blocks and empty
+ *        chunks go back to the first-fit list.
  *
  * @param ptr  Pointer returned by val_el3_memory_alloc/calloc.
  */
 void val_el3_memory_free(void *ptr)
 {
     uint32_t mecid = 0;
+    SlabChunk *chunk;
 
     if (!ptr) return;
 
@@ -135,18 +264,13 @@ void val_el3_memory_free(void *ptr)
         val_el3_write_mecid(VAL_GMECID);
     }
 
-
-    BlockHeader *block = (BlockHeader *)((uint8_t *)ptr - sizeof(BlockHeader));
-    block->is_free = 1;
-
-    // Coalesce adjacent free blocks
-    BlockHeader *current = mem_pool.free_list;
-    while (current) {
-        if (current->is_free && current->next && current->next->is_free) {
-            current->size += current->next->size + sizeof(BlockHeader);
-            current->next = current->next->next;
-        }
-        current = current->next;
+    chunk = val_el3_slab_chunk_of(ptr);
+    if (chunk) {
+        val_el3_slab_free(chunk, ptr);
+    } else {
+        val_el3_pool_list_free(ptr);
+        slab_stats.large_in_use--;
+        slab_stats.large_frees++;
     }
 
     /* Restore MECID */
@@ -190,34 +314,158 @@ void val_el3_split_block(BlockHeader *block, size_t size)
   @param   data    - The data which is written on the address
   @return  None
 **/
+/**
+ * @brief Read a MUT location with the requested access width.
+ */
+static uint64_t val_el3_mut_read(uint64_t addr, uint32_t width)
+{
+  switch (width)
+  {
+      case ACCESS_WIDTH_8:
+        return *(volatile uint8_t *)addr;
+      case ACCESS_WIDTH_16:
+        return *(volatile uint16_t *)addr;
+      case ACCESS_WIDTH_64:
+        return *(volatile uint64_t *)addr;
+      default:
+        return *(volatile uint32_t *)addr;
+  }
+}
+
+/**
+ * @brief Write a MUT location with the requested access width.
+ */
+static void val_el3_mut_write(uint64_t addr, uint64_t data, uint32_t width)
+{
+  switch (width)
+  {
+      case ACCESS_WIDTH_8:
+        *(volatile uint8_t *)addr = (uint8_t)data;
+        break;
+      case ACCESS_WIDTH_16:
+        *(volatile uint16_t *)addr = (uint16_t)data;
+        break;
+      case ACCESS_WIDTH_64:
+        *(volatile uint64_t *)addr = data;
+        break;
+      default:
+        *(volatile uint32_t *)addr = (uint32_t)data;
+        break;
+  }
+}
+
+/**
+ * @brief Execute one range descriptor (fill, compare, copy or read) in a single loop.
+ *
+ * The loop stops early when an expected exception has been taken on one of the accesses.
+ * A compare mismatch is reported only in acc->result.
+ *
+ * @param acc  Range descriptor.
+ * @return 0 on success, 1 on an invalid descriptor.
+ */
+static uint32_t val_el3_access_mut_range(SHARED_DATA_ACCESS *acc)
+{
+  uint32_t type = acc->access_type & ACCESS_TYPE_MASK;
+  uint32_t width = (acc->access_type & ACCESS_WIDTH_MASK) >> ACCESS_WIDTH_SHIFT;
+  uint64_t step, off, data, pattern;
+  bool fault_expected = (shared_data->exception_expected == SET);
+
+  step = (width == ACCESS_WIDTH_8) ? 1 : (width == ACCESS_WIDTH_16) ? 2 :
+         (width == ACCESS_WIDTH_64) ? 8 : 4;
+  if (width > ACCESS_WIDTH_64 || (acc->size & (step - 1)) ||
+      ((acc->addr | acc->buf) & (step - 1)))
+  {
+      ERROR("Invalid MUT range access 0x%lx size 0x%lx\n", acc->addr, acc->size);
+      return 1;
+  }
+
+  /* Only the low 'step' bytes of the pattern take part in the compare */
+  pattern = (step == 8) ? acc->data : acc->data & ((0x1ull << (step * 8)) - 1);
+  acc->result = 0;
+
+  for (off = 0; off < acc->size; off += step)
+  {
+      switch (type)
+      {
+          case FILL_RANGE:
+            val_el3_mut_write(acc->addr + off, pattern, width);
+            break;
+          case COMPARE_RANGE:
+            data = val_el3_mut_read(acc->addr + off, width);
+            if (data != pattern) {
+                acc->result = acc->addr + off;
+                VERBOSE("Mismatch at 0x%lx, read 0x%lx expected 0x%lx\n",
+                        acc->result, data, pattern);
+            }
+            break;
+          case COPY_RANGE:
+            data = val_el3_mut_read(acc->buf + off, width);
+            val_el3_mut_write(acc->addr + off, data, width);
+            break;
+          default:
+            /* READ_RANGE */
+            data = val_el3_mut_read(acc->addr + off, width);
+            val_el3_mut_write(acc->buf + off, data, width);
+            break;
+      }
+      /* A compare stops at the first mismatch, the next descriptor still runs */
+      if (acc->result || (fault_expected && shared_data->exception_generated == SET))
+          break;
+  }
+  VERBOSE("MUT range access type %d done for 0x%lx bytes at 0x%lx\n",
+          type, off, acc->addr);
+  return 0;
+}
+
 /**
  * @brief Perform read/write accesses to MUT addresses as per shared_data.
  *
  * Iterates shared_data->shared_data_access and executes requested operations.
+ * access_type[7:0] selects the operation and access_type[11:8] the access width
+ * (see MUT_ACCESS()). READ_DATA and WRITE_DATA access a single location, the
+ * range operations cover 'size' bytes from 'addr' with one descriptor. A failed
+ * range descriptor sets status_code and stops the walk of the list.
  */
 void val_el3_access_mut(void)
 {
-  uint8_t type, num = shared_data->num_access;
+  uint8_t num = shared_data->num_access;
+  uint32_t type, width;
   uint64_t data;
+  SHARED_DATA_ACCESS *acc;
 
   for (int acc_cnt = 0; acc_cnt < num; ++acc_cnt)
   {
 
-    type = shared_data->shared_data_access[acc_cnt].access_type;
+    acc = &shared_data->shared_data_access[acc_cnt];
+    type = acc->access_type & ACCESS_TYPE_MASK;
+    width = (acc->access_type & ACCESS_WIDTH_MASK) >> ACCESS_WIDTH_SHIFT;
     switch (type)
     {
         case READ_DATA:
-          data = *(volatile uint32_t *) shared_data->shared_data_access[acc_cnt].addr;
-          VERBOSE("The data returned from the address, 0x%lx is 0x%x\n",
-               shared_data->shared_data_access[acc_cnt].addr, (uint32_t)data);
-          shared_data->shared_data_access[acc_cnt].data = data;
+          data = val_el3_mut_read(acc->addr, width);
+          VERBOSE("The data returned from the address, 0x%lx is 0x%lx\n",
+               acc->addr, data);
+          acc->data = data;
           break;
         case WRITE_DATA:
-          data = shared_data->shared_data_access[acc_cnt].data;
-          *(volatile uint32_t *)shared_data->shared_data_access[acc_cnt].addr = data;
-          VERBOSE("Data stored in VA, 0x%lx is 0x%x\n",
-                shared_data->shared_data_access[acc_cnt].addr,
-                *(uint32_t *)shared_data->shared_data_access[acc_cnt].addr);
+          data = acc->data;
+          val_el3_mut_write(acc->addr, data, width);
+          VERBOSE("Data stored in VA, 0x%lx is 0x%lx\n",
+                acc->addr, val_el3_mut_read(acc->addr, width));
+          break;
+        case FILL_RANGE:
+        case COMPARE_RANGE:
+        case COPY_RANGE:
+        case READ_RANGE:
+          if (val_el3_access_mut_range(acc)) {
+              shared_data->status_code = 1;
+              const char *msg = "EL3: Invalid MUT range descriptor";
+              int i = 0; while (msg[i] && i < sizeof(shared_data->error_msg) - 1) {
+                  shared_data->error_msg[i] = msg[i]; i++;
+              }
+              shared_data->error_msg[i] = '\0';
+              return;
+          }
           break;
         default:
           ERROR("INVALID TYPE OF ACCESS");
@@ -226,6 +474,99 @@ void val_el3_access_mut(void)
   }
 }
 
+/**
+ * @brief Run a table of (PA, access PAS, read/write) probes in one service call.
+ *
+ * Each probe maps the scratch VA to its PA through the requested access PAS and
+ * accesses it. A fault on the access is recovered by the ack handler without
+ * leaving EL3, its ESR_EL3 is stored in the probe and a GPF also sets the probe
+ * bit in gpf_map.
+ *
+ * @param mx  Probe table, an NS buffer mapped at EL3 by the NS world.
+ * @return 0 on success, 1 on an oversized table or a mapping failure.
+ */
+uint32_t val_el3_probe_matrix(PROBE_MATRIX *mx)
+{
+  uint64_t n, attr, data;
+  PROBE_DESC *probe;
+
+  if (mx->num_probes > MAX_PROBE_DESC)
+  {
+      ERROR("%lu probes exceed the limit\n", mx->num_probes);
+      return 1;
+  }
+
+  memset(mx->gpf_map, 0, sizeof(mx->gpf_map));
+  if (mx->flags & PROBE_MASK_ASYNC)
+      val_el3_set_daif();
+
+  for (n = 0; n < mx->num_probes; n++)
+  {
+      probe = &mx->probe[n];
+      attr = mx->attr | LOWER_ATTRS(PAS_ATTR(probe->access_pas));
+      if (val_el3_add_mmu_entry(mx->va, probe->pa, attr))
+          return 1;
+      val_el3_tlbi_vae3(mx->va);
+
+      shared_data->esr_value = 0;
+      shared_data->exception_generated = CLEAR;
+      shared_data->access_mut = CLEAR;
+      shared_data->exception_expected = SET;
+      data = val_el3_probe_access(mx->va, probe->access_type, probe->data);
+      shared_data->exception_expected = CLEAR;
+
+      if (probe->access_type != READ_DATA || !(mx->flags & PROBE_DISCARD_LOAD))
+          probe->data = data;
+
+      probe->esr = shared_data->esr_value;
+      if (shared_data->exception_generated == SET)
+          mx->gpf_map[n / 64] |= (0x1ull << (n % 64));
+      VERBOSE("Probe PA 0x%lx PAS %lu ESR 0x%lx\n", probe->pa, probe->access_pas, probe->esr);
+  }
+
+  shared_data->exception_generated = CLEAR;
+  return 0;
+}
+
+/**
+ * @brief Clean and invalidate a PA range to the PoPA or the PoE.
+ *
+ * The range is walked at the CTR_EL0 line size with a single barrier at the end.
+ * The CNTPCT ticks the walk took are stored in shared_data->cmo_ticks.
+ *
+ * @param PA    Start of the range.
+ * @param size  Range size in bytes, 0 for a single line.
+ * @param arg   CMO_RANGE_ARG(access PAS, CMO_OP_POPA or CMO_OP_POE).
+ * @return 0 on success, 1 on an unknown operation.
+ */
+uint32_t val_el3_cmo_range(uint64_t PA, uint64_t size, uint64_t arg)
+{
+  uint64_t pas = arg & CMO_RANGE_PAS_MASK;
+  uint64_t op = arg >> CMO_RANGE_OP_SHIFT;
+  uint64_t start;
+
+  PA = val_el3_modify_desc(PA, CIPOPA_NS_BIT, NS_SET(pas), 1);
+  PA = val_el3_modify_desc(PA, CIPOPA_NSE_BIT, NSE_SET(pas), 1);
+
+  start = val_el3_read_cntpct();
+  switch (op)
+  {
+      case CMO_OP_POPA:
+        val_el3_cmo_cipapa_range(PA, size);
+        break;
+      case CMO_OP_POE:
+        val_el3_cmo_cipae_range(PA, size);
+        break;
+      default:
+        ERROR("Invalid CMO range operation %lu\n", op);
+        return 1;
+  }
+  shared_data->cmo_ticks = val_el3_read_cntpct() - start;
+
+  VERBOSE("CMO range 0x%lx size 0x%lx took %lu ticks\n", PA, size, shared_data->cmo_ticks);
+  return 0;
+}
+
 /**
  * @brief  Allocates requested buffer size in bytes with zeros in a contiguous memory
  *         and returns the base address of the range.
@@ -266,9 +607,94 @@ void *val_el3_memory_phys_to_virt(uint64_t pa)
   return (void *)pa;
 }
 
+/**
+ * @brief  First-fit allocation from the pool free list. Used for slab
+ *         chunks and for requests larger than the biggest size class.
+ *
+ * @param  Size         allocation size in bytes
+ * @param  alignment    Required alignment for the buffer
+ * @retval if SUCCESS   pointer to allocated memory
+ * @retval if FAILURE   NULL
+ */
+static void *val_el3_pool_list_alloc(size_t size, size_t alignment)
+{
+    size = align_size(size, alignment); // Align the requested size
+    BlockHeader *current = mem_pool.free_list;
+
+    while (current) {
+        // Align the starting address of the block
+        uintptr_t block_start = (uintptr_t)current + sizeof(BlockHeader);
+        uintptr_t aligned_start = align_size(block_start, alignment);
+
+        // Leave room for the header of the leading padding block
+        if (aligned_start != block_start)
+            aligned_start = align_size(block_start + sizeof(BlockHeader), alignment);
+        size_t alignment_padding = aligned_start - block_start;
+
+        if (current->is_free && current->size >= size + alignment_padding) {
+            // Return the leading padding to the free list as its own block
+            if (alignment_padding) {
+                val_el3_split_block(current, alignment_padding - sizeof(BlockHeader));
+                current = current->next;
+            }
+            if (current->size > size + sizeof(BlockHeader)) {
+                val_el3_split_block(current, size);
+            }
+            current->is_free = 0;
+            return (void *)aligned_start;
+        }
+        current = current->next;
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief  Refill a size class with a new chunk from the first-fit list. A
+ *         chunk is one page, or a single block for classes above a page,
+ *         and is aligned to its own size so every block carved from it is
+ *         naturally aligned to its class size.
+ *
+ * @param  cls  Size class index
+ * @return 0 on success, 1 if the pool is exhausted
+ */
+static uint32_t val_el3_slab_refill(uint32_t cls)
+{
+    uint8_t *base;
+    size_t block_size = (size_t)1 << (cls + SLAB_MIN_SHIFT);
+    size_t chunk_size = (block_size > SLAB_PAGE_SIZE) ? block_size : SLAB_PAGE_SIZE;
+    size_t offset;
+    SlabChunk *chunk;
+    SlabBlock *block;
+
+    base = val_el3_pool_list_alloc(chunk_size, chunk_size);
+    if (!base)
+        return 1;
+
+    chunk = &slab_chunk[((uintptr_t)base - (uintptr_t)mem_pool.base) >> SLAB_PAGE_SHIFT];
+    chunk->cls = cls + 1;
+    chunk->in_use = 0;
+    chunk->free = NULL;
+
+    /* Push in reverse so blocks are handed out in address order */
+    for (offset = chunk_size; offset >= block_size; offset -= block_size) {
+        block = (SlabBlock *)(base + offset - block_size);
+        block->next = chunk->free;
+        chunk->free = block;
+        slab_stats.cls[cls].free++;
+    }
+
+    chunk->next = slab_partial[cls];
+    slab_partial[cls] = chunk;
+
+    return 0;
+}
+
 /**
  * @brief  Allocates requested buffer size in bytes in a contiguous memory
- *         and returns the base address of the range.
+ *         and returns the base address of the range. Requests up to
+ *         1 << SLAB_MAX_SHIFT bytes are rounded up to a power-of-two size
+ *         class and served from a chunk of that class in O(1).
  *
  * @param  Size         allocation size in bytes
  * @param  alignment    Required alignment for the buffer
@@ -278,6 +704,10 @@ void *val_el3_memory_phys_to_virt(uint64_t pa)
 void *val_el3_memory_alloc(size_t size, size_t alignment)
 {
     uint32_t mecid = 0;
+    uint32_t cls;
+    size_t need;
+    SlabChunk *chunk;
+    void *ptr = NULL;
 
     if (!mem_pool.free_list)
     {
@@ -292,31 +722,53 @@ void *val_el3_memory_alloc(size_t size, size_t alignment)
         val_el3_write_mecid(VAL_GMECID);
     }
 
-    size = align_size(size, alignment); // Align the requested size
-    BlockHeader *current = mem_pool.free_list;
-
-    while (current) {
-        // Align the starting address of the block
-        uintptr_t block_start = (uintptr_t)current + sizeof(BlockHeader);
-        uintptr_t aligned_start = align_size(block_start, alignment);
-        size_t alignment_padding = aligned_start - block_start;
+    /* Blocks are naturally aligned, so the class also covers the alignment */
+    need = (size > alignment) ? size : alignment;
+    for (cls = 0; cls < MEM_POOL_NUM_CLASSES; cls++) {
+        if (need <= ((size_t)1 << (cls + SLAB_MIN_SHIFT)))
+            break;
+    }
 
-        if (current->is_free && current->size >= size + alignment_padding) {
-            if (current->size > size + alignment_padding + sizeof(BlockHeader)) {
-                val_el3_split_block(current, size + alignment_padding);
-            }
-            current->is_free = 0;
-            /* Restore MECID */
-            if (val_el3_is_mec_enabled())
-                val_el3_write_mecid(mecid);
-            return (void *)aligned_start;
+    if (cls < MEM_POOL_NUM_CLASSES) {
+        if (slab_partial[cls] || !val_el3_slab_refill(cls)) {
+            chunk = slab_partial[cls];
+            ptr = chunk->free;
+            chunk->free = chunk->free->next;
+            chunk->in_use++;
+            /* A full chunk leaves the partial list until a block is freed */
+            if (!chunk->free)
+                slab_partial[cls] = chunk->next;
+            slab_stats.cls[cls].free--;
+            slab_stats.cls[cls].allocs++;
+            if (++slab_stats.cls[cls].in_use > slab_stats.cls[cls].peak)
+                slab_stats.cls[cls].peak = slab_stats.cls[cls].in_use;
+        }
+    } else {
+        ptr = val_el3_pool_list_alloc(size, alignment);
+        if (ptr) {
+            slab_stats.large_in_use++;
+            slab_stats.large_allocs++;
         }
-        current = current->next;
     }
 
     /* Restore MECID */
     if (val_el3_is_mec_enabled())
         val_el3_write_mecid(mecid);
 
-    return NULL;
+    return ptr;
+}
+
+/**
+ * @brief  Copy the pool occupancy statistics to a caller buffer.
+ *
+ * @param  stats  Destination, typically an NS buffer passed by the NS world
+ */
+void val_el3_memory_pool_stats(MEM_POOL_STATS *stats)
+{
+    uint32_t cls;
+
+    for (cls = 0; cls < MEM_POOL_NUM_CLASSES; cls++)
+        slab_stats.cls[cls].block_size = (uint64_t)1 << (cls + SLAB_MIN_SHIFT);
+
+    memcpy(stats, &slab_stats, sizeof(slab_stats));
 }
@@ -58,6 +58,32 @@ typedef struct {
 
 static acs_pgt_t acs_pgt_info;
 
+typedef struct {
+    uint8_t p;          /* Physical granule size, log2 */
+    uint8_t pps;        /* Protected physical address size, log2 */
+    uint8_t l0gptsz;    /* Region size described by one level 0 entry, log2 */
+} gpt_geometry_t;
+
+typedef struct {
+    uint64_t pgt_base;
+    uint64_t page_size;
+    uint32_t page_size_log2;
+    uint32_t bits_per_level;
+    uint32_t num_pgt_levels;
+    uint32_t ias;
+    uint32_t oas;
+    uint64_t *leaf_table;   /* Last level table reached by the previous walk */
+    uint64_t leaf_va;       /* VA bits above the region covered by leaf_table */
+} mmu_walk_t;
+
+/* GPT level 1 descriptor encodings, DDI0615 */
+#define GPT_L1_CONTIG_DESC        0x1ull
+#define GPT_L1_GPI_MASK           (0xfull << 4)
+#define GPT_L1_CONTIG_SIZE_SHIFT  8
+#define GPT_L1_CONTIG_SIZE_MASK   (0x3ull << GPT_L1_CONTIG_SIZE_SHIFT)
+/* Replicates a 4-bit GPI into all 16 GPI fields of a granule descriptor */
+#define GPT_L1_GRANULE_FILL(gpi)  ((gpi) * 0x1111111111111111ull)
+
 void val_el3_setup_acs_pgt_values(void)
 {
     acs_pgt_info.l0_index = 0;
@@ -164,52 +190,71 @@ uint64_t get_block_size(uint32_t level)
 }
 
 /**
-  @brief   This function maps a given Physical Address into the GPT table with the specified GPI
-           1. Caller       -  Test Suite
-  @param   arg0 - Physical Address needed to be mapped into the GPT table
-  @param   arg1 - GPI encoding required for the corresponding Physical Address
+  @brief   This function decodes the GPT geometry from GPCCR_EL3 and GPTBR_EL3
+           1. Caller       -  add_gpt_entry, add_gpt_range
+  @param   gpt_desc - Descriptor updated with the GPCCR fields and level 0 GPT base
+  @param   geo      - Decoded PGS, PPS and L0GPTSZ widths in bits
   @return  None
 **/
-void val_el3_add_gpt_entry(uint64_t arg0, uint64_t arg1)
+static void val_el3_get_gpt_geometry(gpt_descriptor_t *gpt_desc, gpt_geometry_t *geo)
 {
-    gpt_descriptor_t gpt_desc;
-    uint64_t PA = arg0;
-    uint64_t gpi = arg1;
-    uint64_t base, *gpt_entry_base_0, index_0, index_1, *l0_entry, *l1_entry, *gpt_entry_base_1;
-    uint8_t p, pgs[3] = {12 /*4KB*/, 16 /*64KB*/, 14 /*16KB*/};
-    uint8_t pps, pps_[7] = {32 /*4GB*/, 36 /*64GB*/, 40 /*1TB*/, 42 /*4TB*/,
+    uint64_t base;
+    uint8_t pgs[3] = {12 /*4KB*/, 16 /*64KB*/, 14 /*16KB*/};
+    uint8_t pps_[7] = {32 /*4GB*/, 36 /*64GB*/, 40 /*1TB*/, 42 /*4TB*/,
         44 /*16TB*/, 48 /*256TB*/, 52 /*1PB*/};
-    uint8_t l0gptsz, x, l0_idx_width;
+    uint8_t x, l0_idx_width;
 
     /* Get translation attributes via GPCCR */
     uint64_t val = val_el3_read_gpccr_el3();
 
-    gpt_desc.gpccr.pps = (val & RME_ACS_GPCCR_PPS_MASK) >> RME_ACS_GPCCR_PPS_SHIFT;
-    gpt_desc.gpccr.l0gptsz = (val & RME_ACS_GPCCR_L0GPTSZ_MASK) >> RME_ACS_GPCCR_L0GPTSZ_SHIFT;
-    gpt_desc.gpccr.pgs = (val & RME_ACS_GPCCR_PGS_MASK) >> RME_ACS_GPCCR_PGS_SHIFT;
-    gpt_desc.gpccr.orgn = (val & RME_ACS_GPCCR_ORGN_MASK) >> RME_ACS_GPCCR_ORGN_SHIFT;
-    gpt_desc.gpccr.irgn = (val & RME_ACS_GPCCR_IRGN_MASK) >> RME_ACS_GPCCR_IRGN_SHIFT;
-    gpt_desc.gpccr.sh = (val & RME_ACS_GPCCR_SH_MASK) >> RME_ACS_GPCCR_SH_SHIFT;
-    INFO("gpccr->pps = %d\n", gpt_desc.gpccr.pps);
-    INFO("gpccr->pgs = %d\n", gpt_desc.gpccr.pgs);
-    INFO("gpccr->l0gptsz = %d\n", gpt_desc.gpccr.l0gptsz);
-    INFO("gpccr->orgn = %d\n", gpt_desc.gpccr.orgn);
-    INFO("gpccr->irgn = %d\n", gpt_desc.gpccr.irgn);
-    INFO("gpccr->sh = %d\n", gpt_desc.gpccr.sh);
+    gpt_desc->gpccr.pps = (val & RME_ACS_GPCCR_PPS_MASK) >> RME_ACS_GPCCR_PPS_SHIFT;
+    gpt_desc->gpccr.l0gptsz = (val & RME_ACS_GPCCR_L0GPTSZ_MASK) >> RME_ACS_GPCCR_L0GPTSZ_SHIFT;
+    gpt_desc->gpccr.pgs = (val & RME_ACS_GPCCR_PGS_MASK) >> RME_ACS_GPCCR_PGS_SHIFT;
+    gpt_desc->gpccr.orgn = (val & RME_ACS_GPCCR_ORGN_MASK) >> RME_ACS_GPCCR_ORGN_SHIFT;
+    gpt_desc->gpccr.irgn = (val & RME_ACS_GPCCR_IRGN_MASK) >> RME_ACS_GPCCR_IRGN_SHIFT;
+    gpt_desc->gpccr.sh = (val & RME_ACS_GPCCR_SH_MASK) >> RME_ACS_GPCCR_SH_SHIFT;
+    INFO("gpccr->pps = %d\n", gpt_desc->gpccr.pps);
+    INFO("gpccr->pgs = %d\n", gpt_desc->gpccr.pgs);
+    INFO("gpccr->l0gptsz = %d\n", gpt_desc->gpccr.l0gptsz);
+    INFO("gpccr->orgn = %d\n", gpt_desc->gpccr.orgn);
+    INFO("gpccr->irgn = %d\n", gpt_desc->gpccr.irgn);
+    INFO("gpccr->sh = %d\n", gpt_desc->gpccr.sh);
         /* Get GPTBR */
     base = val_el3_read_gptbr_el3();
     INFO("GPT_base = 0x%lx\n", base);
-    p = pgs[gpt_desc.gpccr.pgs];
-    pps = pps_[gpt_desc.gpccr.pps];
-    l0gptsz = gpt_desc.gpccr.l0gptsz + 30;
-    l0_idx_width = (pps > l0gptsz) ? (pps - l0gptsz) : 0;
+    geo->p = pgs[gpt_desc->gpccr.pgs];
+    geo->pps = pps_[gpt_desc->gpccr.pps];
+    geo->l0gptsz = gpt_desc->gpccr.l0gptsz + 30;
+    l0_idx_width = (geo->pps > geo->l0gptsz) ? (geo->pps - geo->l0gptsz) : 0;
     /* The level 0 GPT is aligned in memory to the greater of:
         1. the size of the level 0 GPT in bytes.
         2. 4KB.
     */
     x = get_max(l0_idx_width + 3, 12);
-    gpt_desc.gpt_base = (base << 12) & ~((0x1ull << x) - 1);
-    VERBOSE("Level 0 Base address = 0x%lx\n", gpt_desc.gpt_base);
+    gpt_desc->gpt_base = (base << 12) & ~((0x1ull << x) - 1);
+    VERBOSE("Level 0 Base address = 0x%lx\n", gpt_desc->gpt_base);
+}
+
+/**
+  @brief   This function maps a given Physical Address into the GPT table with the specified GPI
+           1. Caller       -  Test Suite
+  @param   arg0 - Physical Address needed to be mapped into the GPT table
+  @param   arg1 - GPI encoding required for the corresponding Physical Address
+  @return  None
+**/
+void val_el3_add_gpt_entry(uint64_t arg0, uint64_t arg1)
+{
+    gpt_descriptor_t gpt_desc;
+    gpt_geometry_t geo;
+    uint64_t PA = arg0;
+    uint64_t gpi = arg1;
+    uint64_t *gpt_entry_base_0, index_0, index_1, *l0_entry, *l1_entry, *gpt_entry_base_1;
+    uint8_t p, pps, l0gptsz;
+
+    val_el3_get_gpt_geometry(&gpt_desc, &geo);
+    p = geo.p;
+    pps = geo.pps;
+    l0gptsz = geo.l0gptsz;
 
         /*    Level 0 GPT walk     */
     index_0 = val_el3_get_gpt_index(PA, 0, l0gptsz, pps, p);
@@ -409,32 +454,160 @@ uint64_t val_el3_modify_gpt_gpi(uint64_t entry, uint64_t pa, uint8_t level, uint
 }
 
 /**
-  @brief   This function maps a passed Virtual Address to the mentioned
-           Physical Address and changes the Access PAS if it's required
+  @brief   This function returns the size of the region described by a level 1
+           contiguous descriptor
+  @param   entry - Contiguous descriptor
+  @return  log2 of the contiguous region size
+**/
+static uint8_t val_el3_gpt_contig_shift(uint64_t entry)
+{
+    switch ((entry & GPT_L1_CONTIG_SIZE_MASK) >> GPT_L1_CONTIG_SIZE_SHIFT)
+    {
+        case 0x1:
+            return 21;  /* 2MB */
+        case 0x2:
+            return 25;  /* 32MB */
+        default:
+            return 29;  /* 512MB */
+    }
+}
+
+/**
+  @brief   This function assigns a GPI to a whole Physical Address range in one pass.
+           The GPT geometry is decoded once, level 1 descriptors that are fully
+           covered are rewritten in place (as contiguous descriptors where the range
+           is aligned to a contiguous region), and the modified descriptors are
+           cleaned once per level 1 table. The caller issues a single TLBI PAALLOS.
+           A contiguous descriptor only partly covered by the range is first split
+           into granule descriptors carrying its old GPI.
            1. Caller       -  Test Suite
-           2. Prerequisite -  None
-  @param   arg0 - Virtual Address needed for the MMU mapping
-  @param   arg1 - Physical Address needed to be mapped to the Virtual Address
-  @param   arg2 - Access PAS for the corresponding mapping if specified or NON_SECURE by default
+  @param   base - Base Physical Address of the range, granule aligned
+  @param   size - Size of the range in bytes, granule aligned
+  @param   gpi  - GPI encoding required for the range
   @return  0 on Success and 1 on Failure
 **/
-uint32_t val_el3_add_mmu_entry(uint64_t arg0, uint64_t arg1, uint64_t arg2)
+uint32_t val_el3_add_gpt_range(uint64_t base, uint64_t size, uint64_t gpi)
+{
+    gpt_descriptor_t gpt_desc;
+    gpt_geometry_t geo;
+    uint64_t pa, end, l0_end, run_end, entry_size, blk_size, desc, i, n;
+    uint64_t *l0_table, *l0_entry, *l1_table, *l1_entry, *first, *dirty_lo, *dirty_hi;
+    uint8_t entry_shift, cs, code;
+
+    val_el3_get_gpt_geometry(&gpt_desc, &geo);
+
+    if (!val_el3_is_gpi_valid(gpi) || size == 0 ||
+        ((base | size) & ((0x1ull << geo.p) - 1)) ||
+        (base + size < base) || (base + size > (0x1ull << geo.pps)))
+    {
+        ERROR("Invalid GPT range 0x%lx size 0x%lx gpi 0x%lx\n", base, size, gpi);
+        return 1;
+    }
+
+    entry_shift = geo.p + 4;
+    entry_size = 0x1ull << entry_shift;
+    l0_table = (uint64_t *)gpt_desc.gpt_base;
+    end = base + size;
+    pa = base;
+
+    while (pa < end)
+    {
+        l0_entry = &l0_table[val_el3_get_gpt_index(pa, 0, geo.l0gptsz, geo.pps, geo.p)];
+        l0_end = (pa | ((0x1ull << geo.l0gptsz) - 1)) + 1;
+
+        if (!IS_GPT_ENTRY_TABLE(*l0_entry))
+        {
+            /* Block descriptor, the GPI applies to the whole level 0 region */
+            *l0_entry = val_el3_modify_gpt_gpi(*l0_entry, pa, 0, geo.p, gpi);
+            val_el3_cln_and_invldt_cache(l0_entry);
+            pa = l0_end;
+            continue;
+        }
+
+        /* Table_descriptor[51:12] = Next level Base address */
+        l1_table = (uint64_t *)(*l0_entry & (((0x1ull << 40) - 1) << 12));
+        run_end = get_min(end, l0_end);
+        dirty_lo = dirty_hi = &l1_table[val_el3_get_gpt_index(pa, 1, geo.l0gptsz, geo.pps, geo.p)];
+
+        while (pa < run_end)
+        {
+            l1_entry = &l1_table[val_el3_get_gpt_index(pa, 1, geo.l0gptsz, geo.pps, geo.p)];
+
+            if (IS_GPT_ENTRY_CONTIG(*l1_entry))
+            {
+                cs = val_el3_gpt_contig_shift(*l1_entry);
+                blk_size = 0x1ull << cs;
+                n = blk_size >> entry_shift;
+                first = &l1_table[val_el3_get_gpt_index(pa & ~(blk_size - 1), 1,
+                                                       geo.l0gptsz, geo.pps, geo.p)];
+                if (!(pa & (blk_size - 1)) && (pa + blk_size <= run_end)) {
+                    desc = (*l1_entry & ~GPT_L1_GPI_MASK) | (gpi << 4);
+                    pa += blk_size;
+                } else {
+                    /* Split, then revisit pa as a granule descriptor */
+                    desc = GPT_L1_GRANULE_FILL((*l1_entry >> 4) & 0xf);
+                }
+                for (i = 0; i < n; i++)
+                    first[i] = desc;
+                dirty_lo = get_min(dirty_lo, first);
+                dirty_hi = get_max(dirty_hi, &first[n - 1]);
+                continue;
+            }
+
+            /* Use the largest contiguous descriptor the alignment allows */
+            for (cs = 29, code = 0x3; cs >= 21; cs -= 4, code--)
+            {
+                blk_size = 0x1ull << cs;
+                if ((cs > entry_shift) && (cs <= geo.l0gptsz) &&
+                    !(pa & (blk_size - 1)) && (pa + blk_size <= run_end))
+                    break;
+            }
+            if (cs >= 21) {
+                n = blk_size >> entry_shift;
+                desc = GPT_L1_CONTIG_DESC | (gpi << 4) | (code << GPT_L1_CONTIG_SIZE_SHIFT);
+                for (i = 0; i < n; i++)
+                    l1_entry[i] = desc;
+                dirty_hi = get_max(dirty_hi, &l1_entry[n - 1]);
+                pa += blk_size;
+            } else if (!(pa & (entry_size - 1)) && (pa + entry_size <= run_end)) {
+                *l1_entry = GPT_L1_GRANULE_FILL(gpi);
+                dirty_hi = get_max(dirty_hi, l1_entry);
+                pa += entry_size;
+            } else {
+                /* Partial granule descriptor, Granules_descriptor[4*i + 3: 4*i] = GPI */
+                desc = *l1_entry;
+                do {
+                    i = (pa >> geo.p) & 0xf;
+                    desc = (desc & ~(0xfull << (4 * i))) | (gpi << (4 * i));
+                    pa += 0x1ull << geo.p;
+                } while ((pa < run_end) && (pa & (entry_size - 1)));
+                *l1_entry = desc;
+                dirty_hi = get_max(dirty_hi, l1_entry);
+            }
+        }
+        VERBOSE("val_el3_add_gpt_range: L1 entries 0x%lx - 0x%lx updated\n",
+                (uint64_t)dirty_lo, (uint64_t)dirty_hi);
+        val_el3_cln_and_invldt_cache_range(dirty_lo,
+                                (uint64_t)(dirty_hi - dirty_lo + 1) * sizeof(uint64_t));
+    }
+
+    INFO_TRACE("GPT range 0x%lx - 0x%lx mapped with gpi 0x%lx\n", base, end, gpi);
+    return 0;
+}
+
+/**
+  @brief   This function decodes the EL3 stage 1 translation regime from TCR_EL3
+           and TTBR_EL3 into a walk context
+           1. Caller       -  add_mmu_entry, add_mmu_entries
+  @param   walk - Walk context to initialise
+  @return  None
+**/
+static void val_el3_mmu_walk_init(mmu_walk_t *walk)
 {
-    uint64_t input_address = arg0, page_size;
-    uint64_t output_address, attr;
-    uint64_t *table_desc, tt_base_phys, *tt_base_virt;
-    uint32_t num_pgt_levels, page_size_log2, index;
-    uint32_t this_level, bits_remaining, bits_at_this_level, bits_per_level;
     pgt_descriptor_t pgt_desc;
     uint32_t oas_bit_arr[8] = {32, 36, 40, 42, 44, 48, 52, 56}; /* Physical address sizes */
     uint32_t tg_arr[3] = {SIZE_4KB, SIZE_16KB, SIZE_64KB}; /* Translation Granule Size */
 
-    output_address = arg1;
-    attr = arg2;
-    INFO("val_pe_mmu_map_add: Output Address = 0x%lx\n", output_address);
-    INFO("val_pe_mmu_map_add: Input Address = 0x%lx\n", input_address);
-    INFO("val_pe_mmu_map_add: Attribute = 0x%lx\n", attr);
-
     val_el3_get_tcr_info(&pgt_desc.tcr);
     pgt_desc.pgt_base = val_el3_read_ttbr_el3() & AARCH64_TTBR_ADDR_MASK;
     pgt_desc.stage = PGT_STAGE1;
@@ -443,44 +616,56 @@ uint32_t val_el3_add_mmu_entry(uint64_t arg0, uint64_t arg1, uint64_t arg2)
     VERBOSE("Input addr size in bits (ias) = %d\n", pgt_desc.ias);
     VERBOSE("Output addr size in bits (oas) = %d\n", pgt_desc.oas);
 
-    page_size = tg_arr[pgt_desc.tcr.tg];
-    page_size_log2 = val_el3_log2_page_size(page_size);
-    bits_per_level = page_size_log2 - 3;
-    num_pgt_levels = (pgt_desc.ias - page_size_log2 + bits_per_level - 1)/bits_per_level;
-    num_pgt_levels = (num_pgt_levels > 4)?4:num_pgt_levels;
-    tt_base_phys = pgt_desc.pgt_base;
-    this_level = 0;
-    bits_remaining = (num_pgt_levels - 1) * bits_per_level + page_size_log2;
-    bits_at_this_level = pgt_desc.ias - bits_remaining;
-    tt_base_virt = (uint64_t *)tt_base_phys;
+    walk->pgt_base = pgt_desc.pgt_base;
+    walk->ias = pgt_desc.ias;
+    walk->oas = pgt_desc.oas;
+    walk->page_size = tg_arr[pgt_desc.tcr.tg];
+    walk->page_size_log2 = val_el3_log2_page_size(walk->page_size);
+    walk->bits_per_level = walk->page_size_log2 - 3;
+    walk->num_pgt_levels = (walk->ias - walk->page_size_log2 + walk->bits_per_level - 1)
+                            / walk->bits_per_level;
+    walk->num_pgt_levels = (walk->num_pgt_levels > 4)?4:walk->num_pgt_levels;
+    walk->leaf_table = NULL;
+    walk->leaf_va = 0;
+}
 
-    if (output_address >= (0x1ull << pgt_desc.oas))
-    {
-        ERROR("val_pe_mmu_map_add: output address size error\n");
-        return 1;
-    }
+/**
+  @brief   This function returns the last level descriptor for a Virtual Address,
+           allocating intermediate tables from free memory when required. The last
+           level table of the previous walk is remembered so neighbouring VAs that
+           share it skip the walk from TTBR_EL3.
+           1. Caller       -  add_mmu_entry, add_mmu_entries
+  @param   walk          - Walk context from val_el3_mmu_walk_init
+  @param   input_address - Virtual Address to look up
+  @return  Pointer to the last level descriptor for the Virtual Address
+**/
+static uint64_t *val_el3_mmu_walk(mmu_walk_t *walk, uint64_t input_address)
+{
+    uint64_t *table_desc, tt_base_phys, *tt_base_virt;
+    uint32_t index, this_level, bits_remaining, bits_at_this_level;
+    uint32_t leaf_shift = walk->page_size_log2 + walk->bits_per_level;
 
-    if (input_address >= (0x1ull << pgt_desc.ias))
+    if (walk->leaf_table != NULL && (input_address >> leaf_shift) == walk->leaf_va)
     {
-        ERROR("val_pe_mmu_map_add: input address size error \
-                        and truncating to %d-bits\n", pgt_desc.ias);
-        input_address &= ((0x1ull << pgt_desc.ias) - 1);
+        index = (input_address >> walk->page_size_log2) & ((0x1ul << walk->bits_per_level) - 1);
+        return &walk->leaf_table[index];
     }
 
+    tt_base_phys = walk->pgt_base;
+    this_level = 0;
+    bits_remaining = (walk->num_pgt_levels - 1) * walk->bits_per_level + walk->page_size_log2;
+    bits_at_this_level = walk->ias - bits_remaining;
+    tt_base_virt = (uint64_t *)tt_base_phys;
+
     while (1) {
         index = (input_address >> bits_remaining) & ((0x1ul << bits_at_this_level) - 1);
         table_desc = &tt_base_virt[index];
-        INFO("val_pe_mmu_map_add: this_level = %d     \n", this_level);
-        INFO("val_pe_mmu_map_add: index = %d     \n", index);
-        INFO("val_pe_mmu_map_add: table_desc at level %d at address 0x%lx = %lx     \n",
+        INFO_TRACE("val_pe_mmu_map_add: this_level = %d     \n", this_level);
+        INFO_TRACE("val_pe_mmu_map_add: index = %d     \n", index);
+        INFO_TRACE("val_pe_mmu_map_add: table_desc at level %d at address 0x%lx = %lx     \n",
             this_level, (uint64_t)table_desc, *table_desc);
-        if (this_level == (num_pgt_levels - 1))
-        {
-            *table_desc = PGT_ENTRY_PAGE_MASK | PGT_ENTRY_VALID_MASK;
-            *table_desc |= (output_address & ~(uint64_t)(page_size - 1));
-            *table_desc |= attr;
+        if (this_level == (walk->num_pgt_levels - 1))
             break;
-        }
         /* If a descriptor has no entry or is a block descriptor or the address
          * of the descriptor is un-initialized,
          * then populate it with the right address to be used from the free memory
@@ -492,35 +677,285 @@ uint32_t val_el3_add_mmu_entry(uint64_t arg0, uint64_t arg1, uint64_t arg2)
             free_pa = free_pa + SIZE_4KB;
             *table_desc = PGT_ENTRY_TABLE_MASK | PGT_ENTRY_VALID_MASK;
             tt_base_virt = (uint64_t *)tt_base_phys;
-            *table_desc |= (uint64_t)(tt_base_virt) & ~(page_size - 1);
+            *table_desc |= (uint64_t)(tt_base_virt) & ~(walk->page_size - 1);
             if (((val_el3_at_s1e3w((uint64_t)tt_base_virt)) & 0x1) == 0x1)
                 val_el3_add_mmu_entry((uint64_t)tt_base_virt,
                                       (uint64_t)tt_base_virt, NONSECURE_PAS);
             VERBOSE("val_pe_mmu_map_add: table_desc = %lx     \n", *table_desc);
             ++this_level;
-            bits_remaining -= bits_per_level;
-            bits_at_this_level = bits_per_level;
+            bits_remaining -= walk->bits_per_level;
+            bits_at_this_level = walk->bits_per_level;
             continue;
         }
-        if (IS_PGT_ENTRY_BLOCK(*table_desc))
-        {
-            *table_desc = PGT_ENTRY_PAGE_MASK | PGT_ENTRY_VALID_MASK;
-            *table_desc |= (output_address & ~(bits_remaining - 1));
-            *table_desc |= attr;
-            break;
-        }
 
-        tt_base_phys = *table_desc & (((0x1ull << (48 - page_size_log2)) - 1) << page_size_log2);
+        tt_base_phys = *table_desc & (((0x1ull << (48 - walk->page_size_log2)) - 1)
+                                      << walk->page_size_log2);
         tt_base_virt = (uint64_t *)tt_base_phys;
         ++this_level;
-        bits_remaining -= bits_per_level;
-        bits_at_this_level = bits_per_level;
+        bits_remaining -= walk->bits_per_level;
+        bits_at_this_level = walk->bits_per_level;
+    }
+
+    if (walk->num_pgt_levels > 1)
+    {
+        walk->leaf_table = tt_base_virt;
+        walk->leaf_va = input_address >> leaf_shift;
+    }
+    return table_desc;
+}
+
+/**
+  @brief   This function checks the output and input address against the translation
+           regime, truncating an oversized input address
+  @param   walk           - Walk context from val_el3_mmu_walk_init
+  @param   input_address  - Virtual Address, truncated to IAS bits if required
+  @param   output_address - Physical Address
+  @return  0 on Success and 1 on Failure
+**/
+static uint32_t val_el3_mmu_check_addr(mmu_walk_t *walk, uint64_t *input_address,
+                                       uint64_t output_address)
+{
+    if (output_address >= (0x1ull << walk->oas))
+    {
+        ERROR("val_pe_mmu_map_add: output address size error\n");
+        return 1;
     }
+
+    if (*input_address >= (0x1ull << walk->ias))
+    {
+        ERROR("val_pe_mmu_map_add: input address size error \
+                        and truncating to %d-bits\n", walk->ias);
+        *input_address &= ((0x1ull << walk->ias) - 1);
+    }
+    return 0;
+}
+
+/**
+  @brief   This function maps a passed Virtual Address to the mentioned
+           Physical Address and changes the Access PAS if it's required
+           1. Caller       -  Test Suite
+           2. Prerequisite -  None
+  @param   arg0 - Virtual Address needed for the MMU mapping
+  @param   arg1 - Physical Address needed to be mapped to the Virtual Address
+  @param   arg2 - Access PAS for the corresponding mapping if specified or NON_SECURE by default
+  @return  0 on Success and 1 on Failure
+**/
+uint32_t val_el3_add_mmu_entry(uint64_t arg0, uint64_t arg1, uint64_t arg2)
+{
+    uint64_t input_address = arg0;
+    uint64_t output_address, attr;
+    uint64_t *table_desc;
+    mmu_walk_t walk;
+
+    output_address = arg1;
+    attr = arg2;
+    INFO_TRACE("val_pe_mmu_map_add: Output Address = 0x%lx\n", output_address);
+    INFO_TRACE("val_pe_mmu_map_add: Input Address = 0x%lx\n", input_address);
+    INFO_TRACE("val_pe_mmu_map_add: Attribute = 0x%lx\n", attr);
+
+    val_el3_mmu_walk_init(&walk);
+    if (val_el3_mmu_check_addr(&walk, &input_address, output_address))
+        return 1;
+
+    table_desc = val_el3_mmu_walk(&walk, input_address);
+    *table_desc = PGT_ENTRY_PAGE_MASK | PGT_ENTRY_VALID_MASK;
+    *table_desc |= (output_address & ~(uint64_t)(walk.page_size - 1));
+    *table_desc |= attr;
+
     val_el3_cln_and_invldt_cache(table_desc);
-    INFO("val_pe_mmu_map_add: table_desc = %lx     \n", *table_desc);
+    INFO_TRACE("val_pe_mmu_map_add: table_desc = %lx     \n", *table_desc);
+    return 0;
+}
+
+/**
+  @brief   This function maps the list of {VA, PA, attr, size} descriptors passed in
+           shared_data->mmu_map. Each descriptor may span several granules. The
+           last level table is reused across neighbouring VAs, descriptors written
+           to the same table are cleaned once, and the caller issues a single TLB
+           invalidation for the whole batch.
+           1. Caller       -  Test Suite
+           2. Prerequisite -  shared_data->num_mmu_map and shared_data->mmu_map
+  @return  0 on Success and 1 on Failure
+**/
+uint32_t val_el3_add_mmu_entries(void)
+{
+    uint64_t num = shared_data->num_mmu_map, i, va, pa, end;
+    uint64_t *table_desc, *dirty_table = NULL, *dirty_lo = NULL, *dirty_hi = NULL;
+    MMU_MAP_DESC *desc;
+    mmu_walk_t walk;
+
+    if (num > MAX_MMU_MAP_DESC)
+    {
+        ERROR("val_el3_add_mmu_entries: %lu descriptors exceed the limit\n", num);
+        return 1;
+    }
+
+    val_el3_mmu_walk_init(&walk);
+
+    for (i = 0; i < num; i++)
+    {
+        desc = &shared_data->mmu_map[i];
+        va = desc->va & ~(walk.page_size - 1);
+        pa = desc->pa & ~(walk.page_size - 1);
+        end = desc->va + (desc->size ? desc->size : 1);
+        INFO_TRACE("val_el3_add_mmu_entries: VA = 0x%lx PA = 0x%lx size = 0x%lx\n",
+             desc->va, desc->pa, desc->size);
+
+        if (end < desc->va ||
+            val_el3_mmu_check_addr(&walk, &va, desc->pa + (end - 1 - desc->va)))
+            return 1;
+
+        for (; va < end; va += walk.page_size, pa += walk.page_size)
+        {
+            table_desc = val_el3_mmu_walk(&walk, va);
+            *table_desc = PGT_ENTRY_PAGE_MASK | PGT_ENTRY_VALID_MASK | pa | desc->attr;
+
+            if (walk.leaf_table == NULL) {
+                val_el3_cln_and_invldt_cache(table_desc);
+                continue;
+            }
+            if (walk.leaf_table != dirty_table)
+            {
+                if (dirty_table != NULL)
+                    val_el3_cln_and_invldt_cache_range(dirty_lo,
+                                (uint64_t)(dirty_hi - dirty_lo + 1) * sizeof(uint64_t));
+                dirty_table = walk.leaf_table;
+                dirty_lo = dirty_hi = table_desc;
+            }
+            dirty_lo = get_min(dirty_lo, table_desc);
+            dirty_hi = get_max(dirty_hi, table_desc);
+        }
+    }
+
+    if (dirty_table != NULL)
+        val_el3_cln_and_invldt_cache_range(dirty_lo,
+                                (uint64_t)(dirty_hi - dirty_lo + 1) * sizeof(uint64_t));
     return 0;
 }
 
+/**
+  @brief   This function returns the last level descriptor for a Virtual Address
+           without allocating tables. Returns NULL when the Virtual Address is not
+           mapped through a last level table.
+           1. Caller       -  release_windows
+  @param   walk          - Walk context from val_el3_mmu_walk_init
+  @param   input_address - Virtual Address to look up
+  @return  Pointer to the last level descriptor, NULL if there is none
+**/
+static uint64_t *val_el3_mmu_lookup(mmu_walk_t *walk, uint64_t input_address)
+{
+    uint64_t *table_desc, *tt_base_virt;
+    uint32_t index, this_level, bits_remaining, bits_at_this_level;
+    uint32_t leaf_shift = walk->page_size_log2 + walk->bits_per_level;
+
+    if (walk->leaf_table != NULL && (input_address >> leaf_shift) == walk->leaf_va)
+    {
+        index = (input_address >> walk->page_size_log2) & ((0x1ul << walk->bits_per_level) - 1);
+        return &walk->leaf_table[index];
+    }
+
+    this_level = 0;
+    bits_remaining = (walk->num_pgt_levels - 1) * walk->bits_per_level + walk->page_size_log2;
+    bits_at_this_level = walk->ias - bits_remaining;
+    tt_base_virt = (uint64_t *)walk->pgt_base;
+
+    while (1) {
+        index = (input_address >> bits_remaining) & ((0x1ul << bits_at_this_level) - 1);
+        table_desc = &tt_base_virt[index];
+        if (this_level == (walk->num_pgt_levels - 1))
+            break;
+
+        if (!(*table_desc & PGT_ENTRY_VALID_MASK) || IS_PGT_ENTRY_BLOCK(*table_desc))
+            return NULL;
+
+        tt_base_virt = (uint64_t *)(*table_desc & (((0x1ull << (48 - walk->page_size_log2)) - 1)
+                                                   << walk->page_size_log2));
+        ++this_level;
+        bits_remaining -= walk->bits_per_level;
+        bits_at_this_level = walk->bits_per_level;
+    }
+
+    if (walk->num_pgt_levels > 1)
+    {
+        walk->leaf_table = tt_base_virt;
+        walk->leaf_va = input_address >> leaf_shift;
+    }
+    return table_desc;
+}
+
+/**
+  @brief   This function tears down the test windows passed in shared_data->mmu_map.
+           A descriptor with a non-zero va invalidates the EL3 mappings of
+           [va, va + size). A descriptor with a non-zero pa returns the granules fully
+           covered by [pa, pa + size) to the GPI held in attr, after cleaning them to
+           the PoPA for every PAS. The caller issues a single TLB and GPT invalidation
+           for the whole batch.
+           1. Caller       -  Test infrastructure, at test end
+           2. Prerequisite -  shared_data->num_mmu_map and shared_data->mmu_map
+  @return  0 on Success and 1 on Failure
+**/
+uint32_t val_el3_release_windows(void)
+{
+    uint64_t num = shared_data->num_mmu_map, i, va, end, pa, pas;
+    uint64_t *table_desc;
+    uint32_t status = 0;
+    MMU_MAP_DESC *desc;
+    gpt_descriptor_t gpt_desc;
+    gpt_geometry_t geo;
+    mmu_walk_t walk;
+
+    if (num > MAX_MMU_MAP_DESC)
+    {
+        ERROR("val_el3_release_windows: %lu descriptors exceed the limit\n", num);
+        return 1;
+    }
+
+    val_el3_mmu_walk_init(&walk);
+    val_el3_get_gpt_geometry(&gpt_desc, &geo);
+
+    for (i = 0; i < num; i++)
+    {
+        desc = &shared_data->mmu_map[i];
+        INFO_TRACE("val_el3_release_windows: VA = 0x%lx PA = 0x%lx size = 0x%lx\n",
+             desc->va, desc->pa, desc->size);
+
+        if (desc->va)
+        {
+            end = desc->va + desc->size;
+            for (va = desc->va & ~(walk.page_size - 1); va < end; va += walk.page_size)
+            {
+                table_desc = val_el3_mmu_lookup(&walk, va);
+                if (table_desc == NULL || *table_desc == 0)
+                    continue;
+                *table_desc = 0;
+                val_el3_cln_and_invldt_cache(table_desc);
+            }
+        }
+
+        if (desc->pa)
+        {
+            /* Granules shared with a live window keep their GPI */
+            va = (desc->pa + (0x1ull << geo.p) - 1) & ~((0x1ull << geo.p) - 1);
+            end = (desc->pa + desc->size) & ~((0x1ull << geo.p) - 1);
+            if (end <= va)
+                continue;
+
+            /* Lines of any PAS must reach the PoPA before the granules change PAS */
+            for (pas = SECURE_PAS; pas <= REALM_PAS; pas++)
+            {
+                pa = val_el3_modify_desc(va, CIPOPA_NS_BIT, NS_SET(pas), 1);
+                pa = val_el3_modify_desc(pa, CIPOPA_NSE_BIT, NSE_SET(pas), 1);
+                val_el3_cmo_cipapa_range(pa, end - va);
+            }
+
+            if (val_el3_add_gpt_range(va, end - va, desc->attr))
+                status = 1;
+        }
+    }
+
+    return status;
+}
+
 uint64_t
 val_el3_modify_desc(uint64_t table_desc, uint8_t start_bit, uint64_t value_to_set, uint8_t num_bits)
 {
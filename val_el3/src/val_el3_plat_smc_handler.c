@@ -38,9 +38,15 @@ void plat_arm_acs_smc_handler(uint64_t services, uint64_t arg0, uint64_t arg1, u
 void plat_arm_acs_smc_handler(uint64_t services, uint64_t arg0, uint64_t arg1, uint64_t arg2)
 {
 
-  INFO("User SMC Call started for service = 0x%lx arg0 = 0x%lx arg1 = 0x%lx arg2 = 0x%lx \n",
+  INFO_TRACE("User SMC Call started for service = 0x%lx arg0 = 0x%lx arg1 = 0x%lx arg2 = 0x%lx \n",
         services, arg0, arg1, arg2);
 
+  if (shared_data == NULL) {
+    ERROR("No shared data slot for MPIDR 0x%lx, service 0x%lx dropped\n",
+          val_el3_read_mpidr(), services);
+    return;
+  }
+
   bool mapped = ((val_el3_at_s1e3w((uint64_t)shared_data)) & 0x1) != 0x1;
 
   if (mapped) {
@@ -51,16 +57,29 @@ void plat_arm_acs_smc_handler(uint64_t services, uint64_t arg0, uint64_t arg1, u
   switch (services)
   {
     case RME_INSTALL_HANDLER:
-      INFO("RME Handler Installing service \n");
+      INFO_TRACE("RME Handler Installing service \n");
       val_el3_rme_install_handler();
       break;
     case RME_ADD_GPT_ENTRY:
-      INFO("RME GPT mapping service \n");
+      INFO_TRACE("RME GPT mapping service \n");
       val_el3_add_gpt_entry(arg0, arg1);
       val_el3_tlbi_paallos();
       break;
+    case RME_ADD_GPT_RANGE:
+      INFO_TRACE("RME GPT range mapping service \n");
+      if (val_el3_add_gpt_range(arg0, arg1, arg2) == 0) {
+          val_el3_tlbi_paallos();
+      } else if (mapped) {
+          shared_data->status_code = 1;
+          const char *msg = "EL3: GPT range update failed";
+          int i = 0; while (msg[i] && i < sizeof(shared_data->error_msg) - 1) {
+              shared_data->error_msg[i] = msg[i]; i++;
+          }
+          shared_data->error_msg[i] = '\0';
+      }
+      break;
     case RME_ADD_MMU_ENTRY:
-      INFO("RME MMU mapping service \n");
+      INFO_TRACE("RME MMU mapping service \n");
       if (val_el3_add_mmu_entry(arg0, arg1, arg2) == 0) {
           val_el3_tlbi_vae3(arg0);
           shared_data->status_code = 0;
@@ -75,50 +94,101 @@ void plat_arm_acs_smc_handler(uint64_t services, uint64_t arg0, uint64_t arg1, u
           shared_data->error_msg[i] = '\0';
       }
       break;
+    case RME_ADD_MMU_ENTRIES:
+      INFO_TRACE("RME MMU batched mapping service \n");
+      if (val_el3_add_mmu_entries() == 0) {
+          val_el3_tlbi_alle3is();
+      } else {
+          /* Entries written before the failure must not stay cached */
+          val_el3_tlbi_alle3is();
+          shared_data->status_code = 1;
+          const char *msg = "EL3: MMU batched mapping failed";
+          int i = 0; while (msg[i] && i < sizeof(shared_data->error_msg) - 1) {
+              shared_data->error_msg[i] = msg[i]; i++;
+          }
+          shared_data->error_msg[i] = '\0';
+      }
+      break;
+    case RME_RELEASE_WINDOWS:
+      INFO_TRACE("RME test window release service \n");
+      if (val_el3_release_windows() == 0) {
+          val_el3_tlbi_alle3is();
+          val_el3_tlbi_paallos();
+      } else {
+          /* Entries cleared before the failure must not stay cached */
+          val_el3_tlbi_alle3is();
+          val_el3_tlbi_paallos();
+          shared_data->status_code = 1;
+          const char *msg = "EL3: Test window release failed";
+          int i = 0; while (msg[i] && i < sizeof(shared_data->error_msg) - 1) {
+              shared_data->error_msg[i] = msg[i]; i++;
+          }
+          shared_data->error_msg[i] = '\0';
+      }
+      break;
+    case RME_PROBE_MATRIX:
+      INFO_TRACE("RME probe matrix service \n");
+      if (val_el3_probe_matrix((PROBE_MATRIX *)arg0)) {
+          shared_data->status_code = 1;
+          const char *msg = "EL3: Probe matrix mapping failed";
+          int i = 0; while (msg[i] && i < sizeof(shared_data->error_msg) - 1) {
+              shared_data->error_msg[i] = msg[i]; i++;
+          }
+          shared_data->error_msg[i] = '\0';
+      }
+      break;
+    case RME_MEM_POOL_STATS:
+      INFO_TRACE("RME memory pool statistics service \n");
+      val_el3_memory_pool_stats((MEM_POOL_STATS *)arg0);
+      break;
     case RME_MAP_SHARED_MEM:
       val_el3_map_shared_mem(arg0);
       break;
+    case RME_READ_EL3_LOG:
+      INFO_TRACE("RME EL3 log read service \n");
+      val_el3_log_read((EL3_LOG_RING *)arg0);
+      break;
     case RME_CMO_POPA:
-      INFO("RME CMO to PoPA service \n");
+      INFO_TRACE("RME CMO to PoPA service \n");
       arg0 = val_el3_modify_desc(arg0, CIPOPA_NS_BIT, NS_SET(arg1), 1);
       arg0 = val_el3_modify_desc(arg0, CIPOPA_NSE_BIT, NSE_SET(arg1), 1);
       val_el3_cmo_cipapa(arg0);
       break;
     case RME_ACCESS_MUT:
-      INFO("RME MEMORY ACCESS SERVICE\n");
+      INFO_TRACE("RME MEMORY ACCESS SERVICE\n");
       val_el3_access_mut();
       break;
     case RME_DATA_CACHE_OPS:
-      INFO("RME data cache maintenance operation service \n");
+      INFO_TRACE("RME data cache maintenance operation service \n");
       val_el3_data_cache_ops_by_va(arg0, arg1);
       break;
     case RME_MEM_SET:
-      INFO("RME memory write service\n");
+      INFO_TRACE("RME memory write service\n");
       val_el3_memory_set((uint64_t *)arg0, arg1, arg2);
       break;
     case RME_NS_ENCRYPTION:
-      INFO("RME Non-secure Encryption Enable/Disable service\n");
+      INFO_TRACE("RME Non-secure Encryption Enable/Disable service\n");
       if (arg0 == SET)
         val_el3_enable_ns_encryption();
       else
         val_el3_disable_ns_encryption();
       break;
     case RME_READ_AND_CMPR_REG_MSD:
-      INFO("RME Registers Read and Compare service\n");
+      INFO_TRACE("RME Registers Read and Compare service\n");
       if (arg0 == SET) {
         val_el3_pe_reg_list_cmp_msd();
-        INFO("Register comparision\n");
+        INFO_TRACE("Register comparision\n");
       } else {
         val_el3_pe_reg_read_msd();
-        INFO("Register read\n");
+        INFO_TRACE("Register read\n");
       }
       break;
     case LEGACY_TZ_ENABLE:
-      INFO("Legacy System Service\n");
+      INFO_TRACE("Legacy System Service\n");
       val_el3_prog_legacy_tz(arg0);
       break;
     case ROOT_WATCHDOG:
-      INFO("Root watchdog service \n");
+      INFO_TRACE("Root watchdog service \n");
       if (shared_data->generic_flag) {
         val_el3_set_daif();
         shared_data->exception_expected = SET;
@@ -128,26 +198,26 @@ void plat_arm_acs_smc_handler(uint64_t services, uint64_t arg0, uint64_t arg1, u
       shared_data->generic_flag = CLEAR;
       break;
     case PAS_FILTER_SERVICE:
-      INFO("PAS filter mode service \n");
+      INFO_TRACE("PAS filter mode service \n");
       val_el3_pas_filter_active_mode(arg0);
       break;
     case SMMU_ROOT_SERVICE:
-      INFO("ROOT SMMU service \n");
+      INFO_TRACE("ROOT SMMU service \n");
       if (arg1)
         val_el3_smmu_access_enable(arg0);
       else
         val_el3_smmu_access_disable(arg0);
       break;
     case SEC_STATE_CHANGE:
-      INFO("Security STte change service \n");
+      INFO_TRACE("Security STte change service \n");
       val_el3_security_state_change(arg0);
       break;
     case SMMU_CONFIG_SERVICE:
-      INFO("SMMU ROOT Register Configuration validate \n");
+      INFO_TRACE("SMMU ROOT Register Configuration validate \n");
       val_el3_smmu_root_config_service(arg0, arg1, arg2);
       break;
     case RME_PGT_CREATE:
-      INFO("RME pgt_create service \n");
+      INFO_TRACE("RME pgt_create service \n");
       if (val_el3_realm_pgt_create((memory_region_descriptor_t *)arg0,
                                    (pgt_descriptor_t *) arg1) != 0)
       {
@@ -160,22 +230,33 @@ void plat_arm_acs_smc_handler(uint64_t services, uint64_t arg0, uint64_t arg1, u
       }
       break;
     case RME_PGT_DESTROY:
-      INFO("RME pgt_destroy service \n");
+      INFO_TRACE("RME pgt_destroy service \n");
       val_el3_realm_pgt_destroy((pgt_descriptor_t *) arg0);
       break;
     case MEC_SERVICE:
-      INFO("MEC Service");
+      INFO_TRACE("MEC Service");
       val_el3_mec_service(arg0, arg1, arg2);
       break;
     case RME_CMO_POE:
-      INFO("RME CMO to PoE service \n");
+      INFO_TRACE("RME CMO to PoE service \n");
       arg0 = val_el3_modify_desc(arg0, CIPAE_NS_BIT, 1, 1);
       arg0 = val_el3_modify_desc(arg0, CIPAE_NSE_BIT, 1, 1);
       val_el3_cmo_cipae(arg0);
       break;
+    case RME_CMO_RANGE:
+      INFO_TRACE("RME CMO range service \n");
+      if (val_el3_cmo_range(arg0, arg1, arg2)) {
+          shared_data->status_code = 1;
+          const char *msg = "EL3: CMO range operation failed";
+          int i = 0; while (msg[i] && i < sizeof(shared_data->error_msg) - 1) {
+              shared_data->error_msg[i] = msg[i]; i++;
+          }
+          shared_data->error_msg[i] = '\0';
+      }
+      break;
     case RME_READ_CNTPCT:
       uintptr_t base = (uintptr_t)arg0;
-      INFO("EL3: CNTCTL base = 0x%lx\n", (unsigned long)base);
+      INFO_TRACE("EL3: CNTCTL base = 0x%lx\n", (unsigned long)base);
       {
         uint32_t cntcr = *(volatile uint32_t *)(base + CNTCR_OFFSET);
         cntcr |= (CNTCR_EN | CNTCR_HDBG);
@@ -183,7 +264,7 @@ void plat_arm_acs_smc_handler(uint64_t services, uint64_t arg0, uint64_t arg1, u
       }
       /* Robust 64-bit read of CNTCV */
       uint64_t full = el3_read_cntcv_robust(base);
-      INFO("EL3: CNTCV (64-bit) = 0x%lx\n", (unsigned long)full);
+      INFO_TRACE("EL3: CNTCV (64-bit) = 0x%lx\n", (unsigned long)full);
       if (mapped) {
         shared_data->shared_data_access[0].data = full;
         shared_data->status_code = 0;
@@ -202,7 +283,7 @@ void plat_arm_acs_smc_handler(uint64_t services, uint64_t arg0, uint64_t arg1, u
           shared_data->error_code  = 0;
           shared_data->error_msg[0] = '\0';
         }
-        INFO("CNTID: FEAT_CNTSC not implemented (RES0)\n");
+        INFO_TRACE("CNTID: FEAT_CNTSC not implemented (RES0)\n");
       } 
       else if ((cntid & 0xF) == 0x1) {
         if (mapped) {
@@ -211,7 +292,7 @@ void plat_arm_acs_smc_handler(uint64_t services, uint64_t arg0, uint64_t arg1, u
           shared_data->error_code  = 0;
           shared_data->error_msg[0] = '\0';
         }
-        INFO("CNTID: CNTSC implemented (0x%x)\n", cntid & 0xF);
+        INFO_TRACE("CNTID: CNTSC implemented (0x%x)\n", cntid & 0xF);
       } 
       else {
         shared_data->status_code = 1;
@@ -222,7 +303,7 @@ void plat_arm_acs_smc_handler(uint64_t services, uint64_t arg0, uint64_t arg1, u
       }
       break;
     case SEC_TIMER_SERVICE:
-      INFO("Secure timer (CNTPS) service \n");
+      INFO_TRACE("Secure timer (CNTPS) service \n");
       if (arg0 == CNTPS_PROGRAM) {
         int rc = el3_cntps_program_ticks(arg1);
         if (mapped) { 
@@ -251,7 +332,7 @@ void plat_arm_acs_smc_handler(uint64_t services, uint64_t arg0, uint64_t arg1, u
       }
       break;
     case SMC_FID_GET_SCR_EL3:
-      INFO("SCR_EL3 read service\n");
+      INFO_TRACE("SCR_EL3 read service\n");
       uint64_t scrv = val_el3_read_scr_el3();
       if (mapped) {
         shared_data->shared_data_access[0].data = scrv;  /* return value */
@@ -261,7 +342,7 @@ void plat_arm_acs_smc_handler(uint64_t services, uint64_t arg0, uint64_t arg1, u
       }
       break;
     case SMC_FID_UPDATE_SCR_EL3:
-      INFO("SCR_EL3 update service (set_bits/clear_bits)\n");
+      INFO_TRACE("SCR_EL3 update service (set_bits/clear_bits)\n");
       uint64_t set_bits   = arg0;   /* NOTE: using arg0/arg1 exactly as your pal_* APIs */
       uint64_t clear_bits = arg1;
       uint64_t oldv = val_el3_read_scr_el3();
@@ -284,7 +365,7 @@ void plat_arm_acs_smc_handler(uint64_t services, uint64_t arg0, uint64_t arg1, u
       }
       break;
     case SMMU_READ_CFG_BANK:
-      INFO("SMMU banked cfg read service \n");
+      INFO_TRACE("SMMU banked cfg read service \n");
       {
         uint32_t smmu_idx = UNPACK_IDX(arg1);  /* top 32 bits of arg1 */
         uint32_t reg_off  = UNPACK_OFF(arg1);  /* low  32 bits of arg1: SMMUv3 Page0 offset */
@@ -308,7 +389,11 @@ void plat_arm_acs_smc_handler(uint64_t services, uint64_t arg0, uint64_t arg1, u
         }
         shared_data->error_msg[i] = '\0';
       }
-      INFO(" Service not present\n");
+      INFO_TRACE(" Service not present\n");
       break;
   }
+
+  /* Reading the ring is not recorded, so it does not evict the events of the test */
+  if (services != RME_READ_EL3_LOG)
+    val_el3_log_event(services, arg0, arg1, arg2, mapped ? shared_data->status_code : 0);
 }
@@ -61,6 +61,10 @@ BITFIELD_DECL(uint64_t, STRTAB_STE_2_VTCR_S2TG, 15, 14)
 BITFIELD_DECL(uint64_t, STRTAB_STE_2_VTCR_S2PS, 18, 16)
 BITFIELD_DECL(uint64_t, CMDQ_0_OP, 7, 0)
 BITFIELD_DECL(uint64_t, CMDQ_CFGI_1_RANGE, 4, 0)
+BITFIELD_DECL(uint64_t, CMDQ_SYNC_0_CS, 13, 12)
+BITFIELD_DECL(uint64_t, CMDQ_SYNC_0_MSH, 23, 22)
+BITFIELD_DECL(uint64_t, CMDQ_SYNC_0_MSIATTR, 27, 24)
+BITFIELD_DECL(uint64_t, CMDQ_SYNC_0_MSIDATA, 63, 32)
 BITFIELD_DECL(uint64_t, CDTAB_L1_DESC_L2PTR, 51, 12)
 BITFIELD_DECL(uint64_t, CDTAB_CD_0_TCR_T0SZ, 5, 0)
 BITFIELD_DECL(uint64_t, CDTAB_CD_0_TCR_TG0, 7, 6)
@@ -84,12 +88,25 @@ smmu_dev_t *g_smmu;
 uint32_t g_num_smmus;
 uint32_t g_sid;
 
-struct smmu_master_node {
-    smmu_master_t *master;
-    struct smmu_master_node *next;
-};
+/* Masters are kept in an open addressed table keyed by (SMMU index, SID), linear probing */
+#define SMMU_MASTER_TABLE_SIZE 128  /* Power of two */
+#define SMMU_MASTER_MAX_LIVE   (SMMU_MASTER_TABLE_SIZE * 3 / 4)
+
+typedef enum {
+    SMMU_MASTER_SLOT_FREE = 0,
+    SMMU_MASTER_SLOT_USED,
+    SMMU_MASTER_SLOT_DELETED
+} smmu_master_slot_state_t;
+
+typedef struct {
+    uint32_t state;
+    uint32_t smmu_index;
+    smmu_master_t master;
+} smmu_master_slot_t;
 
-struct smmu_master_node *g_smmu_master_list_head = NULL;
+/* Allocated from the EL3 pool on first use, records are reused after unmap */
+static smmu_master_slot_t *g_smmu_master_table;
+static uint32_t g_smmu_master_live;
 
 static uint64_t align_to_size(uint64_t addr,  uint64_t size)
 {
@@ -148,110 +165,189 @@ static int smmu_cmdq_build_cmd(uint64_t *cmd, uint8_t opcode)
     return 0;
 }
 
-static int smmu_cmdq_write_cmd(smmu_dev_t *smmu, uint64_t *cmd)
+/* CNTPCT value SMMU_POLL_TIMEOUT_US from now */
+static uint64_t smmu_poll_deadline(void)
 {
-    uint32_t timeout = SMMU_CMDQ_POLL_TIMEOUT;
-    int ret = 0, i;
-    uint64_t *cmd_dst;
-    smmu_queue_type_t *cmdq = &smmu->cmd_type;
+    return val_el3_read_cntpct() + (val_el3_read_cntfrq() * SMMU_POLL_TIMEOUT_US) / 1000000;
+}
 
+static void smmu_cmdq_poll_until_consumed(smmu_dev_t *smmu)
+{
+    uint64_t deadline = smmu_poll_deadline();
+    smmu_queue_type_t *cmdq = &smmu->cmd_type;
     smmu_queue_t queue = {
-                .log2nent = cmdq->queue.log2nent,
+                .log2nent = smmu->cmd_type.queue.log2nent,
+                .prod = val_el3_mmio_read((uint64_t)smmu->cmd_type.prod_reg),
+                .cons = val_el3_mmio_read((uint64_t)smmu->cmd_type.cons_reg)
             };
 
-    while (smmu_queue_full(&cmdq->queue) && timeout)
-        timeout--;
+    while (!smmu_queue_empty(&queue)) {
+        if (val_el3_read_cntpct() > deadline)
+            break;
+        queue.cons = val_el3_mmio_read((uint64_t)cmdq->cons_reg);
+    }
 
-    if (!timeout) {
-        ERROR("\n      SMMU CMD queue is full     ");
-        return -1;
+    if (!smmu_queue_empty(&queue)) {
+        ERROR("\n    CMDQ poll timeout at 0x%08x     ", queue.prod);
+        ERROR("\n    prod_reg = 0x%08x     ", val_el3_mmio_read((uint64_t)smmu->cmd_type.prod_reg));
+        ERROR("\n    cons_reg = 0x%08x     ", val_el3_mmio_read((uint64_t)smmu->cmd_type.cons_reg));
+        ERROR("\n    gerror   = 0x%08x     ", val_el3_mmio_read(smmu->base + SMMU_R_GERROR));
     }
+}
 
-    queue.prod = val_el3_mmio_read((uint64_t)cmdq->prod_reg);
-    cmd_dst = (uint64_t *)(cmdq->base +
-              ((queue.prod & ((0x1ull << queue.log2nent) - 1)) *
-              (cmdq->entry_size)));
-    for (i = 0; i < QUEUE_DWORDS_PER_ENT; ++i)
-        cmd_dst[i] = cmd[i];
-    queue.prod = smmu_cmdq_inc_prod(&queue);
+static void smmu_cmdq_batch_init(smmu_dev_t *smmu, smmu_cmdq_batch_t *batch)
+{
+    smmu_queue_type_t *cmdq = &smmu->cmd_type;
+
+    batch->smmu = smmu;
+    batch->queue.log2nent = cmdq->queue.log2nent;
+    batch->queue.prod = val_el3_mmio_read((uint64_t)cmdq->prod_reg);
+    batch->queue.cons = val_el3_mmio_read((uint64_t)cmdq->cons_reg);
+    batch->pending = 0;
+}
+
+/* Publish all staged commands to the SMMU with a single PROD write */
+static void smmu_cmdq_batch_publish(smmu_cmdq_batch_t *batch)
+{
+    if (!batch->pending)
+        return;
 
     val_el3_mem_barrier();
-    val_el3_mmio_write((uint64_t)cmdq->prod_reg, queue.prod);
+    val_el3_mmio_write((uint64_t)batch->smmu->cmd_type.prod_reg, batch->queue.prod);
+    batch->pending = 0;
+}
 
-    return ret;
+static uint64_t *smmu_cmdq_batch_slot(smmu_cmdq_batch_t *batch)
+{
+    uint64_t deadline;
+    smmu_queue_type_t *cmdq = &batch->smmu->cmd_type;
+
+    /* CONS is only read again once the staged commands have filled the queue */
+    if (smmu_queue_full(&batch->queue)) {
+        smmu_cmdq_batch_publish(batch);
+        deadline = smmu_poll_deadline();
+        while (smmu_queue_full(&batch->queue) && (val_el3_read_cntpct() <= deadline))
+            batch->queue.cons = val_el3_mmio_read((uint64_t)cmdq->cons_reg);
+
+        if (smmu_queue_full(&batch->queue)) {
+            ERROR("\n      SMMU CMD queue is full     ");
+            return NULL;
+        }
+    }
+
+    return (uint64_t *)(cmdq->base +
+           ((batch->queue.prod & ((0x1ull << batch->queue.log2nent) - 1)) *
+           (cmdq->entry_size)));
 }
 
-static int smmu_cmdq_issue_cmd(smmu_dev_t *smmu,
-                   uint8_t opcode)
+static int smmu_cmdq_batch_add(smmu_cmdq_batch_t *batch, uint8_t opcode)
 {
-    uint64_t cmd[QUEUE_DWORDS_PER_ENT];
+    uint64_t *cmd;
+
+    cmd = smmu_cmdq_batch_slot(batch);
+    if (!cmd)
+        return -1;
 
     if (smmu_cmdq_build_cmd(cmd, opcode))
         return -1;
 
-    return smmu_cmdq_write_cmd(smmu, cmd);
+    batch->queue.prod = smmu_cmdq_inc_prod(&batch->queue);
+    batch->pending++;
+    return 0;
 }
 
-static void smmu_cmdq_poll_until_consumed(smmu_dev_t *smmu)
+/**
+  @brief Close the batch with a single CMD_SYNC, publish it and wait for the
+         SMMU to complete every staged command. When the SMMU supports MSIs
+         the CMD_SYNC writes a sequence number to memory, which is polled
+         instead of the CONS register.
+  @param batch - staged commands
+  @return 0 on success, -1 on timeout
+**/
+static int smmu_cmdq_batch_submit(smmu_cmdq_batch_t *batch)
 {
-    uint32_t timeout = SMMU_CMDQ_POLL_TIMEOUT;
+    uint64_t deadline;
+    smmu_dev_t *smmu = batch->smmu;
     smmu_queue_type_t *cmdq = &smmu->cmd_type;
-    smmu_queue_t queue = {
-                .log2nent = smmu->cmd_type.queue.log2nent,
-                .prod = val_el3_mmio_read((uint64_t)smmu->cmd_type.prod_reg),
-                .cons = val_el3_mmio_read((uint64_t)smmu->cmd_type.cons_reg)
-            };
+    uint32_t seq = 0;
+    uint64_t *cmd;
 
-    while (timeout > 0) {
-        if (smmu_queue_empty(&queue))
-            break;
-        queue.cons = val_el3_mmio_read((uint64_t)cmdq->cons_reg);
-        timeout--;
+    cmd = smmu_cmdq_batch_slot(batch);
+    if (!cmd || smmu_cmdq_build_cmd(cmd, CMDQ_OP_CMD_SYNC))
+        return -1;
+
+    if (smmu->supported.msi) {
+        seq = ++cmdq->sync_seq;
+        cmd[0] |= BITFIELD_SET(CMDQ_SYNC_0_CS, CMDQ_SYNC_0_CS_IRQ) |
+                  BITFIELD_SET(CMDQ_SYNC_0_MSH, SMMU_SH_ISH) |
+                  BITFIELD_SET(CMDQ_SYNC_0_MSIATTR, CMDQ_SYNC_MSIATTR_OIWB) |
+                  BITFIELD_SET(CMDQ_SYNC_0_MSIDATA, seq);
+        cmd[1] |= cmdq->sync_phys & CMDQ_SYNC_1_MSIADDR_MASK;
     }
 
-    if (!timeout) {
-        ERROR("\n    CMDQ poll timeout at 0x%08x     ", queue.prod);
-        ERROR("\n    prod_reg = 0x%08x     ", val_el3_mmio_read((uint64_t)smmu->cmd_type.prod_reg));
-        ERROR("\n    cons_reg = 0x%08x     ", val_el3_mmio_read((uint64_t)smmu->cmd_type.cons_reg));
-        ERROR("\n    gerror   = 0x%08x     ", val_el3_mmio_read(smmu->base + SMMU_R_GERROR));
+    batch->queue.prod = smmu_cmdq_inc_prod(&batch->queue);
+    batch->pending++;
+    smmu_cmdq_batch_publish(batch);
+
+    if (!smmu->supported.msi) {
+        smmu_cmdq_poll_until_consumed(smmu);
+        return 0;
     }
+
+    deadline = smmu_poll_deadline();
+    do {
+        val_el3_invalidate_cache((uint64_t *)cmdq->sync_ptr);
+        if (*(volatile uint32_t *)cmdq->sync_ptr == seq)
+            return 0;
+    } while (val_el3_read_cntpct() <= deadline);
+
+    ERROR("\n    CMD_SYNC timeout, seq 0x%08x     ", seq);
+    ERROR("\n    prod_reg = 0x%08x     ", val_el3_mmio_read((uint64_t)cmdq->prod_reg));
+    ERROR("\n    cons_reg = 0x%08x     ", val_el3_mmio_read((uint64_t)cmdq->cons_reg));
+    ERROR("\n    gerror   = 0x%08x     ", val_el3_mmio_read(smmu->base + SMMU_R_GERROR));
+    return -1;
 }
 
-static void smmu_tlbi_cached_ste(smmu_dev_t *smmu)
+static void smmu_tlbi_cached_ste(smmu_cmdq_batch_t *batch)
 {
     /* Invalidate any cached configuration */
-    smmu_cmdq_issue_cmd(smmu, CMDQ_OP_CFGI_STE);
-    smmu_cmdq_issue_cmd(smmu, CMDQ_OP_CMD_SYNC);
-
-    smmu_cmdq_poll_until_consumed(smmu);
+    smmu_cmdq_batch_add(batch, CMDQ_OP_CFGI_STE);
 }
 
-static void smmu_tlbi_prefetch_cfg(smmu_dev_t *smmu)
+static void smmu_tlbi_prefetch_cfg(smmu_cmdq_batch_t *batch)
 {
     /* Invalidate any cached configuration */
-    smmu_cmdq_issue_cmd(smmu, CMDQ_OP_CFGI_STE);
-
-    smmu_cmdq_poll_until_consumed(smmu);
+    smmu_cmdq_batch_add(batch, CMDQ_OP_CFGI_STE);
 }
 
 void smmu_dpti_all(smmu_dev_t *smmu)
 {
-    smmu_cmdq_issue_cmd(smmu, 0x70);
+    smmu_cmdq_batch_t batch;
+
+    smmu_cmdq_batch_init(smmu, &batch);
+    smmu_cmdq_batch_add(&batch, CMDQ_OP_DPTI_ALL);
+    smmu_cmdq_batch_publish(&batch);
 }
 
-static void smmu_tlbi_cfgi(smmu_dev_t *smmu)
+static void smmu_tlbi_cfgi_stage(smmu_cmdq_batch_t *batch)
 {
     /* Invalidate any cached configuration */
-    smmu_cmdq_issue_cmd(smmu, CMDQ_OP_CFGI_ALL);
-    if (smmu->supported.hyp)
-        smmu_cmdq_issue_cmd(smmu, CMDQ_OP_TLBI_EL2_ALL);
-    smmu_cmdq_issue_cmd(smmu, CMDQ_OP_TLBI_NSNH_ALL);
-    smmu_cmdq_issue_cmd(smmu, CMDQ_OP_CMD_SYNC);
+    smmu_cmdq_batch_add(batch, CMDQ_OP_CFGI_ALL);
+    if (batch->smmu->supported.hyp)
+        smmu_cmdq_batch_add(batch, CMDQ_OP_TLBI_EL2_ALL);
+    smmu_cmdq_batch_add(batch, CMDQ_OP_TLBI_NSNH_ALL);
+}
+
+static void smmu_tlbi_cfgi(smmu_dev_t *smmu)
+{
+    smmu_cmdq_batch_t batch;
 
-    smmu_cmdq_poll_until_consumed(smmu);
+    smmu_cmdq_batch_init(smmu, &batch);
+    smmu_tlbi_cfgi_stage(&batch);
+    smmu_cmdq_batch_submit(&batch);
 }
 
-static void smmu_strtab_write_ste(smmu_master_t *master, uint64_t *ste, smmu_dev_t *smmu)
+static void smmu_strtab_write_ste(smmu_master_t *master, uint64_t *ste, smmu_cmdq_batch_t *batch)
 {
     uint64_t val = STRTAB_STE_0_V;
     smmu_stage2_config_t *stage2_cfg = NULL;
@@ -318,10 +414,13 @@ static void smmu_strtab_write_ste(smmu_master_t *master, uint64_t *ste, smmu_dev
     }
 
     ste[0] = val;
-    smmu_tlbi_cached_ste(smmu);
+    if (!batch)
+        return;
+
+    smmu_tlbi_cached_ste(batch);
 
     /* Issue a PREFETCH command so that new config for SID is fetched by SMMU */
-    smmu_tlbi_prefetch_cfg(smmu);
+    smmu_tlbi_prefetch_cfg(batch);
 
 }
 
@@ -345,7 +444,7 @@ static uint32_t smmu_strtab_init_linear(smmu_dev_t *smmu)
                            BITFIELD_SET(STRTAB_BASE_CFG_LOG2SIZE, smmu->sid_bits);
 
     for (ste = cfg->strtab64, i = 0; i < cfg->l1_ent_count; ++i, ste += STRTAB_STE_DWORDS)
-        smmu_strtab_write_ste(NULL, ste, smmu);
+        smmu_strtab_write_ste(NULL, ste, NULL);
     return 1;
 }
 
@@ -399,6 +498,16 @@ static uint32_t smmu_cmd_queue_init(smmu_dev_t *smmu)
                        BITFIELD_SET(QUEUE_BASE_LOG2SIZE, cmdq->queue.log2nent);
 
     cmdq->queue.prod = cmdq->queue.cons = 0;
+
+    /* CMD_SYNC completion word, written by the SMMU through an MSI */
+    if (smmu->supported.msi) {
+        cmdq->sync_ptr = val_el3_memory_calloc(1, sizeof(uint64_t), sizeof(uint64_t));
+        if (cmdq->sync_ptr)
+            cmdq->sync_phys = (uint64_t)val_el3_memory_virt_to_phys(cmdq->sync_ptr);
+        else
+            smmu->supported.msi = 0;
+    }
+    cmdq->sync_seq = 0;
     return 1;
 }
 
@@ -458,7 +567,7 @@ static int smmu_strtab_init_level2(smmu_dev_t *smmu, uint32_t sid)
     desc->l2desc_phys = align_to_size((uint64_t)val_el3_memory_virt_to_phys(desc->l2ptr), size);
     desc->l2desc64 = (uint64_t *)align_to_size((uint64_t)desc->l2ptr, size);
     for (ste = desc->l2desc64, i = 0; i < (1 << STRTAB_SPLIT); ++i, ste += STRTAB_STE_DWORDS)
-        smmu_strtab_write_ste(NULL, ste, smmu);
+        smmu_strtab_write_ste(NULL, ste, NULL);
 
     smmu_strtab_write_level1_desc(strtab, desc);
     return 1;
@@ -537,16 +646,17 @@ static uint32_t smmu_strtab_init(smmu_dev_t *smmu)
 int32_t smmu_reg_write_sync(smmu_dev_t *smmu, uint32_t val,
                    uint32_t reg_off, uint32_t ack_off)
 {
-    uint64_t timeout = 0x1000000;
+    uint64_t deadline;
     uint32_t reg;
 
     val_el3_mmio_write(smmu->base + reg_off, val);
 
-    while (timeout--) {
+    deadline = smmu_poll_deadline();
+    do {
         reg = val_el3_mmio_read(smmu->base + ack_off);
         if (reg == val)
             return 0;
-    }
+    } while (val_el3_read_cntpct() <= deadline);
 
     return 1;
 }
@@ -712,6 +822,9 @@ static uint32_t smmu_probe(smmu_dev_t *smmu)
     if (idr0 & IDR0_HYP)
         smmu->supported.hyp = 1;
 
+    if (idr0 & IDR0_MSI)
+        smmu->supported.msi = 1;
+
     if (idr0 & IDR0_S1P)
         smmu->supported.s1p = 1;
 
@@ -947,31 +1060,111 @@ static int smmu_cdtab_alloc(smmu_master_t *master)
     return 1;
 }
 
-smmu_master_t *smmu_master_at(uint32_t sid)
+static uint32_t smmu_master_hash(uint32_t smmu_index, uint32_t sid)
+{
+    uint64_t key = ((uint64_t)smmu_index << 32) | sid;
+
+    key *= 0x9E3779B97F4A7C15ull;
+    return (uint32_t)(key >> 32) & (SMMU_MASTER_TABLE_SIZE - 1);
+}
+
+/**
+  @brief  Look up the master record of a stream.
+  @param  smmu_index - index of the SMMU the stream belongs to
+  @param  sid        - stream id
+  @return table slot of the master, NULL if the stream has none
+**/
+static smmu_master_slot_t *smmu_master_find(uint32_t smmu_index, uint32_t sid)
+{
+    smmu_master_slot_t *slot;
+    uint32_t idx, probe;
+
+    if (g_smmu_master_table == NULL)
+        return NULL;
+
+    idx = smmu_master_hash(smmu_index, sid);
+    for (probe = 0; probe < SMMU_MASTER_TABLE_SIZE; probe++)
+    {
+        slot = &g_smmu_master_table[(idx + probe) & (SMMU_MASTER_TABLE_SIZE - 1)];
+        if (slot->state == SMMU_MASTER_SLOT_FREE)
+            return NULL;
+        if (slot->state == SMMU_MASTER_SLOT_USED && slot->smmu_index == smmu_index &&
+            slot->master.sid == sid)
+            return slot;
+    }
+
+    return NULL;
+}
+
+/**
+  @brief  Return the master record of a stream, taking a zeroed record when the
+          stream has none yet.
+  @param  smmu_index - index of the SMMU the stream belongs to
+  @param  sid        - stream id
+  @return master record, NULL if the table is full or cannot be allocated
+**/
+static smmu_master_t *smmu_master_at(uint32_t smmu_index, uint32_t sid)
 {
-    struct smmu_master_node *node = g_smmu_master_list_head;
+    smmu_master_slot_t *slot, *reuse = NULL;
+    uint32_t idx, probe;
+
+    slot = smmu_master_find(smmu_index, sid);
+    if (slot != NULL)
+        return &slot->master;
 
-    while (node != NULL)
+    if (g_smmu_master_table == NULL)
     {
-        if (node->master->sid == sid)
-            return node->master;
-        node = node->next;
+        g_smmu_master_table = val_el3_memory_calloc(SMMU_MASTER_TABLE_SIZE,
+                                                    sizeof(smmu_master_slot_t), BYTES_PER_DWORD);
+        if (g_smmu_master_table == NULL)
+            return NULL;
     }
-    node = val_el3_memory_alloc(sizeof(struct smmu_master_node), BYTES_PER_DWORD);
-    if (node == NULL)
-        return NULL;
 
-    node->master = val_el3_memory_calloc(1, sizeof(smmu_master_t), BYTES_PER_DWORD);
-    if (node->master == NULL)
+    if (g_smmu_master_live >= SMMU_MASTER_MAX_LIVE)
     {
-        val_el3_memory_free(node);
+        ERROR("\n      smmu_master_at: master table full     ");
         return NULL;
     }
 
-    node->next = g_smmu_master_list_head;
-    g_smmu_master_list_head = node;
+    /* First deleted or free slot of the probe sequence, the lookup above missed */
+    idx = smmu_master_hash(smmu_index, sid);
+    for (probe = 0; probe < SMMU_MASTER_TABLE_SIZE; probe++)
+    {
+        reuse = &g_smmu_master_table[(idx + probe) & (SMMU_MASTER_TABLE_SIZE - 1)];
+        if (reuse->state != SMMU_MASTER_SLOT_USED)
+            break;
+    }
 
-    return node->master;
+    val_el3_memory_set(&reuse->master, sizeof(smmu_master_t), 0);
+    reuse->state = SMMU_MASTER_SLOT_USED;
+    reuse->smmu_index = smmu_index;
+    reuse->master.sid = sid;
+    g_smmu_master_live++;
+
+    return &reuse->master;
+}
+
+/**
+  @brief  Release the master record of a stream. Deleted slots followed by a free
+          one are freed as well, so probe sequences stay short across map/unmap.
+  @param  slot - table slot returned by smmu_master_find
+  @return void
+**/
+static void smmu_master_remove(smmu_master_slot_t *slot)
+{
+    uint32_t idx = slot - g_smmu_master_table;
+
+    val_el3_memory_set(&slot->master, sizeof(smmu_master_t), 0);
+    slot->state = SMMU_MASTER_SLOT_DELETED;
+    g_smmu_master_live--;
+
+    while (g_smmu_master_table[idx].state == SMMU_MASTER_SLOT_DELETED &&
+           g_smmu_master_table[(idx + 1) & (SMMU_MASTER_TABLE_SIZE - 1)].state ==
+           SMMU_MASTER_SLOT_FREE)
+    {
+        g_smmu_master_table[idx].state = SMMU_MASTER_SLOT_FREE;
+        idx = (idx - 1) & (SMMU_MASTER_TABLE_SIZE - 1);
+    }
 }
 
 /**
@@ -997,6 +1190,7 @@ uint32_t val_el3_smmu_rlm_map(smmu_master_attributes_t master_attr, pgt_descript
 {
     smmu_master_t *master;
     smmu_dev_t *smmu;
+    smmu_cmdq_batch_t batch;
     uint64_t *ste;
 
     g_sid = master_attr.streamid;
@@ -1016,7 +1210,7 @@ uint32_t val_el3_smmu_rlm_map(smmu_master_attributes_t master_attr, pgt_descript
         return 1;
     }
 
-    master = smmu_master_at(master_attr.streamid);
+    master = smmu_master_at(master_attr.smmu_index, master_attr.streamid);
     if (master == NULL)
         return 1;
 
@@ -1102,8 +1296,11 @@ uint32_t val_el3_smmu_rlm_map(smmu_master_attributes_t master_attr, pgt_descript
             return 1;
     }
 
+    /* The STE and global invalidations are published together with one CMD_SYNC */
+    smmu_cmdq_batch_init(smmu, &batch);
+
     ste = smmu_strtab_get_ste_for_sid(smmu, master->sid);
-    smmu_strtab_write_ste(master, ste, smmu);
+    smmu_strtab_write_ste(master, ste, &batch);
     dump_strtab(ste);
     /* Disable the GPC before the Invalidation to avoid GPF
      * Note: Remove once making all the allocated memory GPI_ANY
@@ -1113,7 +1310,8 @@ uint32_t val_el3_smmu_rlm_map(smmu_master_attributes_t master_attr, pgt_descript
     root_cr0 &= ~0x2ul;
     smmu_reg_write_sync(smmu, root_cr0, SMMU_ROOT_CR0, SMMU_ROOT_CR0_ACK);
 
-    smmu_tlbi_cfgi(smmu);
+    smmu_tlbi_cfgi_stage(&batch);
+    smmu_cmdq_batch_submit(&batch);
 
     return 0;
 }
@@ -1131,33 +1329,36 @@ uint32_t val_el3_smmu_rlm_map(smmu_master_attributes_t master_attr, pgt_descript
  */
 void val_el3_smmu_unmap(smmu_master_attributes_t master_attr)
 {
+    smmu_master_slot_t *slot;
     smmu_master_t *master;
     smmu_dev_t *smmu;
     uint64_t *strtab;
 
+    if (g_smmu == NULL || master_attr.smmu_index >= g_num_smmus)
+        return;
+
     smmu = &g_smmu[master_attr.smmu_index];
     if (smmu->base == 0)
     {
-        ERROR("\n      val_smmu_map: smmu unsupported     ");
+        ERROR("\n      val_smmu_unmap: smmu unsupported     ");
         return;
     }
 
-    master = smmu_master_at(master_attr.streamid);
-    if (master == NULL)
+    slot = smmu_master_find(master_attr.smmu_index, master_attr.streamid);
+    if (slot == NULL)
         return;
 
-    if (master->smmu == NULL)
-        return;
-
-    if (master_attr.streamid >= (0x1ul << master->smmu->sid_bits))
-        return;
+    master = &slot->master;
+    if (master->smmu != NULL && master_attr.streamid < (0x1ul << master->smmu->sid_bits))
+    {
+        strtab = master->smmu->strtab_cfg.strtab64 + master_attr.streamid * STRTAB_STE_DWORDS;
+        smmu_strtab_write_ste(NULL, strtab, NULL);
 
-    strtab = master->smmu->strtab_cfg.strtab64 + master_attr.streamid * STRTAB_STE_DWORDS;
-    smmu_strtab_write_ste(NULL, strtab, smmu);
+        smmu_cdtab_free(master);
+        smmu_tlbi_cfgi(master->smmu);
+    }
 
-    smmu_cdtab_free(master);
-    smmu_tlbi_cfgi(master->smmu);
-    val_el3_memory_set(master, sizeof(smmu_master_t), 0);
+    smmu_master_remove(slot);
 }
 
 uint32_t val_el3_smmu_init_one(smmu_dev_t *smmu)
@@ -1200,6 +1401,8 @@ void val_el3_smmu_stop(void)
         smmu_dev_disable(smmu);
         if (smmu->cmd_type.base_ptr)
             val_el3_memory_free(smmu->cmd_type.base_ptr);
+        if (smmu->cmd_type.sync_ptr)
+            val_el3_memory_free(smmu->cmd_type.sync_ptr);
         smmu_free_strtab(smmu);
     }
     val_el3_memory_free(g_smmu);
@@ -1409,6 +1612,69 @@ val_el3_dpt_add_entry(uint64_t translated_addr, uint64_t smmu_info)
   return 0;
 }
 
+/**
+ * @brief Grant a DPT permission to a PA range of one SMMU in a single pass.
+ *
+ * VAL builds a single level DPT (see val_el3_smmu_dpt_init), so the L0
+ * descriptors are the coarsest level available: every L0 descriptor whose
+ * span intersects the range is written, the dirty part of the table is
+ * cleaned once and one DPT invalidation closed by a CMD_SYNC follows, unless
+ * the caller asked for DPT_RANGE_NO_DPTI.
+ *
+ * @param base        Base PA of the range.
+ * @param size        Size of the range in bytes.
+ * @param access      DPT descriptor value to program.
+ * @param smmu_index  Index of the SMMU whose DPT is programmed.
+ * @param flags       DPT_RANGE_* flags.
+ * @return 0 on success, 1 on error.
+ */
+uint32_t
+val_el3_dpt_add_range(uint64_t base, uint64_t size, uint64_t access, uint32_t smmu_index,
+                      uint64_t flags)
+{
+  uint64_t oas, dptgs, l0dptsz, dptps;
+  uint64_t first, last, idx, num_entry;
+  uint64_t *l0_table;
+  smmu_cmdq_batch_t batch;
+  smmu_dev_t *smmu;
+
+  if (size == 0 || smmu_index >= g_num_smmus)
+      return 1;
+
+  smmu = &g_smmu[smmu_index];
+  val_el3_dpt_get_cfg_values(&oas, &dptps, &l0dptsz, &dptgs, smmu);
+  if (dptps == 0 || l0dptsz == 0 || l0dptsz > dptps)
+  {
+      ERROR("\n     Unsupported DPT configuration");
+      return 1;
+  }
+
+  num_entry = 0x1ull << (dptps - l0dptsz);
+  first = base >> l0dptsz;
+  last = (base + size - 1) >> l0dptsz;
+  if (last >= num_entry)
+  {
+      ERROR("\n     DPT range exceeds the L0 table");
+      return 1;
+  }
+
+  l0_table = (uint64_t *)val_el3_smmu_get_dpt_base(smmu);
+  for (idx = first; idx <= last; idx++)
+      l0_table[idx] = access;
+
+  val_el3_cln_and_invldt_cache_range(&l0_table[first], (last - first + 1) * sizeof(uint64_t));
+
+  if (flags & DPT_RANGE_NO_DPTI)
+      return 0;
+
+  smmu_cmdq_batch_init(smmu, &batch);
+  smmu_cmdq_batch_add(&batch, CMDQ_OP_DPTI_ALL);
+  if (smmu_cmdq_batch_submit(&batch))
+      return 1;
+
+  return 0;
+}
+
 /**
  * @brief Initialize realm DPT tables for a given SMMU device.
  *
@@ -1539,6 +1805,7 @@ uint32_t val_el3_smmu_set_rlm_ste_mecid(smmu_master_attributes_t master_attr, ui
 {
   smmu_master_t *master;
   smmu_dev_t *smmu;
+  smmu_cmdq_batch_t batch;
   uint64_t *ste;
 
   g_sid = master_attr.streamid;
@@ -1558,7 +1825,7 @@ uint32_t val_el3_smmu_set_rlm_ste_mecid(smmu_master_attributes_t master_attr, ui
       return 1;
   }
 
-  master = smmu_master_at(master_attr.streamid);
+  master = smmu_master_at(master_attr.smmu_index, master_attr.streamid);
   if (master == NULL)
       return 1;
 
@@ -1595,10 +1862,11 @@ uint32_t val_el3_smmu_set_rlm_ste_mecid(smmu_master_attributes_t master_attr, ui
   /* Set new MECID */
   *ste_qword5 |= ((uint64_t)mecid << STE_MECID_SHIFT);
 
-  smmu_tlbi_cached_ste(smmu);
+  smmu_cmdq_batch_init(smmu, &batch);
+  smmu_tlbi_cached_ste(&batch);
 
   /* Issue a PREFETCH command so that new config for SID is fetched by SMMU */
-  smmu_tlbi_prefetch_cfg(smmu);
+  smmu_tlbi_prefetch_cfg(&batch);
 
   dump_strtab(ste);
   /* Disable the GPC before the Invalidation to avoid GPF
@@ -1610,7 +1878,8 @@ uint32_t val_el3_smmu_set_rlm_ste_mecid(smmu_master_attributes_t master_attr, ui
 
   smmu_reg_write_sync(smmu, root_cr0, SMMU_ROOT_CR0, SMMU_ROOT_CR0_ACK);
 
-  smmu_tlbi_cfgi(smmu);
+  smmu_tlbi_cfgi_stage(&batch);
+  smmu_cmdq_batch_submit(&batch);
 
   return 0;
 }
@@ -1643,17 +1912,17 @@ void val_el3_smmu_root_config_service(uint64_t arg0, uint64_t arg1, uint64_t arg
   switch (arg0)
   {
        case SMMU_ROOT_RME_IMPL_CHK:
-         INFO("SMMU base address & offset: 0x%lx \n", (uint64_t)smmu_base + SMMU_ROOT_IDRO);
+         INFO_TRACE("SMMU base address & offset: 0x%lx \n", (uint64_t)smmu_base + SMMU_ROOT_IDRO);
          data = *(uint32_t *)(smmu_base + SMMU_ROOT_IDRO);
-         INFO("SMMU ROOT IDRO: 0x%lx", data);
+         INFO_TRACE("SMMU ROOT IDRO: 0x%lx", data);
          shared_data->shared_data_access[0].data = data;
          break;
        case SMMU_RLM_PGT_INIT:
-         INFO("SMMU Realm Initialisation\n");
+         INFO_TRACE("SMMU Realm Initialisation\n");
          val_el3_smmu_init(arg1, (uint64_t *)arg2);
          break;
        case SMMU_RLM_SMMU_MAP:
-         INFO("SMMU realm page table map\n");
+         INFO_TRACE("SMMU realm page table map\n");
          memcpy((void *)&smmu_attr, (void *)arg1, sizeof(smmu_master_attributes_t));
          memcpy((void *)&pgt_attr, (void *)arg2, sizeof(pgt_descriptor_t));
          if (val_el3_smmu_rlm_map((smmu_master_attributes_t)smmu_attr, (pgt_descriptor_t)pgt_attr))
@@ -1667,8 +1936,13 @@ void val_el3_smmu_root_config_service(uint64_t arg0, uint64_t arg1, uint64_t arg
               shared_data->error_msg[i] = '\0';
          }
          break;
-       case SMMU_RLM_ADD_DPT_ENTRY:
-          INFO("SMMU add DPT entry\n");
+       case SMMU_RLM_SMMU_UNMAP:
+          INFO_TRACE("SMMU realm page table unmap\n");
+          memcpy((void *)&smmu_attr, (void *)arg1, sizeof(smmu_master_attributes_t));
+          val_el3_smmu_unmap((smmu_master_attributes_t)smmu_attr);
+          break;
+      case SMMU_RLM_ADD_DPT_ENTRY:
+          INFO_TRACE("SMMU add DPT entry\n");
           if (val_el3_dpt_add_entry(arg1, arg2))
           {
               shared_data->status_code = 1;
@@ -1681,9 +1955,35 @@ void val_el3_smmu_root_config_service(uint64_t arg0, uint64_t arg1, uint64_t arg
           }
           break;
       case SMMU_RLM_DPTI:
-          INFO("SMMU DPT Invalidate\n");
+          INFO_TRACE("SMMU DPT Invalidate\n");
           val_el3_dpt_invalidate_all(arg1);
           break;
+      case SMMU_RLM_ADD_DPT_RANGE:
+          INFO_TRACE("SMMU add DPT range\n");
+          {
+              DPT_RANGE_DESC range;
+              uint32_t idx;
+
+              memcpy((void *)&range, (void *)arg1, sizeof(DPT_RANGE_DESC));
+              for (idx = 0; idx < g_num_smmus; idx++)
+              {
+                  if (!(range.smmu_mask & (0x1ull << idx)))
+                      continue;
+                  if (val_el3_dpt_add_range(range.base, range.size, range.access, idx,
+                                            range.flags))
+                  {
+                      shared_data->status_code = 1;
+                      shared_data->error_code = idx;
+                      const char *msg = "EL3: SMMU DPT Add range failed";
+                      int i = 0; while (msg[i] && i < sizeof(shared_data->error_msg) - 1) {
+                          shared_data->error_msg[i] = msg[i]; i++;
+                      }
+                      shared_data->error_msg[i] = '\0';
+                      break;
+                  }
+              }
+          }
+          break;
       case SMMU_CHECK_MEC_IMPL:
           shared_data->shared_data_access[0].data = val_el3_smmu_supports_mec(arg1);
           break;